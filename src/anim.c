@@ -0,0 +1,387 @@
+/*
+ * anim.c:  This file contains the implementation details for rendering an
+ *          animation.  The scene is loaded once, and each frame only moves
+ *          the camera and objects before rendering, so the parsed objects
+ *          and traversal array are reused for every frame.  Only what the
+ *          moves affect is built again: the instance hierarchy when an
+ *          instance or prototype moves, the lights when a light moves, and
+ *          the lightmaps of the planes a moved object could shade.
+ *
+ *          A keyframe file contains one entry per line; blank lines and
+ *          lines beginning with '#' are ignored:
+ *
+ *            frames N                   Number of frames to render
+ *            camera F vx vy vz wx wy    View point and world size at frame F
+ *            move   F id dx dy dz       Offset of object id at frame F
+ *
+ *          Values are linearly interpolated between keyframes and held
+ *          constant before the first and after the last.  Object offsets
+ *          are relative to the position in the scene file; object ids are
+ *          the ids shown in the model dump.
+ *
+ * Author:  Scott Gigawatt
+ *
+ * Version: 18 October 2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "anim.h"
+#include "image.h"
+#include "lightmap.h"
+#include "mem.h"
+
+/*
+ * find_obj:   Finds the object with the specified id in a list.
+ *
+ * Parameters: lst   - The list of objects to search.
+ *             objid - The object id.
+ *
+ * Return:     The object, or NULL if no object has the id.
+ */
+static obj_t *find_obj(list_t *lst, int objid) {
+    link_t *cursor = NULL; /* Cursor into the list */
+
+    for (cursor = lst->head; cursor; cursor = cursor->next) {
+        if (((obj_t *)cursor->item)->objid == objid) {
+            return (obj_t *)cursor->item;
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * find_track: Finds the track with the specified id, creating it if this
+ *             is its first key.
+ *
+ * Parameters: anim  - The animation.
+ *             model - The model containing the animated objects.
+ *             objid - The object id, or ANIM_CAMERA.
+ *
+ * Return:     The track.
+ */
+static track_t *find_track(anim_t *anim, model_t *model, int objid) {
+    link_t  *cursor = NULL; /* Cursor into the track list */
+    track_t *track  = NULL; /* The new track              */
+
+    for (cursor = anim->tracks->head; cursor; cursor = cursor->next) {
+        if (((track_t *)cursor->item)->objid == objid) {
+            return (track_t *)cursor->item;
+        }
+    }
+
+    track = (track_t *)Malloc(sizeof(track_t));
+    memset(track, 0, sizeof(track_t));
+    track->objid = objid;
+
+    /* Look up the object moved by the track */
+    if (objid != ANIM_CAMERA) {
+        if ((track->obj = find_obj(model->scene, objid)) == NULL &&
+            (track->obj = find_obj(model->lights, objid)) == NULL) {
+            msg_exit(stderr, "anim_init: error: unknown object id");
+        }
+    }
+
+    list_add(anim->tracks, track);
+
+    return track;
+}
+
+/*
+ * add_key:    Adds a key to a track, keeping the keys sorted by frame.
+ *
+ * Parameters: track - The track.
+ *             key   - The key to add.
+ */
+static void add_key(track_t *track, anim_key_t *key) {
+    anim_key_t *keys = NULL; /* The grown key array */
+    int        i;            /* Key index           */
+
+    /* Grow the key array by one */
+    keys = (anim_key_t *)Malloc((track->num_keys + 1) * sizeof(anim_key_t));
+
+    if (track->num_keys > 0) {
+        memcpy(keys, track->keys, track->num_keys * sizeof(anim_key_t));
+        Free(track->keys);
+    }
+
+    /* Shift later keys up to keep the array sorted */
+    for (i = track->num_keys; i > 0 && keys[i - 1].frame > key->frame; --i) {
+        keys[i] = keys[i - 1];
+    }
+
+    keys[i]      = *key;
+    track->keys  = keys;
+    ++track->num_keys;
+}
+
+/*
+ * anim_init:  Reads the keyframes of an animation from the specified file.
+ *
+ * Parameters: in    - The keyframe file.
+ *             model - The model containing the animated objects.
+ *
+ * Return:     A pointer to the new animation.
+ */
+anim_t *anim_init(FILE *in, model_t *model) {
+    anim_t     *anim = (anim_t *)Malloc(sizeof(anim_t)); /* The animation */
+    anim_key_t key;                                      /* Current key   */
+    char       line[BUF_SIZE];                           /* Input line    */
+    char       word[BUF_SIZE];                           /* Entry keyword */
+    int        objid;                                    /* Object id     */
+
+    anim->frames = 0;
+    anim->tracks = list_init();
+
+    while (fgets(line, BUF_SIZE, in)) {
+        /* Skip blank lines and comments */
+        if (sscanf(line, "%255s", word) != 1 || *word == '#') {
+            continue;
+        }
+
+        memset(&key, 0, sizeof(anim_key_t));
+
+        if (!strcmp(word, "frames")) {
+            if (sscanf(line, "%*s %d", &anim->frames) != 1) {
+                msg_exit(stderr, "anim_init: error: invalid frame count");
+            }
+        } else if (!strcmp(word, "camera")) {
+            if (sscanf(line, "%*s %d %lf %lf %lf %lf %lf", &key.frame,
+                       &key.val[0], &key.val[1], &key.val[2],
+                       &key.val[3], &key.val[4]) != CAM_SIZE + 1) {
+                msg_exit(stderr, "anim_init: error: invalid camera key");
+            }
+
+            add_key(find_track(anim, model, ANIM_CAMERA), &key);
+        } else if (!strcmp(word, "move")) {
+            if (sscanf(line, "%*s %d %d %lf %lf %lf", &key.frame, &objid,
+                       &key.val[0], &key.val[1], &key.val[2]) != 5) {
+                msg_exit(stderr, "anim_init: error: invalid move key");
+            }
+
+            add_key(find_track(anim, model, objid), &key);
+        } else {
+            msg_exit(stderr, "anim_init: error: unknown keyframe entry");
+        }
+    }
+
+    if (anim->frames <= 0) {
+        msg_exit(stderr, "anim_init: error: frame count must be > zero");
+    }
+
+    return anim;
+}
+
+/*
+ * track_value: Interpolates the values of a track at a frame.
+ *
+ * Parameters:  track - The track.
+ *              frame - The frame number.
+ *              count - The number of values.
+ *              val   - Storage for the interpolated values.
+ */
+static void track_value(track_t *track, int frame, int count, double *val) {
+    anim_key_t *lo = track->keys;                       /* Key at or before */
+    anim_key_t *hi = track->keys + track->num_keys - 1; /* Key at or after  */
+    double     t   = 0.0;                               /* Blend factor     */
+    int        i;                                       /* Counter          */
+
+    /* Find the keys on either side of the frame */
+    for (i = 0; i < track->num_keys; ++i) {
+        if (track->keys[i].frame <= frame) {
+            lo = track->keys + i;
+        }
+
+        if (track->keys[track->num_keys - 1 - i].frame >= frame) {
+            hi = track->keys + track->num_keys - 1 - i;
+        }
+    }
+
+    /* Hold the first and last key outside of the keyed range */
+    if (frame <= lo->frame) {
+        hi = lo;
+    } else if (frame >= hi->frame) {
+        lo = hi;
+    } else {
+        t = (double)(frame - lo->frame) / (hi->frame - lo->frame);
+    }
+
+    for (i = 0; i < count; ++i) {
+        val[i] = lo->val[i] + t * (hi->val[i] - lo->val[i]);
+    }
+}
+
+/*
+ * mark_stale: Marks the lightmaps that an object could shade from within
+ *             the specified box, along with its own.
+ *
+ * Parameters: model   - The model.
+ *             obj     - The object.
+ *             box     - The box about the object.
+ *             bounded - Zero if the object has no box.
+ *             stale   - Set for each traversal index to bake again.
+ */
+static void mark_stale(model_t *model, obj_t *obj, double box[2][VEC_SIZE],
+                       int bounded, char *stale) {
+    obj_t *plane = NULL; /* The current plane */
+    int   i;             /* Object index      */
+
+    for (i = 0; i < model->num_objs; ++i) {
+        plane = model->objs[i];
+
+        if (plane->lightmap && (plane == obj || !bounded ||
+                                lightmap_shades(model, plane, box[0],
+                                                box[1]))) {
+            stale[i] = 1;
+        }
+    }
+}
+
+/*
+ * anim_frame: Moves the camera and objects to their positions at a frame,
+ *             then builds again the parts of the model the moves affect.
+ *
+ * Parameters: anim  - The animation.
+ *             model - The model to update.
+ *             frame - The frame number.
+ */
+void anim_frame(anim_t *anim, model_t *model, int frame) {
+    link_t  *cursor = NULL;     /* Cursor into the track list  */
+    track_t *track  = NULL;     /* The current track           */
+    obj_t   *obj    = NULL;     /* The object moved            */
+    char    *stale  = NULL;     /* Set for each map to rebake  */
+    double  val[CAM_SIZE];      /* Interpolated values         */
+    double  delta[VEC_SIZE];    /* Offset since the last frame */
+    double  box[2][VEC_SIZE];   /* The box about the object    */
+    int     parts   = 0;        /* The parts to build again    */
+    int     i;                  /* Object index                */
+
+    stale = (char *)Malloc(model->num_objs + 1);
+    memset(stale, 0, model->num_objs + 1);
+
+    for (cursor = anim->tracks->head; cursor; cursor = cursor->next) {
+        track = (track_t *)cursor->item;
+
+        if (track->objid == ANIM_CAMERA) {
+            /* Set the view point and world size */
+            track_value(track, frame, CAM_SIZE, val);
+            vec_scale3(1.0, val, model->proj->view_point);
+            model->proj->win_size_world[0] = val[3];
+            model->proj->win_size_world[1] = val[4];
+            projection_camera(model->proj, model->opts);
+        } else {
+            track_value(track, frame, VEC_SIZE, val);
+            vec_diff3(track->applied, val, delta);
+            vec_scale3(1.0, val, track->applied);
+
+            /* An object that stays put changes nothing */
+            if (delta[0] == 0.0 && delta[1] == 0.0 && delta[2] == 0.0) {
+                continue;
+            }
+
+            obj = track->obj;
+
+            if (model_is_light(obj->objtype)) {
+                parts |= ACCEL_LIGHTS | ACCEL_MAPS;
+            } else if (obj->objtype == INSTANCE) {
+                parts |= ACCEL_INSTS;
+            } else if (obj->objtype == PROTOTYPE) {
+                /* Its instances could shade any plane */
+                parts |= ACCEL_INSTS | ACCEL_MAPS;
+            }
+
+            /* Move the object by the change in its offset, marking the
+               maps it shaded before and the maps it shades now */
+            mark_stale(model, obj, box, obj->bounds(obj, box[0], box[1]),
+                       stale);
+            obj->move(obj, delta);
+            mark_stale(model, obj, box, obj->bounds(obj, box[0], box[1]),
+                       stale);
+        }
+    }
+
+    /* A moved light changes every map */
+    model_accel(model, parts);
+
+    for (i = 0; i < model->num_objs && !(parts & ACCEL_MAPS); ++i) {
+        if (stale[i]) {
+            lightmap_rebake(model, model->objs[i]);
+        }
+    }
+
+    Free(stale);
+}
+
+/*
+ * anim_render: Renders every frame of the animation named by the rendering
+ *              options, writing each frame to a numbered file.
+ *
+ * Parameters:  model - The model to animate.
+ */
+void anim_render(model_t *model) {
+    FILE          *in     = NULL; /* The keyframe file     */
+    FILE          *out    = NULL; /* The frame file        */
+    anim_t        *anim   = NULL; /* The animation         */
+    unsigned char *pixmap = NULL; /* The image data        */
+    char          name[BUF_SIZE]; /* The frame file name   */
+    int           vals[VEC_SIZE]; /* The PPM header values */
+    int           frame;          /* The current frame     */
+
+    in = fopen(model->opts->animate, "r");
+
+    if (in == NULL) {
+        msg_exit(stderr, "anim_render: error: cannot open keyframe file");
+    }
+
+    anim = anim_init(in, model);
+    fclose(in);
+
+    /* One image buffer is reused for every frame */
+    pixmap = image_alloc(model, vals);
+
+    /* Order the scene objects by hit frequency at the first frame */
+    if (model->opts->reorder) {
+        anim_frame(anim, model, 0);
+        profile_hits(model);
+    }
+
+    for (frame = 0; frame < anim->frames; ++frame) {
+        anim_frame(anim, model, frame);
+        render_image(model, pixmap);
+
+        /* Write the frame to its numbered file */
+        snprintf(name, BUF_SIZE, model->opts->output, frame);
+
+        if ((out = fopen(name, "wb")) == NULL) {
+            msg_exit(stderr, "anim_render: error: cannot create frame file");
+        }
+
+        write_ppm(pixmap, ID_COLOR, vals, out);
+        fclose(out);
+
+        fprintf(stderr, "Frame %d of %d written to %s\n", frame + 1,
+                                                 anim->frames, name);
+    }
+
+    Free(pixmap);
+    anim_destroy(anim);
+}
+
+/*
+ * anim_destroy: Destroys the specified animation.
+ *
+ * Parameters:   anim - The animation to destroy.
+ */
+void anim_destroy(anim_t *anim) {
+    link_t *cursor = NULL; /* Cursor into the track list */
+
+    for (cursor = anim->tracks->head; cursor; cursor = cursor->next) {
+        Free(((track_t *)cursor->item)->keys);
+    }
+
+    /* Delete the tracks and the animation */
+    list_del(anim->tracks);
+    Free(anim);
+}
@@ -0,0 +1,57 @@
+/*
+ * anim.h:  This header file contains the implementation specifications for
+ *          rendering an animation from a single loaded model.
+ *
+ * Author:  Scott Gigawatt
+ *
+ * Version: 18 October 2026
+ */
+
+#ifndef ANIM_H
+#define ANIM_H
+
+#include <stdio.h>
+#include "list.h"
+#include "model.h"
+#include "object.h"
+
+/* The track id of the camera */
+#define ANIM_CAMERA -1
+
+/* The number of keyed camera values: view point (x, y, z), world (x, y) */
+#define CAM_SIZE 5
+
+/* A keyed value of a track */
+typedef struct anim_key_type {
+    int    frame;         /* The frame of the key       */
+    double val[CAM_SIZE]; /* The values at the keyframe */
+} anim_key_t;
+
+/* The keyframes of the camera or of one object */
+typedef struct track_type {
+    int        objid;             /* Object id, or ANIM_CAMERA        */
+    obj_t      *obj;              /* The object moved by the track    */
+    anim_key_t *keys;             /* The keys, sorted by frame        */
+    int        num_keys;          /* The number of keys               */
+    double     applied[VEC_SIZE]; /* The offset applied to the object */
+} track_t;
+
+/* An animation */
+typedef struct anim_type {
+    int    frames; /* The number of frames to render */
+    list_t *tracks; /* The camera and object tracks  */
+} anim_t;
+
+/* Reads the keyframes of an animation from the specified file */
+anim_t *anim_init(FILE *in, model_t *model);
+
+/* Moves the camera and objects to their positions at a frame */
+void anim_frame(anim_t *anim, model_t *model, int frame);
+
+/* Renders every frame of the animation to numbered files */
+void anim_render(model_t *model);
+
+/* Destroys the specified animation */
+void anim_destroy(anim_t *anim);
+
+#endif
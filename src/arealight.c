@@ -0,0 +1,233 @@
+/*
+ * arealight.c: This file contains the implementation details for lights
+ *              with an area: rectangles and spheres.  Each shadow ray goes
+ *              to its own point of the light, so shadows fall off softly.
+ *              The points follow the Halton sequence, shifted by a random
+ *              amount for each hit point, so any first few of them are
+ *              spread across the light and the adaptive test of the first
+ *              rays (see process_area) sees the whole light.
+ *
+ * Author:      Scott Gigawatt
+ *
+ * Version:     18 October 2026
+ */
+
+#include <math.h>
+#include <string.h>
+#include "arealight.h"
+#include "mem.h"
+
+/*
+ * halton:     Finds a point of the Halton sequence, shifted and wrapped
+ *             into the unit square.
+ *
+ * Parameters: index - The index of the point.
+ *             shift - The shift (x, y), 0 to 1.
+ *             uv    - Storage for the point (x, y), 0 to 1.
+ */
+static void halton(int index, double *shift, double *uv) {
+    int    base[2] = { 2, 3 }; /* The base of each coordinate */
+    double scale;              /* The place of a digit        */
+    int    n;                  /* The digits left             */
+    int    i;                  /* Coordinate                  */
+
+    for (i = 0; i < 2; ++i) {
+        uv[i] = shift[i];
+
+        for (n = index, scale = 1.0 / base[i]; n > 0; n /= base[i]) {
+            uv[i] += (n % base[i]) * scale;
+            scale /= base[i];
+        }
+
+        uv[i] -= floor(uv[i]);
+    }
+}
+
+/*
+ * arealight_init: Initializes and returns a new area light object.  After
+ *                 the light come the two edges of a rectangle (u, v),
+ *                 centered on the center, or the radius of a sphere, and
+ *                 then the number of shadow rays cast toward it from each
+ *                 point.
+ *
+ * Parameters:     in      - The file containing the lighting data.
+ *                 objtype - The object type identifier.
+ *
+ * Return:         The newly created area light object.
+ */
+obj_t *arealight_init(FILE *in, int objtype) {
+    obj_t       *obj   = light_init(in, objtype);      /* The light object */
+    light_t     *light = (light_t *)obj->priv;         /* The light        */
+    arealight_t *new   = (arealight_t *)Malloc(sizeof(arealight_t));
+    double      span[2][VEC_SIZE];                     /* The diagonals    */
+    int         i;                                     /* Counter          */
+
+    /* Link the area light to the light */
+    light->priv  = new;
+    obj->destroy = arealight_destroy;
+    obj->dump    = arealight_dump;
+    new->radius  = 0.0;
+    memset(new->edges, 0, sizeof(new->edges));
+
+    if (objtype == AREA_LIGHT) {
+        /* Get the edges of the rectangle and check for errors */
+        for (i = 0; i < 2; ++i) {
+            if (vec_get3(in, new->edges[i]) != VEC_SIZE) {
+                msg_exit(stderr, "arealight_init: error: invalid edge");
+            }
+
+            consume_line(in);
+        }
+
+        vec_sum3(new->edges[0], new->edges[1], span[0]);
+        vec_diff3(new->edges[1], new->edges[0], span[1]);
+
+        light->sample = rectlight_sample;
+        light->radius = (vec_length3(span[0]) > vec_length3(span[1]) ?
+                         vec_length3(span[0]) : vec_length3(span[1])) / 2.0;
+    } else {
+        /* Get the radius of the sphere and check for errors */
+        if (vec_get1(in, &new->radius) != 1 || new->radius <= 0.0) {
+            msg_exit(stderr, "arealight_init: error: invalid radius");
+        }
+
+        consume_line(in);
+
+        light->sample = spherelight_sample;
+        light->radius = new->radius;
+    }
+
+    /* Get the number of shadow rays and check for errors */
+    if (ivec_get1(in, &light->samples) != 1 || light->samples < 1 ||
+        light->samples > LIGHT_MAX_SAMPLES) {
+        msg_exit(stderr, "arealight_init: error: invalid sample count");
+    }
+
+    consume_line(in);
+
+    return obj;
+}
+
+/*
+ * arealight_dump: Dumps the contents of the area light object to the
+ *                 specified output file.
+ *
+ * Parameters:     out - The file to which the light will be dumped.
+ *                 obj - The area light object to dump.
+ *
+ * Return:         EXIT_SUCCESS if successful, EXIT_FAILURE otherwise.
+ */
+int arealight_dump(FILE *out, obj_t *obj) {
+    light_t     *light = (light_t *)obj->priv;       /* The light      */
+    arealight_t *area  = (arealight_t *)light->priv; /* The area light */
+
+    /* Print out the area light information */
+    fprintf(out,  "Dumping object of type AreaLight\n\nLight data\n");
+    vec_prn3(out, "emissivity - ", obj->emissivity);
+    vec_prn3(out, "center     - ", light->center);
+
+    if (obj->objtype == AREA_LIGHT) {
+        vec_prn3(out, "edge u     - ", area->edges[0]);
+        vec_prn3(out, "edge v     - ", area->edges[1]);
+    } else {
+        vec_prn1(out, "radius     - ", &area->radius);
+    }
+
+    ivec_prn1(out, "samples    - ", &light->samples);
+
+    return EXIT_SUCCESS;
+}
+
+/*
+ * rectlight_sample: Picks the point of a rectangular light for a shadow ray.
+ *
+ * Parameters:       obj   - The rectangular light object.
+ *                   from  - The point the ray is cast from (x, y, z).
+ *                   index - The index of the ray.
+ *                   shift - The random shift of the points (x, y), 0 to 1.
+ *                   point - Storage for the point of the light (x, y, z).
+ */
+void rectlight_sample(obj_t *obj, double *from, int index, double *shift,
+                      double *point) {
+    light_t     *light = (light_t *)obj->priv;       /* The light      */
+    arealight_t *area  = (arealight_t *)light->priv; /* The area light */
+    double      uv[2];                               /* Place on it    */
+    int         i;                                   /* Counter        */
+
+    halton(index, shift, uv);
+
+    for (i = 0; i < VEC_SIZE; ++i) {
+        point[i] = light->center[i] + (uv[0] - 0.5) * area->edges[0][i] +
+                                      (uv[1] - 0.5) * area->edges[1][i];
+    }
+}
+
+/*
+ * spherelight_sample: Picks the point of a spherical light for a shadow
+ *                     ray, on the disc of its outline seen from the point
+ *                     the ray is cast from.
+ *
+ * Parameters:         obj   - The spherical light object.
+ *                     from  - The point the ray is cast from (x, y, z).
+ *                     index - The index of the ray.
+ *                     shift - The random shift of the points (x, y), 0 to 1.
+ *                     point - Storage for the point of the light (x, y, z).
+ */
+void spherelight_sample(obj_t *obj, double *from, int index, double *shift,
+                        double *point) {
+    light_t     *light = (light_t *)obj->priv;       /* The light           */
+    arealight_t *area  = (arealight_t *)light->priv; /* The area light      */
+    double      axis[VEC_SIZE];                      /* Toward the point    */
+    double      side[2][VEC_SIZE];                   /* Axes of the outline */
+    double      other[VEC_SIZE] = { 1.0, 0.0, 0.0 }; /* Not along the axis  */
+    double      uv[2];                               /* Place on the disc   */
+    double      dist;                                /* Center to the point */
+    double      ratio;                               /* Radius / distance   */
+    double      radius;                              /* Radius of the disc  */
+    double      angle;                               /* Angle on the disc   */
+    int         i;                                   /* Counter             */
+
+    vec_diff3(light->center, from, axis);
+
+    /* A point inside the light sees it all around; use the center */
+    if ((dist = vec_length3(axis)) <= area->radius) {
+        vec_scale3(1.0, light->center, point);
+        return;
+    }
+
+    vec_scale3(1.0 / dist, axis, axis);
+
+    if (fabs(axis[0]) > 0.9) {
+        other[0] = 0.0;
+        other[1] = 1.0;
+    }
+
+    vec_cross3(axis, other, side[0]);
+    vec_unit3(side[0], side[0]);
+    vec_cross3(axis, side[0], side[1]);
+
+    /* The outline is the circle where the tangent rays touch the sphere */
+    ratio  = area->radius / dist;
+    radius = area->radius * sqrt(1.0 - ratio * ratio);
+
+    halton(index, shift, uv);
+    angle  = 2.0 * M_PI * uv[1];
+    radius = radius * sqrt(uv[0]);
+
+    for (i = 0; i < VEC_SIZE; ++i) {
+        point[i] = light->center[i] + area->radius * ratio * axis[i] +
+                   radius * (cos(angle) * side[0][i] +
+                             sin(angle) * side[1][i]);
+    }
+}
+
+/*
+ * arealight_destroy: Destroys the specified area light object.
+ *
+ * Parameters:        obj - The area light object to destroy.
+ */
+void arealight_destroy(obj_t *obj) {
+    /* Release memory associated with the area light, then the light */
+    Free(((light_t *)obj->priv)->priv);
+    light_destroy(obj);
+}
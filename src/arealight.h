@@ -0,0 +1,39 @@
+/*
+ * arealight.h: This header file contains the implementation specifications
+ *              for lights with an area, rectangles and spheres, which cast
+ *              soft shadows.
+ *
+ * Author:      Scott Gigawatt
+ *
+ * Version:     18 October 2026
+ */
+
+#ifndef AREALIGHT_H
+#define AREALIGHT_H
+
+#include "light.h"
+
+/* Represents a light with an area */
+typedef struct arealight_type {
+    double edges[2][VEC_SIZE]; /* The edges of a rectangle (u, v) */
+    double radius;             /* The radius of a sphere          */
+} arealight_t;
+
+/* Allocates, initializes and returns a new area light object */
+obj_t *arealight_init(FILE *in, int objtype);
+
+/* Dumps the contents of the area light object to the specified file */
+int arealight_dump(FILE *out, obj_t *obj);
+
+/* Picks the point of a rectangular light for a shadow ray */
+void rectlight_sample(obj_t *obj, double *from, int index, double *shift,
+                      double *point);
+
+/* Picks the point of a spherical light for a shadow ray */
+void spherelight_sample(obj_t *obj, double *from, int index, double *shift,
+                        double *point);
+
+/* Destroys the specified area light object */
+void arealight_destroy(obj_t *obj);
+
+#endif
@@ -0,0 +1,517 @@
+/*
+ * bvh.c:   This file contains the implementation details for a bounding
+ *          volume hierarchy over a set of numbered items, such as objects
+ *          or the triangles of a mesh.  Each node holds the axis-aligned box
+ *          around its items.  Inner nodes split their items in half at the
+ *          median centre along the longest axis of the box, until no more
+ *          than BVH_LEAF items are left in a leaf.  Items without a bounding
+ *          box, such as infinite planes, are kept apart and tested by every
+ *          ray.
+ *
+ *          A ray visits the nearer child of a node first, and skips every
+ *          box that it enters beyond the closest hit found so far, so only
+ *          the items along the ray are tested.
+ *
+ * Author:  Scott Gigawatt
+ *
+ * Version: 18 October 2026
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "bvh.h"
+#include "mem.h"
+
+/* The padding around each box, so that flat items have a thickness */
+#define BVH_EPSILON 1e-9
+
+/* An item with its bounding box, while the hierarchy is built */
+typedef struct box_type {
+    double lo[VEC_SIZE];  /* The low corner of its box  */
+    double hi[VEC_SIZE];  /* The high corner of its box */
+    double mid[VEC_SIZE]; /* The centre of its box      */
+    int    item;          /* The item                   */
+} box_t;
+
+/* The objects of a hierarchy over objects, and the object a ray leaves */
+typedef struct objs_type {
+    obj_t **objs; /* The objects                  */
+    obj_t *skip;  /* The object the ray leaves    */
+} objs_t;
+
+/*
+ * before:     Orders two boxes by their centres along an axis, then by their
+ *             items, so that no two boxes are equal.
+ *
+ * Parameters: a    - The first box.
+ *             b    - The second box.
+ *             axis - The axis.
+ *
+ * Return:     Nonzero if the first box comes first, zero otherwise.
+ */
+static int before(box_t *a, box_t *b, int axis) {
+    return a->mid[axis] < b->mid[axis] ||
+           (a->mid[axis] == b->mid[axis] && a->item < b->item);
+}
+
+/*
+ * select_half: Partially orders the boxes along an axis, so that the first
+ *              half of them come before the rest.  Unlike a full sort, this
+ *              takes time in proportion to the number of boxes, so a large
+ *              mesh is built in time n log n rather than n log^2 n.
+ *
+ * Parameters:  boxes - The boxes.
+ *              axis  - The axis.
+ *              count - The number of boxes.
+ */
+static void select_half(box_t *boxes, int axis, int count) {
+    int   lo = 0;          /* The first box left to order */
+    int   hi = count - 1;  /* The last box left to order  */
+    int   k  = count / 2;  /* The first box of the rest   */
+    box_t pivot;           /* The box partitioned about   */
+    box_t swap;            /* Swap space                  */
+    int   i;               /* Forward index               */
+    int   j;               /* Backward index              */
+
+    while (hi > lo) {
+        pivot = boxes[lo + (hi - lo) / 2];
+        i     = lo;
+        j     = hi;
+
+        while (i <= j) {
+            while (before(&boxes[i], &pivot, axis)) {
+                ++i;
+            }
+
+            while (before(&pivot, &boxes[j], axis)) {
+                --j;
+            }
+
+            if (i <= j) {
+                swap       = boxes[i];
+                boxes[i++] = boxes[j];
+                boxes[j--] = swap;
+            }
+        }
+
+        if (k <= j) {
+            hi = j;
+        } else if (k >= i) {
+            lo = i;
+        } else {
+            break;
+        }
+    }
+}
+
+/*
+ * count_nodes: Counts the nodes of a hierarchy over the specified number of
+ *              bounded items.
+ *
+ * Parameters:  count - The number of items.
+ *
+ * Return:      The number of nodes.
+ */
+static int count_nodes(int count) {
+    if (count <= BVH_LEAF) {
+        return 1;
+    }
+
+    return 1 + count_nodes(count / 2) + count_nodes(count - count / 2);
+}
+
+/*
+ * build_node: Builds the node over the specified boxes and its children,
+ *             appending them to the hierarchy depth first.
+ *
+ * Parameters: bvh   - The hierarchy being built.
+ *             boxes - The boxes of the bounded items.
+ *             first - The index of the first box of the node.
+ *             count - The number of boxes of the node.
+ */
+static void build_node(bvh_t *bvh, box_t *boxes, int first, int count) {
+    bvh_node_t *node = NULL;       /* The new node                 */
+    box_t      *box;               /* The current box              */
+    double     lo[VEC_SIZE];       /* The low corner of centres    */
+    double     hi[VEC_SIZE];       /* The high corner of centres   */
+    int        index;              /* The index of the new node    */
+    int        axis = 0;           /* The axis of the split        */
+    int        i;                  /* Box index                    */
+    int        j;                  /* Axis index                   */
+
+    index = bvh->num_nodes++;
+    node  = &bvh->nodes[index];
+
+    for (j = 0; j < VEC_SIZE; ++j) {
+        node->lo[j] = lo[j] = HUGE_VAL;
+        node->hi[j] = hi[j] = -HUGE_VAL;
+    }
+
+    /* Bound the boxes and their centres */
+    for (box = boxes + first; box < boxes + first + count; ++box) {
+        for (j = 0; j < VEC_SIZE; ++j) {
+            node->lo[j] = box->lo[j] < node->lo[j] ? box->lo[j] : node->lo[j];
+            node->hi[j] = box->hi[j] > node->hi[j] ? box->hi[j] : node->hi[j];
+            lo[j]       = box->mid[j] < lo[j] ? box->mid[j] : lo[j];
+            hi[j]       = box->mid[j] > hi[j] ? box->mid[j] : hi[j];
+        }
+    }
+
+    for (j = 1; j < VEC_SIZE; ++j) {
+        if (hi[j] - lo[j] > hi[axis] - lo[axis]) {
+            axis = j;
+        }
+    }
+
+    if (count <= BVH_LEAF) {
+        node->start = first;
+        node->count = count;
+
+        for (i = first; i < first + count; ++i) {
+            bvh->items[i] = boxes[i].item;
+        }
+
+        return;
+    }
+
+    /* Split at the median centre along the longest axis */
+    select_half(boxes + first, axis, count);
+
+    node->count = 0;
+    build_node(bvh, boxes, first, count / 2);
+
+    node->start = bvh->num_nodes;
+    build_node(bvh, boxes, first + count / 2, count - count / 2);
+}
+
+/*
+ * bvh_tree:   Builds a bounding volume hierarchy over the items numbered 0
+ *             to count - 1, which must not change shape or move while it
+ *             is in use.
+ *
+ * Parameters: count - The number of items.
+ *             box   - Finds the bounding box of an item.
+ *             data  - Passed to box along with each item.
+ *
+ * Return:     A pointer to the new hierarchy.
+ */
+bvh_t *bvh_tree(int count, bvh_box_t box, void *data) {
+    bvh_t *bvh = (bvh_t *)Malloc(sizeof(bvh_t)); /* The new hierarchy   */
+    box_t *boxes;                                /* The item boxes      */
+    box_t *next;                                 /* The next item box   */
+    int   i;                                     /* Item index          */
+    int   j;                                     /* Axis index          */
+
+    boxes          = (box_t *)Malloc((count + 1) * sizeof(box_t));
+    bvh->items     = (int *)Malloc((count + 1) * sizeof(int));
+    bvh->rest      = (int *)Malloc((count + 1) * sizeof(int));
+    bvh->objs      = NULL;
+    bvh->num_nodes = 0;
+    bvh->num_items = 0;
+    bvh->num_rest  = 0;
+
+    /* Separate the bounded items from the unbounded ones */
+    for (i = 0; i < count; ++i) {
+        next = &boxes[bvh->num_items];
+
+        if (!box(data, i, next->lo, next->hi)) {
+            bvh->rest[bvh->num_rest++] = i;
+            continue;
+        }
+
+        for (j = 0; j < VEC_SIZE; ++j) {
+            next->lo[j] -= BVH_EPSILON * (1.0 + fabs(next->lo[j]));
+            next->hi[j] += BVH_EPSILON * (1.0 + fabs(next->hi[j]));
+            next->mid[j] = (next->lo[j] + next->hi[j]) / 2.0;
+        }
+
+        next->item = i;
+        ++bvh->num_items;
+    }
+
+    bvh->nodes = (bvh_node_t *)Malloc(count_nodes(bvh->num_items) *
+                                      sizeof(bvh_node_t));
+
+    if (bvh->num_items > 0) {
+        build_node(bvh, boxes, 0, bvh->num_items);
+    }
+
+    Free(boxes);
+
+    return bvh;
+}
+
+/*
+ * box_enter:  Finds the distance at which a ray enters a box.
+ *
+ * Parameters: node - The node of the box.
+ *             base - The base location of the ray.
+ *             dir  - The unit vector direction of the ray.
+ *             inv  - The reciprocal of each component of the direction.
+ *             tmin - The distance at which the ray starts.
+ *             tmax - The distance at which the ray ends.
+ *
+ * Return:     The distance, at least tmin, or HUGE_VAL if the box is missed.
+ */
+static double box_enter(bvh_node_t *node, double *base, double *dir,
+                        double *inv, double tmin, double tmax) {
+    double near = tmin; /* The entry distance */
+    double far  = tmax; /* The exit distance  */
+    double t0;          /* Slab entry         */
+    double t1;          /* Slab exit          */
+    double swap;        /* Swap space         */
+    int    j;           /* Axis index         */
+
+    for (j = 0; j < VEC_SIZE; ++j) {
+        /* A ray parallel to the slabs is either between them or not */
+        if (dir[j] == 0.0) {
+            if (base[j] < node->lo[j] || base[j] > node->hi[j]) {
+                return HUGE_VAL;
+            }
+
+            continue;
+        }
+
+        t0 = (node->lo[j] - base[j]) * inv[j];
+        t1 = (node->hi[j] - base[j]) * inv[j];
+
+        if (t0 > t1) {
+            swap = t0;
+            t0   = t1;
+            t1   = swap;
+        }
+
+        near = t0 > near ? t0 : near;
+        far  = t1 < far  ? t1 : far;
+
+        if (near > far) {
+            return HUGE_VAL;
+        }
+    }
+
+    return near;
+}
+
+/*
+ * bvh_trace:  Finds the closest item hit by a ray between tmin and tmax, or
+ *             with any set, the first item found.
+ *
+ * Parameters: bvh  - The hierarchy.
+ *             base - The base location of the ray.
+ *             dir  - The unit vector direction of the ray.
+ *             tmin - Hits at or before this distance are misses.
+ *             tmax - Hits at or beyond this distance are misses, set to the
+ *                    distance of the item hit.
+ *             test - Tests the ray against an item.
+ *             data - Passed to test along with each item.
+ *             any  - Nonzero to stop at the first item hit.
+ *
+ * Return:     The item hit, or -1.
+ */
+int bvh_trace(bvh_t *bvh, double *base, double *dir, double tmin,
+              double *tmax, bvh_test_t test, void *data, int any) {
+    bvh_node_t *node;              /* The current node          */
+    double     inv[VEC_SIZE];      /* The reciprocal direction  */
+    double     enter[BVH_DEPTH];   /* The entry of each node    */
+    int        stack[BVH_DEPTH];   /* The nodes left to visit   */
+    double     near[2];            /* The entry of each child   */
+    int        child[2];           /* The children of a node    */
+    double     dist;               /* The distance of a hit     */
+    int        hit = -1;           /* The closest item hit      */
+    int        top = 0;            /* The size of the stack     */
+    int        i;                  /* Item index                */
+    int        j;                  /* Axis index                */
+
+    /* Test the unbounded items first, since every ray may hit them */
+    for (i = 0; i < bvh->num_rest; ++i) {
+        dist = test(data, bvh->rest[i], base, dir, tmin, *tmax);
+
+        if (dist > tmin && dist < *tmax) {
+            *tmax = dist;
+            hit   = bvh->rest[i];
+
+            if (any) {
+                return hit;
+            }
+        }
+    }
+
+    if (bvh->num_items == 0) {
+        return hit;
+    }
+
+    for (j = 0; j < VEC_SIZE; ++j) {
+        inv[j] = dir[j] != 0.0 ? 1.0 / dir[j] : 0.0;
+    }
+
+    stack[0] = 0;
+    enter[0] = box_enter(bvh->nodes, base, dir, inv, tmin, *tmax);
+    top      = 1;
+
+    while (top > 0) {
+        --top;
+
+        /* Skip the boxes missed or entered beyond the closest hit */
+        if (enter[top] >= *tmax) {
+            continue;
+        }
+
+        node = &bvh->nodes[stack[top]];
+
+        if (node->count > 0) {
+            for (i = node->start; i < node->start + node->count; ++i) {
+                dist = test(data, bvh->items[i], base, dir, tmin, *tmax);
+
+                if (dist > tmin && dist < *tmax) {
+                    *tmax = dist;
+                    hit   = bvh->items[i];
+
+                    if (any) {
+                        return hit;
+                    }
+                }
+            }
+
+            continue;
+        }
+
+        /* Push the farther child first, so the nearer one is visited first */
+        child[0] = stack[top] + 1;
+        child[1] = node->start;
+        near[0]  = box_enter(&bvh->nodes[child[0]], base, dir, inv, tmin,
+                             *tmax);
+        near[1]  = box_enter(&bvh->nodes[child[1]], base, dir, inv, tmin,
+                             *tmax);
+        j        = near[1] < near[0];
+
+        stack[top]   = child[!j];
+        enter[top++] = near[!j];
+        stack[top]   = child[j];
+        enter[top++] = near[j];
+    }
+
+    return hit;
+}
+
+/*
+ * obj_box:    Finds the bounding box of an object of a hierarchy over
+ *             objects.
+ *
+ * Parameters: data - The objects.
+ *             item - The index of the object.
+ *             lo   - Storage for the low corner of the box.
+ *             hi   - Storage for the high corner of the box.
+ *
+ * Return:     Nonzero if the object is bounded, zero otherwise.
+ */
+static int obj_box(void *data, int item, double *lo, double *hi) {
+    obj_t *obj = ((obj_t **)data)[item]; /* The object */
+
+    return obj->bounds(obj, lo, hi);
+}
+
+/*
+ * obj_test:   Tests a ray against an object of a hierarchy over objects.
+ *             The object the ray leaves is tested with object_hits.
+ *
+ * Parameters: data - The objects and the object the ray leaves.
+ *             item - The index of the object.
+ *             base - The base location of the ray.
+ *             dir  - The unit vector direction of the ray.
+ *             tmin - Hits at or before this distance are misses.
+ *             tmax - Hits at or beyond this distance are misses.
+ *
+ * Return:     The distance to the hit location, or MISS.
+ */
+static double obj_test(void *data, int item, double *base, double *dir,
+                       double tmin, double tmax) {
+    objs_t *objs = (objs_t *)data; /* The objects */
+
+    return object_hits(objs->objs[item], base, dir, tmin, tmax, objs->skip);
+}
+
+/*
+ * bvh_build:  Builds a bounding volume hierarchy over the specified objects,
+ *             which must not change shape or move while it is in use.
+ *
+ * Parameters: objs  - The objects, which are copied.
+ *             count - The number of objects.
+ *
+ * Return:     A pointer to the new hierarchy.
+ */
+bvh_t *bvh_build(obj_t **objs, int count) {
+    bvh_t *bvh = bvh_tree(count, obj_box, objs); /* The new hierarchy */
+    int   i;                                     /* Object index      */
+
+    bvh->objs = (obj_t **)Malloc((count + 1) * sizeof(obj_t *));
+
+    for (i = 0; i < count; ++i) {
+        bvh->objs[i] = objs[i];
+    }
+
+    return bvh;
+}
+
+/*
+ * bvh_hits:   Finds the closest object hit by a ray between tmin and tmax,
+ *             or with any set, the first object found.  The object the ray
+ *             leaves is tested with object_hits.
+ *
+ * Parameters: bvh  - The hierarchy, built by bvh_build.
+ *             base - The base location of the ray.
+ *             dir  - The unit vector direction of the ray.
+ *             tmin - Hits at or before this distance are misses.
+ *             tmax - Hits at or beyond this distance are misses, set to the
+ *                    distance of the object hit.
+ *             skip - The object the ray leaves, or NULL.
+ *             any  - Nonzero to stop at the first object hit.
+ *
+ * Return:     The object hit, or NULL.
+ */
+obj_t *bvh_hits(bvh_t *bvh, double *base, double *dir, double tmin,
+                double *tmax, obj_t *skip, int any) {
+    objs_t objs; /* The objects and the object the ray leaves */
+    int    hit;  /* The index of the object hit               */
+
+    objs.objs = bvh->objs;
+    objs.skip = skip;
+    hit       = bvh_trace(bvh, base, dir, tmin, tmax, obj_test, &objs, any);
+
+    return hit < 0 ? NULL : bvh->objs[hit];
+}
+
+/*
+ * bvh_bounds: Finds the bounding box of every item of the hierarchy.
+ *
+ * Parameters: bvh - The hierarchy.
+ *             lo  - Storage for the low corner of the box.
+ *             hi  - Storage for the high corner of the box.
+ *
+ * Return:     Nonzero if the items are bounded, zero otherwise.
+ */
+int bvh_bounds(bvh_t *bvh, double *lo, double *hi) {
+    if (bvh->num_rest > 0 || bvh->num_items == 0) {
+        return 0;
+    }
+
+    vec_scale3(1.0, bvh->nodes[0].lo, lo);
+    vec_scale3(1.0, bvh->nodes[0].hi, hi);
+
+    return 1;
+}
+
+/*
+ * bvh_destroy: Destroys the specified hierarchy, leaving its items alone.
+ *
+ * Parameters:  bvh - The hierarchy to destroy, or NULL.
+ */
+void bvh_destroy(bvh_t *bvh) {
+    if (bvh) {
+        Free(bvh->nodes);
+        Free(bvh->items);
+        Free(bvh->rest);
+        Free(bvh->objs);
+        Free(bvh);
+    }
+}
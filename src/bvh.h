@@ -0,0 +1,70 @@
+/*
+ * bvh.h:   This header file contains the implementation specifications for
+ *          a bounding volume hierarchy over a set of items, such as the
+ *          objects of a scene or the triangles of a mesh.
+ *
+ * Author:  Scott Gigawatt
+ *
+ * Version: 18 October 2026
+ */
+
+#ifndef BVH_H
+#define BVH_H
+
+#include "object.h"
+
+/* The most items in a leaf of the hierarchy */
+#ifndef BVH_LEAF
+    #define BVH_LEAF 4
+#endif
+
+/* The deepest hierarchy that can be traversed */
+#define BVH_DEPTH 64
+
+/* Finds the bounding box (lo, hi) of an item, returning zero if unbounded */
+typedef int (*bvh_box_t)(void *data, int item, double *lo, double *hi);
+
+/* Tests a ray against an item, returning the distance to the hit or MISS */
+typedef double (*bvh_test_t)(void *data, int item, double *base, double *dir,
+                             double tmin, double tmax);
+
+/* A node of the hierarchy, stored depth first */
+typedef struct bvh_node_type {
+    double lo[VEC_SIZE]; /* The low corner of the bounding box         */
+    double hi[VEC_SIZE]; /* The high corner of the bounding box        */
+    int    start;        /* First item of a leaf, or the right child   */
+    int    count;        /* Items in a leaf, or 0 for an inner node    */
+} bvh_node_t;
+
+/* A bounding volume hierarchy */
+typedef struct bvh_type {
+    bvh_node_t *nodes;     /* The nodes, the root first                  */
+    int        num_nodes;  /* The number of nodes                        */
+    int        *items;     /* The bounded items, in leaf order           */
+    int        num_items;  /* The number of bounded items                */
+    int        *rest;      /* The unbounded items, tested one by one     */
+    int        num_rest;   /* The number of unbounded items              */
+    obj_t      **objs;     /* The objects, for a hierarchy over objects  */
+} bvh_t;
+
+/* Builds a hierarchy over items 0 to count - 1 */
+bvh_t *bvh_tree(int count, bvh_box_t box, void *data);
+
+/* Finds the closest item hit by a ray, or any item if asked */
+int bvh_trace(bvh_t *bvh, double *base, double *dir, double tmin,
+              double *tmax, bvh_test_t test, void *data, int any);
+
+/* Builds a hierarchy over the specified objects */
+bvh_t *bvh_build(obj_t **objs, int count);
+
+/* Finds the closest object hit by a ray, or any object if asked */
+obj_t *bvh_hits(bvh_t *bvh, double *base, double *dir, double tmin,
+                double *tmax, obj_t *skip, int any);
+
+/* Finds the bounding box of every item, returning zero if unbounded */
+int bvh_bounds(bvh_t *bvh, double *lo, double *hi);
+
+/* Destroys the specified hierarchy, but not its items */
+void bvh_destroy(bvh_t *bvh);
+
+#endif
@@ -0,0 +1,294 @@
+/*
+ * checkpoint.c: This file contains the implementation details for rendering
+ *               in tiles with periodic checkpoints.  At most every few
+ *               seconds (--checkpoint-every, where 0 means after every
+ *               tile), the finished tiles are copied into a snapshot which
+ *               a separate writer thread saves, so the render never waits on
+ *               the disk.  A snapshot is only taken while the writer is idle.
+ *               Each write goes to a temporary file that then replaces the
+ *               checkpoint, so a render pre-empted mid-write leaves the last
+ *               checkpoint intact.
+ *
+ *               A checkpoint holds a header identifying the scene and image,
+ *               one byte per tile marking the finished tiles, and then only
+ *               the pixels of the finished tiles.  With --resume, finished
+ *               tiles are read back and skipped.  Pixels are traced exactly
+ *               as by render_image, so a resumed image is identical to one
+ *               rendered in one go.
+ *
+ * Author:       Scott Gigawatt
+ *
+ * Version:      18 October 2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "checkpoint.h"
+#include "image.h"
+#include "mem.h"
+
+/*
+ * snapshot:   Copies the header, the finished tile map, and the pixels of
+ *             the finished tiles into the snapshot buffer.
+ *
+ * Parameters: ckpt   - The checkpoint state.
+ *             model  - The model being rendered.
+ *             pixmap - The image data.
+ */
+static void snapshot(ckpt_t *ckpt, model_t *model, unsigned char *pixmap) {
+    unsigned char *cursor = ckpt->snap;            /* The write position */
+    int           num     = ckpt->tiles[0] * ckpt->tiles[1]; /* Tiles    */
+    int           rect[CROP_SIZE];                 /* A tile's pixels    */
+    int           t;                               /* Tile index         */
+    int           i;                               /* Row index          */
+    size_t        row;                             /* Row length         */
+
+    memcpy(cursor, CKPT_ID, sizeof(CKPT_ID));
+    cursor += sizeof(CKPT_ID);
+    memcpy(cursor, &ckpt->hash, sizeof(ckpt->hash));
+    cursor += sizeof(ckpt->hash);
+    memcpy(cursor, ckpt->head, sizeof(ckpt->head));
+    cursor += sizeof(ckpt->head);
+    memcpy(cursor, ckpt->done, num);
+    cursor += num;
+
+    for (t = 0; t < num; ++t) {
+        if (!ckpt->done[t]) {
+            continue;
+        }
+
+        image_tile(ckpt->region, ckpt->tiles, t, rect);
+        row = (rect[2] - rect[0]) * PIXEL_SIZE;
+
+        for (i = rect[1]; i < rect[3]; ++i) {
+            memcpy(cursor, image_pixel(model, pixmap, ckpt->region, rect[0], i),
+                                                                         row);
+            cursor += row;
+        }
+    }
+
+    ckpt->size = cursor - ckpt->snap;
+}
+
+/*
+ * save:       Writes the snapshot to a temporary file, then replaces the
+ *             checkpoint with it.
+ *
+ * Parameters: ckpt - The checkpoint state.
+ */
+static void save(ckpt_t *ckpt) {
+    char temp[BUF_SIZE]; /* The file being written */
+    FILE *out;           /* The temporary file     */
+
+    snprintf(temp, BUF_SIZE, "%s.tmp", ckpt->name);
+
+    if ((out = fopen(temp, "wb")) == NULL ||
+        fwrite(ckpt->snap, 1, ckpt->size, out) != ckpt->size ||
+        fflush(out) || fsync(fileno(out)) || fclose(out) ||
+        rename(temp, ckpt->name)) {
+        perror(ckpt->name);
+        fprintf(stderr, "save: error: checkpoint not written\n");
+    }
+}
+
+/*
+ * write_loop: The writer thread, which saves each snapshot handed to it
+ *             until the render is done.
+ *
+ * Parameters: arg - The checkpoint state.
+ *
+ * Return:     NULL.
+ */
+static void *write_loop(void *arg) {
+    ckpt_t *ckpt = (ckpt_t *)arg; /* The checkpoint state */
+
+    pthread_mutex_lock(&ckpt->lock);
+
+    for (;;) {
+        while (!ckpt->busy && !ckpt->stop) {
+            pthread_cond_wait(&ckpt->wake, &ckpt->lock);
+        }
+
+        if (!ckpt->busy) {
+            break;
+        }
+
+        /* The snapshot is not touched while busy, so write it unlocked */
+        pthread_mutex_unlock(&ckpt->lock);
+        save(ckpt);
+        pthread_mutex_lock(&ckpt->lock);
+
+        ckpt->busy = 0;
+    }
+
+    pthread_mutex_unlock(&ckpt->lock);
+
+    return NULL;
+}
+
+/*
+ * restore:    Reads the finished tiles of a matching checkpoint back into
+ *             the image.
+ *
+ * Parameters: ckpt   - The checkpoint state.
+ *             model  - The model being rendered.
+ *             pixmap - The image data.
+ *
+ * Return:     The number of tiles restored.
+ */
+static int restore(ckpt_t *ckpt, model_t *model, unsigned char *pixmap) {
+    char          id[sizeof(CKPT_ID)]; /* The file identifier    */
+    unsigned long hash;                /* The scene of the file  */
+    int           head[CKPT_HEAD];     /* The image of the file  */
+    int           num = ckpt->tiles[0] * ckpt->tiles[1]; /* Tiles */
+    int           count = 0;           /* The tiles restored     */
+    int           rect[CROP_SIZE];     /* A tile's pixels        */
+    int           t;                   /* Tile index             */
+    int           i;                   /* Row index              */
+    size_t        row;                 /* Row length             */
+    FILE          *in;                 /* The checkpoint file    */
+
+    if ((in = fopen(ckpt->name, "rb")) == NULL) {
+        fprintf(stderr, "No checkpoint in %s, starting afresh\n", ckpt->name);
+        return 0;
+    }
+
+    /* Only resume a checkpoint of the same scene, image and shading */
+    if (fread(id, 1, sizeof(id), in) != sizeof(id) ||
+        fread(&hash, sizeof(hash), 1, in) != 1 ||
+        fread(head, sizeof(head), 1, in) != 1 ||
+        memcmp(id, CKPT_ID, sizeof(id)) || hash != ckpt->hash ||
+        memcmp(head, ckpt->head, sizeof(head)) ||
+        fread(ckpt->done, 1, num, in) != num) {
+        msg_exit(stderr, "restore: error: checkpoint is of another render");
+    }
+
+    for (t = 0; t < num; ++t) {
+        if (!ckpt->done[t]) {
+            continue;
+        }
+
+        image_tile(ckpt->region, ckpt->tiles, t, rect);
+        row = (rect[2] - rect[0]) * PIXEL_SIZE;
+
+        for (i = rect[1]; i < rect[3]; ++i) {
+            if (fread(image_pixel(model, pixmap, ckpt->region, rect[0], i), 1,
+                                                        row, in) != row) {
+                msg_exit(stderr, "restore: error: checkpoint is truncated");
+            }
+        }
+
+        ++count;
+    }
+
+    fclose(in);
+
+    return count;
+}
+
+/*
+ * ckpt_render: Renders the image tile by tile, handing the finished tiles
+ *              to the writer thread at most every few seconds.  The
+ *              checkpoint is left for the caller to remove once the image
+ *              has been written.
+ *
+ * Parameters:  model  - The model on which the image will be based.
+ *              pixmap - Storage for the (r, g, b) image data, allocated by
+ *                       image_alloc.
+ */
+void ckpt_render(model_t *model, unsigned char *pixmap) {
+    ckpt_t ckpt;              /* The checkpoint state      */
+    int    rect[CROP_SIZE];   /* A tile's pixels           */
+    int    height;            /* The image height          */
+    int    num;               /* The number of tiles       */
+    int    skip = 0;          /* The tiles restored        */
+    int    t;                 /* Tile index                */
+    time_t last;              /* The last checkpoint time  */
+
+    /* Rays must be recorded in order, from the top left */
+    if (model->deps) {
+        msg_exit(stderr, "ckpt_render: error: cannot checkpoint with --deps");
+    }
+
+    memset(&ckpt, 0, sizeof(ckpt));
+    height      = model->proj->win_size_pixel[1];
+    ckpt.name   = model->opts->checkpoint;
+    ckpt.hash   = model_hash(model);
+    ckpt.region = ckpt.head + 3;
+
+    /* Identify the image by its size, samples, rectangle, tiling and shading */
+    ckpt.head[0] = model->proj->win_size_pixel[0];
+    ckpt.head[1] = height;
+    ckpt.head[2] = model->opts->samples;
+    ckpt.head[7] = TILE_SIZE;
+    ckpt.head[8] = model->opts->light_samples;
+    ckpt.head[9] = model->opts->lightmap;
+    image_region(model, ckpt.region);
+
+    num = image_tiles(ckpt.region, ckpt.tiles);
+
+    ckpt.done = (unsigned char *)Malloc(num);
+    ckpt.snap = (unsigned char *)Malloc(sizeof(CKPT_ID) + sizeof(ckpt.hash) +
+                                        sizeof(ckpt.head) + num +
+                                        (ckpt.region[2] - ckpt.region[0]) *
+                                        (ckpt.region[3] - ckpt.region[1]) *
+                                        PIXEL_SIZE);
+    memset(ckpt.done, 0, num);
+
+    /* Pick up where an earlier render left off */
+    if (model->opts->resume) {
+        skip = restore(&ckpt, model, pixmap);
+        fprintf(stderr, "Resumed %d of %d tiles from %s\n", skip, num,
+                                                         ckpt.name);
+    }
+
+    pthread_mutex_init(&ckpt.lock, NULL);
+    pthread_cond_init(&ckpt.wake, NULL);
+
+    if (pthread_create(&ckpt.writer, NULL, write_loop, &ckpt)) {
+        msg_exit(stderr, "ckpt_render: error: cannot start writer thread");
+    }
+
+    last = time(NULL);
+
+    for (t = 0; t < num; ++t) {
+        if (ckpt.done[t]) {
+            continue;
+        }
+
+        /* Trace the tile exactly as render_image would */
+        image_tile(ckpt.region, ckpt.tiles, t, rect);
+        render_tile(model, pixmap, ckpt.region, rect);
+
+        ckpt.done[t] = 1;
+
+        /* Hand a snapshot to the writer if it is due and the writer idle */
+        if (time(NULL) - last >= model->opts->ckpt_secs) {
+            pthread_mutex_lock(&ckpt.lock);
+
+            if (!ckpt.busy) {
+                snapshot(&ckpt, model, pixmap);
+                ckpt.busy = 1;
+                last      = time(NULL);
+                pthread_cond_signal(&ckpt.wake);
+            }
+
+            pthread_mutex_unlock(&ckpt.lock);
+        }
+    }
+
+    /* Let the writer finish; make_image drops the checkpoint */
+    pthread_mutex_lock(&ckpt.lock);
+    ckpt.stop = 1;
+    pthread_cond_signal(&ckpt.wake);
+    pthread_mutex_unlock(&ckpt.lock);
+    pthread_join(ckpt.writer, NULL);
+
+    pthread_mutex_destroy(&ckpt.lock);
+    pthread_cond_destroy(&ckpt.wake);
+    Free(ckpt.done);
+    Free(ckpt.snap);
+}
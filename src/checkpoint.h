@@ -0,0 +1,42 @@
+/*
+ * checkpoint.h: This header file contains the implementation specifications
+ *               for rendering in tiles with periodic checkpoints.
+ *
+ * Author:       Scott Gigawatt
+ *
+ * Version:      18 October 2026
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <pthread.h>
+#include "model.h"
+
+/* The identifier at the start of a checkpoint file */
+#define CKPT_ID "RTCKPT2"
+
+/* Header values: width, height, samples, crop, tile size, light samples, map */
+#define CKPT_HEAD 10
+
+/* The state of a checkpointed render */
+typedef struct ckpt_type {
+    char            *name;           /* The checkpoint file            */
+    unsigned long   hash;            /* Identifies the scene           */
+    int             head[CKPT_HEAD]; /* Identifies the image           */
+    int             *region;         /* The traced pixels (in head)    */
+    int             tiles[2];        /* The number of tiles (x, y)     */
+    unsigned char   *done;           /* Set for each finished tile     */
+    unsigned char   *snap;           /* The checkpoint being written   */
+    size_t          size;            /* The length of the checkpoint   */
+    int             busy;            /* Set while a write is pending   */
+    int             stop;            /* Set when the render is done    */
+    pthread_t       writer;          /* Writes checkpoints to the file */
+    pthread_mutex_t lock;            /* Guards busy and stop           */
+    pthread_cond_t  wake;            /* Signals the writer             */
+} ckpt_t;
+
+/* Renders the image tile by tile, checkpointing the finished tiles */
+void ckpt_render(model_t *model, unsigned char *pixmap);
+
+#endif
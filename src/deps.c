@@ -0,0 +1,325 @@
+/*
+ * deps.c:  This file contains the implementation details for the per-pixel
+ *          ray dependency buffer.  While a model's deps is set, every ray
+ *          passed to ray_trace is recorded against the pixel being rendered,
+ *          with the object it hit.  Together with the light positions, the
+ *          rays are enough to tell whether an edited object could change the
+ *          pixel: either the pixel's rays hit the object, or the object lies
+ *          across one of its rays or shadow rays.
+ *
+ *          Objects are identified by their index in file order (counting
+ *          lights), so the indices stay valid across loads of the scene.
+ *
+ * Author:  Scott Gigawatt
+ *
+ * Version: 18 October 2026
+ */
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "deps.h"
+#include "mem.h"
+
+/* The initial number of rays allocated per pixel */
+#define RAYS_PER_PIXEL 2
+
+/*
+ * first_id:   Finds the smallest object id in the specified list.
+ *
+ * Parameters: list  - The list of objects.
+ *             first - The smallest id found so far.
+ *
+ * Return:     The smallest object id.
+ */
+static int first_id(list_t *list, int first) {
+    link_t *cursor = NULL; /* Cursor into the list */
+
+    for (cursor = list->head; cursor; cursor = cursor->next) {
+        if (((obj_t *)cursor->item)->objid < first) {
+            first = ((obj_t *)cursor->item)->objid;
+        }
+    }
+
+    return first;
+}
+
+/*
+ * view_values: Records the projection of the model and the camera options
+ *              it was rendered with, exactly as given.
+ *
+ * Parameters:  model - The model.
+ *              view  - Storage for the view values (DEPS_VIEW).
+ */
+static void view_values(model_t *model, double *view) {
+    opts_t *opts = model->opts; /* The rendering options */
+
+    memcpy(view, model->proj->win_size_world, 2 * sizeof(double));
+    memcpy(view + 2, model->proj->view_point, 3 * sizeof(double));
+    view[5] = opts->camera;
+    memcpy(view + 6, opts->eye, 3 * sizeof(double));
+    memcpy(view + 9, opts->look, 3 * sizeof(double));
+    memcpy(view + 12, opts->up, 3 * sizeof(double));
+    view[15] = opts->fov;
+    view[16] = opts->aspect;
+}
+
+/*
+ * deps_alloc: Allocates a dependency buffer with room for the specified
+ *             number of rays.
+ *
+ * Parameters: width    - The image width in pixels.
+ *             height   - The image height in pixels.
+ *             max_rays - The number of rays to allocate.
+ *
+ * Return:     A pointer to the new dependency buffer.
+ */
+static deps_t *deps_alloc(int width, int height, long max_rays) {
+    deps_t *deps = (deps_t *)Malloc(sizeof(deps_t)); /* The new buffer */
+
+    memset(deps, 0, sizeof(deps_t));
+    deps->size[0]  = width;
+    deps->size[1]  = height;
+    deps->start    = (long *)Malloc(((long)width * height + 1) * sizeof(long));
+    deps->max_rays = max_rays > 0 ? max_rays : 1;
+    deps->rays     = (dep_ray_t *)Malloc(deps->max_rays * sizeof(dep_ray_t));
+
+    return deps;
+}
+
+/*
+ * deps_init:  Creates an empty dependency buffer for rendering the whole
+ *             image of the specified model.
+ *
+ * Parameters: model - The model that will be rendered.
+ *
+ * Return:     A pointer to the new dependency buffer.
+ */
+deps_t *deps_init(model_t *model) {
+    deps_t *deps = NULL; /* The new buffer */
+
+    /* Pixels must be recorded in order, from the top left */
+    if (model->opts->crop[2] > 0) {
+        msg_exit(stderr, "deps_init: error: cannot record a cropped image");
+    }
+
+    deps = deps_alloc(model->proj->win_size_pixel[0],
+                      model->proj->win_size_pixel[1],
+                      (long)model->proj->win_size_pixel[0] *
+                      model->proj->win_size_pixel[1] * RAYS_PER_PIXEL);
+
+    deps->samples  = model->opts->samples;
+    deps->lsamples = model->opts->light_samples;
+    deps->lightmap = model->opts->lightmap;
+    deps->pixel    = 0;
+    deps->start[0] = 0;
+    deps->first    = first_id(model->lights, first_id(model->scene, INT_MAX));
+    view_values(model, deps->view);
+
+    return deps;
+}
+
+/*
+ * deps_match: Determines whether two dependency buffers record renders of
+ *             the same view, with the same sampling and shading options.
+ *             Otherwise every pixel may differ.
+ *
+ * Parameters: a - The first dependency buffer.
+ *             b - The second dependency buffer.
+ *
+ * Return:     Nonzero if they match, zero otherwise.
+ */
+int deps_match(deps_t *a, deps_t *b) {
+    return a->samples == b->samples && a->lsamples == b->lsamples &&
+           a->lightmap == b->lightmap &&
+           !memcmp(a->view, b->view, sizeof(a->view));
+}
+
+/*
+ * deps_pixel: Starts recording the rays of the next pixel, in row major
+ *             order from the top left of the image.
+ *
+ * Parameters: deps - The dependency buffer.
+ */
+void deps_pixel(deps_t *deps) {
+    if (deps->pixel >= deps->size[0] * deps->size[1]) {
+        msg_exit(stderr, "deps_pixel: error: too many pixels");
+    }
+
+    /* The current pixel ends where the next one starts */
+    deps->start[++deps->pixel] = deps->num_rays;
+}
+
+/*
+ * grow:       Makes room for the specified number of further rays.
+ *
+ * Parameters: deps  - The dependency buffer.
+ *             count - The number of rays to be added.
+ */
+static void grow(deps_t *deps, long count) {
+    dep_ray_t *rays = NULL; /* The larger ray storage */
+
+    if (deps->num_rays + count <= deps->max_rays) {
+        return;
+    }
+
+    while (deps->num_rays + count > deps->max_rays) {
+        deps->max_rays *= 2;
+    }
+
+    rays = (dep_ray_t *)Malloc(deps->max_rays * sizeof(dep_ray_t));
+    memcpy(rays, deps->rays, deps->num_rays * sizeof(dep_ray_t));
+    Free(deps->rays);
+    deps->rays = rays;
+}
+
+/*
+ * deps_ray:   Records a ray traced for the current pixel.
+ *
+ * Parameters: deps - The dependency buffer.
+ *             base - The origin of the ray (x, y, z).
+ *             dir  - The unit direction of the ray (x, y, z).
+ *             dist - The distance to the closest hit, or MISS.
+ *             obj  - The closest object hit, or NULL.
+ */
+void deps_ray(deps_t *deps, double *base, double *dir, double dist,
+              obj_t *obj) {
+    dep_ray_t *ray; /* The new ray */
+    int       i;    /* Counter     */
+
+    grow(deps, 1);
+    ray = &deps->rays[deps->num_rays++];
+
+    for (i = 0; i < VEC_SIZE; ++i) {
+        ray->base[i] = base[i];
+        ray->dir[i]  = dir[i];
+    }
+
+    ray->dist = obj ? dist : MISS;
+    ray->obj  = obj ? deps_index(deps, obj) : MISS;
+
+    deps->start[deps->pixel] = deps->num_rays;
+}
+
+/*
+ * deps_copy:  Records the rays of a pixel of an earlier render as the rays
+ *             of the current pixel.
+ *
+ * Parameters: deps  - The dependency buffer.
+ *             from  - The dependency buffer of the earlier render.
+ *             pixel - The pixel of the earlier render.
+ */
+void deps_copy(deps_t *deps, deps_t *from, int pixel) {
+    long count = from->start[pixel + 1] - from->start[pixel]; /* Rays */
+
+    grow(deps, count);
+    memcpy(deps->rays + deps->num_rays, from->rays + from->start[pixel],
+                                        count * sizeof(dep_ray_t));
+
+    deps->num_rays          += count;
+    deps->start[deps->pixel] = deps->num_rays;
+}
+
+/*
+ * deps_index: Finds the file order index of an object of the model being
+ *             recorded, counting lights.
+ *
+ * Parameters: deps - The dependency buffer.
+ *             obj  - The object.
+ *
+ * Return:     The index of the object.
+ */
+int deps_index(deps_t *deps, obj_t *obj) {
+    return obj->objid - deps->first;
+}
+
+/*
+ * deps_read:  Reads a dependency buffer written by deps_write.
+ *
+ * Parameters: in - The file from which the buffer will be read.
+ *
+ * Return:     A pointer to the dependency buffer.
+ */
+deps_t *deps_read(FILE *in) {
+    deps_t *deps = NULL;        /* The buffer read        */
+    char   id[sizeof(DEPS_ID)]; /* The file identifier    */
+    int    size[DEPS_HEAD];     /* The header values      */
+    double view[DEPS_VIEW];     /* The view values        */
+    long   num_rays;            /* The number of rays     */
+    long   pixels;              /* The number of pixels   */
+
+    if (fread(id, 1, sizeof(id), in) != sizeof(id) ||
+        memcmp(id, DEPS_ID, sizeof(id)) ||
+        fread(size, sizeof(int), DEPS_HEAD, in) != DEPS_HEAD ||
+        fread(view, sizeof(double), DEPS_VIEW, in) != DEPS_VIEW ||
+        fread(&num_rays, sizeof(long), 1, in) != 1 ||
+        size[0] < 1 || size[1] < 1 || num_rays < 0) {
+        msg_exit(stderr, "deps_read: error: invalid dependency file");
+    }
+
+    pixels        = (long)size[0] * size[1];
+    deps          = deps_alloc(size[0], size[1], num_rays);
+    deps->samples  = size[2];
+    deps->lsamples = size[3];
+    deps->lightmap = size[4];
+    deps->pixel    = pixels;
+    memcpy(deps->view, view, sizeof(view));
+
+    if (fread(deps->start, sizeof(long), pixels + 1, in) != pixels + 1 ||
+        fread(deps->rays, sizeof(dep_ray_t), num_rays, in) != num_rays ||
+        deps->start[pixels] != num_rays) {
+        msg_exit(stderr, "deps_read: error: invalid dependency file");
+    }
+
+    deps->num_rays = num_rays;
+
+    return deps;
+}
+
+/*
+ * deps_write: Writes a complete dependency buffer to the specified file.
+ *             The file is only meant to be read back on the same machine.
+ *
+ * Parameters: out  - The file to which the buffer will be written.
+ *             deps - The dependency buffer.
+ *
+ * Return:     EXIT_SUCCESS if successful, EXIT_FAILURE otherwise.
+ */
+int deps_write(FILE *out, deps_t *deps) {
+    long pixels = (long)deps->size[0] * deps->size[1]; /* Pixel count */
+    int  size[DEPS_HEAD];                              /* Header      */
+
+    if (deps->pixel != pixels) {
+        msg_exit(stderr, "deps_write: error: incomplete dependency buffer");
+    }
+
+    size[0] = deps->size[0];
+    size[1] = deps->size[1];
+    size[2] = deps->samples;
+    size[3] = deps->lsamples;
+    size[4] = deps->lightmap;
+
+    if (fwrite(DEPS_ID, 1, sizeof(DEPS_ID), out) != sizeof(DEPS_ID) ||
+        fwrite(size, sizeof(int), DEPS_HEAD, out) != DEPS_HEAD ||
+        fwrite(deps->view, sizeof(double), DEPS_VIEW, out) != DEPS_VIEW ||
+        fwrite(&deps->num_rays, sizeof(long), 1, out) != 1 ||
+        fwrite(deps->start, sizeof(long), pixels + 1, out) != pixels + 1 ||
+        fwrite(deps->rays, sizeof(dep_ray_t), deps->num_rays, out) !=
+                                                    deps->num_rays) {
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/*
+ * deps_destroy: Destroys the specified dependency buffer.
+ *
+ * Parameters:   deps - The dependency buffer to destroy.
+ */
+void deps_destroy(deps_t *deps) {
+    Free(deps->start);
+    Free(deps->rays);
+    Free(deps);
+}
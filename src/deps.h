@@ -0,0 +1,77 @@
+/*
+ * deps.h:  This header file contains the implementation specifications for
+ *          the per-pixel ray dependency buffer used by incremental renders.
+ *
+ * Author:  Scott Gigawatt
+ *
+ * Version: 18 October 2026
+ */
+
+#ifndef DEPS_H
+#define DEPS_H
+
+#include <stdio.h>
+#include "model.h"
+#include "object.h"
+
+/* The identifier at the start of a dependency file */
+#define DEPS_ID "RTDEPS2"
+
+/* Header values: width, height, samples, light samples, lightmap texels */
+#define DEPS_HEAD 5
+
+/* View values: window, view point, camera bits, eye, look, up, fov, aspect */
+#define DEPS_VIEW 17
+
+/* A ray traced for a pixel (shadow rays follow from its hit and the lights) */
+typedef struct dep_ray_type {
+    float base[VEC_SIZE]; /* The origin of the ray (x, y, z)        */
+    float dir[VEC_SIZE];  /* The unit direction of the ray          */
+    float dist;           /* The distance to the hit, or MISS       */
+    int   obj;            /* File order index of the hit, or MISS   */
+} dep_ray_t;
+
+/* The rays traced for every pixel of an image */
+typedef struct deps_type {
+    int       size[VEC_SIZE - 1]; /* The image size in pixels (x, y)      */
+    int       samples;            /* Samples per pixel of the render      */
+    int       lsamples;           /* Shadow rays per hit of the render    */
+    int       lightmap;           /* Lightmap texels of the render        */
+    double    view[DEPS_VIEW];    /* The projection and camera options    */
+    int       first;              /* Object id of the first object loaded */
+    int       pixel;              /* The pixel being recorded             */
+    long      *start;             /* Index of each pixel's first ray      */
+    dep_ray_t *rays;              /* The rays, in pixel order             */
+    long      num_rays;           /* The number of rays                   */
+    long      max_rays;           /* The allocated number of rays         */
+} deps_t;
+
+/* Creates an empty dependency buffer for rendering the model */
+deps_t *deps_init(model_t *model);
+
+/* Determines whether two buffers record the same view and shading */
+int deps_match(deps_t *a, deps_t *b);
+
+/* Starts recording the rays of the next pixel */
+void deps_pixel(deps_t *deps);
+
+/* Records a ray traced for the current pixel */
+void deps_ray(deps_t *deps, double *base, double *dir, double dist,
+              obj_t *obj);
+
+/* Copies the rays of a pixel from an earlier render */
+void deps_copy(deps_t *deps, deps_t *from, int pixel);
+
+/* Finds the file order index of an object of the model */
+int deps_index(deps_t *deps, obj_t *obj);
+
+/* Reads a dependency buffer from the specified file */
+deps_t *deps_read(FILE *in);
+
+/* Writes a dependency buffer to the specified file */
+int deps_write(FILE *out, deps_t *deps);
+
+/* Destroys the specified dependency buffer */
+void deps_destroy(deps_t *deps);
+
+#endif
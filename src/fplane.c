@@ -27,11 +27,12 @@ obj_t *fplane_init(FILE *in, int objtype) {
     plane_t  *plane = (plane_t *)obj->priv;                 /* The plane    */
     fplane_t *new   = (fplane_t *)Malloc(sizeof(fplane_t)); /* Finite plane */
     int      rc     = 0;                                    /* Read count   */
-    double   proj[VEC_SIZE];                                /* Projection   */
 
     /* Link the finite plane structure to the plane */
     plane->priv  = new;
+    new->priv    = NULL;
     obj->hits    = hits_fplane;
+    obj->bounds  = fplane_bounds;
     obj->destroy = plane_destroy;
     obj->dump    = fplane_dump;
 
@@ -78,7 +79,7 @@ int fplane_dump(FILE *out, obj_t *obj) {
     fprintf(out, "Dumping object of type FPlane\n");
 
     /* Dump standard plane data */
-    plane_dump(stderr, obj);
+    plane_dump(out, obj);
 
     /* Print out the fplane information */
     fprintf(out, "\nFPlane data\n");
@@ -101,24 +102,29 @@ int fplane_dump(FILE *out, obj_t *obj) {
  *
  * Parameters:  base - The origins of the ray (x, y, z).
  *              dir  - The direction of the ray (x, y, z).
+ *              tmin - Hits at or before this distance are misses.
+ *              tmax - Hits at or beyond this distance are misses.
  *              obj  - The finite plane object we want to hit.
  *
- * Return:      The distance to the hit location.
+ * Return:      The distance to the hit location, or MISS.
  */
-double hits_fplane(double *base, double *dir, obj_t *obj) {
+double hits_fplane(double *base, double *dir, double tmin, double tmax,
+                   obj_t *obj) {
     plane_t  *plane  = (plane_t *)obj->priv;    /* The infinite plane */
     fplane_t *fplane = (fplane_t *)plane->priv; /* The finite plane   */
     double   hitloc[VEC_SIZE];                  /* The new hit point  */
     double   distance;                          /* Hit point distance */
     int      i;                                 /* Counter            */
 
-    /* Check to see if ray hit the infinite plane */
-    if ( (distance = hits_plane(base, dir, obj)) < 0 ) {
+    /* Check to see if ray hit the infinite plane within the bounds */
+    if ( (distance = hits_plane(base, dir, tmin, tmax, obj)) < 0 ) {
         return distance;
     }
 
     /* Transform the finite plane coordinates */
-    vec_diff3(plane->point, obj->hitloc, hitloc);
+    vec_scale3(distance, dir, hitloc);
+    vec_sum3(base, hitloc, hitloc);
+    vec_diff3(plane->point, hitloc, hitloc);
     mat_xform3(fplane->rotmat, hitloc, hitloc);
 
     for (i = 0; i < VEC_SIZE - 1; ++i) {
@@ -130,3 +136,35 @@ double hits_fplane(double *base, double *dir, obj_t *obj) {
 
     return distance;
 }
+
+/*
+ * fplane_bounds: Finds the bounding box of a finite plane object, around
+ *                its four corners.
+ *
+ * Parameters:    obj - The finite plane object.
+ *                lo  - Storage for the low corner of the box.
+ *                hi  - Storage for the high corner of the box.
+ *
+ * Return:        Nonzero, since a finite plane is bounded.
+ */
+int fplane_bounds(obj_t *obj, double *lo, double *hi) {
+    plane_t  *plane  = (plane_t *)obj->priv;    /* The infinite plane */
+    fplane_t *fplane = (fplane_t *)plane->priv; /* The finite plane   */
+    double   corner;                            /* A corner, one axis */
+    int      c;                                 /* Corner index       */
+    int      i;                                 /* Axis index         */
+
+    for (i = 0; i < VEC_SIZE; ++i) {
+        lo[i] = hi[i] = plane->point[i];
+
+        for (c = 1; c < 4; ++c) {
+            corner = plane->point[i] +
+                     (c & 1) * fplane->size[0] * fplane->rotmat[0][i] +
+                     (c >> 1) * fplane->size[1] * fplane->rotmat[1][i];
+            lo[i]  = corner < lo[i] ? corner : lo[i];
+            hi[i]  = corner > hi[i] ? corner : hi[i];
+        }
+    }
+
+    return 1;
+}
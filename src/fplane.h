@@ -18,6 +18,7 @@ typedef struct fplane_type {
     double size[VEC_SIZE - 1];         /* The width and height */
     double rotmat[VEC_SIZE][VEC_SIZE]; /* Rotation matrix      */
     double lasthit[VEC_SIZE - 1];      /* Used for textures    */
+    void   *priv;                      /* Data for subtypes    */
 } fplane_t;
 
 /* Allocates memory for, initializes, and returns a new finite plane */
@@ -27,6 +28,10 @@ obj_t *fplane_init(FILE *in, int objtype);
 int fplane_dump(FILE *out, obj_t *obj);
 
 /* Determines if a ray hits a finite plane object */
-double hits_fplane(double *base, double *dir, obj_t *obj);
+double hits_fplane(double *base, double *dir, double tmin, double tmax,
+                   obj_t *obj);
+
+/* Finds the bounding box of a finite plane object */
+int fplane_bounds(obj_t *obj, double *lo, double *hi);
 
 #endif
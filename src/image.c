@@ -7,52 +7,367 @@
  * Version: 22 March 2011
  */
 
+#include <math.h>
+#include <unistd.h>
 #include "image.h"
+#include "bvh.h"
+#include "checkpoint.h"
+#include "deps.h"
+#include "light.h"
+#include "lighttree.h"
+#include "lightmap.h"
 #include "mem.h"
 #include "object.h"
 #include "veclib3d.h"
 
 /* 
- * make_image: Creates a new image based on the specified model.
+ * make_image: Creates a new image based on the specified model and writes
+ *             it to standard out.
  *
  * Parameters: model - The model on which the image will be based.
  */
 void make_image(model_t *model) {
     unsigned char *pixmap = NULL; /* The image data                       */
-    unsigned char *pixloc = NULL; /* The location of the current pixel    */
     int           vals[VEC_SIZE]; /* The width, height, and max color val */
-    int           i;              /* Counter variable                     */
-    int           j;              /* Counter variable                     */
+
+    /* Allocate space for the image data */
+    pixmap = image_alloc(model, vals);
+
+    /* Order the scene objects by hit frequency */
+    if (model->opts->reorder) {
+        profile_hits(model);
+    }
+
+    /* Record the rays of every pixel for a later incremental render */
+    if (model->opts->deps) {
+        model->deps = deps_init(model);
+    }
+
+    /* Render in tiles, checkpointing the finished ones, if requested */
+    if (model->opts->checkpoint) {
+        ckpt_render(model, pixmap);
+    } else {
+        render_image(model, pixmap);
+    }
+
+    /* Write the PPM image data to standard out */
+    write_ppm(pixmap, ID_COLOR, vals, stdout);
+
+    /* Drop the checkpoint only once the whole image is out */
+    if (model->opts->checkpoint) {
+        if (fflush(stdout) || ferror(stdout)) {
+            msg_exit(stderr, "make_image: error: cannot write image");
+        }
+
+        unlink(model->opts->checkpoint);
+    }
+
+    if (model->deps) {
+        save_deps(model);
+    }
+
+    Free(pixmap);
+}
+
+/*
+ * save_deps:  Writes the rays recorded for the model to the dependency file
+ *             named by the rendering options, then stops recording.
+ *
+ * Parameters: model - The model that was rendered.
+ */
+void save_deps(model_t *model) {
+    FILE *out = fopen(model->opts->deps, "wb"); /* The dependency file */
+
+    if (out == NULL || deps_write(out, model->deps) || fclose(out)) {
+        msg_exit(stderr, "save_deps: error: cannot write dependency file");
+    }
+
+    deps_destroy(model->deps);
+    model->deps = NULL;
+}
+
+/*
+ * image_region: Finds the rectangle of pixels to trace, which is the crop
+ *               rectangle if one was given and the whole image otherwise.
+ *
+ * Parameters:   model  - The model on which the image will be based.
+ *               region - The rectangle (x0, y0, x1, y1), where row 0 is the
+ *                        top of the image and x1 and y1 are exclusive.
+ */
+void image_region(model_t *model, int *region) {
+    int *crop = model->opts->crop; /* The crop rectangle */
+
+    if (crop[2] > 0) {
+        memcpy(region, crop, CROP_SIZE * sizeof(int));
+    } else {
+        region[0] = region[1] = 0;
+        region[2] = model->proj->win_size_pixel[0];
+        region[3] = model->proj->win_size_pixel[1];
+    }
+}
+
+/*
+ * image_size: Finds the size of the image, which covers only the crop
+ *             rectangle unless the full frame was requested.
+ *
+ * Parameters: model   - The model on which the image will be based.
+ *             vals[0] - Set to the image width.
+ *             vals[1] - Set to the image height.
+ *             vals[2] - Set to the maximum color value.
+ */
+void image_size(model_t *model, int *vals) {
+    int region[CROP_SIZE]; /* The traced pixels */
+
+    image_region(model, region);
+
+    /* Check that the crop rectangle lies within the image */
+    if (region[0] < 0 || region[1] < 0 || region[0] >= region[2] ||
+        region[1] >= region[3] ||
+        region[2] > model->proj->win_size_pixel[0] ||
+        region[3] > model->proj->win_size_pixel[1]) {
+        msg_exit(stderr, "image_size: error: invalid crop rectangle");
+    }
 
     /* Initialize PPM header values (x, y) and maximum color value */
-    vals[0] = model->proj->win_size_pixel[0];
-    vals[1] = model->proj->win_size_pixel[1];
+    if (model->opts->full) {
+        vals[0] = model->proj->win_size_pixel[0];
+        vals[1] = model->proj->win_size_pixel[1];
+    } else {
+        vals[0] = region[2] - region[0];
+        vals[1] = region[3] - region[1];
+    }
+
     vals[2] = MAX_COLOR;
+}
 
-    /* Allocate space for the image data */
+/*
+ * image_alloc: Allocates a cleared buffer for the image (see image_size).
+ *
+ * Parameters:  model - The model on which the image will be based.
+ *              vals  - Set to the PPM header values (see image_size).
+ *
+ * Return:      A pointer to the image data.
+ */
+unsigned char *image_alloc(model_t *model, int *vals) {
+    unsigned char *pixmap = NULL; /* The image data */
+
+    image_size(model, vals);
+
+    /* Pixels outside of the crop rectangle are left as background */
     pixmap = (unsigned char *)Malloc(vals[0] * vals[1] * PIXEL_SIZE);
+    memset(pixmap, 0, vals[0] * vals[1] * PIXEL_SIZE);
+
+    return pixmap;
+}
+
+/*
+ * image_pixel: Finds the location of a pixel in an image buffer allocated by
+ *              image_alloc, which starts at the corner of the crop rectangle
+ *              unless the full frame was requested.
+ *
+ * Parameters:  model  - The model on which the image is based.
+ *              pixmap - The image data.
+ *              region - The rectangle of traced pixels (see image_region).
+ *              x      - The column of the pixel.
+ *              row    - The row of the pixel (row 0 is the top).
+ *
+ * Return:      A pointer to the (r, g, b) value of the pixel.
+ */
+unsigned char *image_pixel(model_t *model, unsigned char *pixmap,
+                           int *region, int x, int row) {
+    if (model->opts->full) {
+        return pixmap + (model->proj->win_size_pixel[0] * row + x)
+                                                        * PIXEL_SIZE;
+    }
 
-    /* Loop through the pixmap and create the image pixels */
-    for (i = 0; i < vals[1]; ++i) {
-        for (j = 0; j < vals[0]; ++j) {
-            /* Get the location of the next pixel */
-            pixloc = pixmap + (vals[0] * i * PIXEL_SIZE) + (j * PIXEL_SIZE);
+    return pixmap + ((region[2] - region[0]) * (row - region[1]) +
+                                              (x - region[0])) * PIXEL_SIZE;
+}
+
+/*
+ * image_tiles: Counts the TILE_SIZE square tiles covering a rectangle of
+ *              pixels.  Tiles are numbered in row major order from the top
+ *              left of the rectangle.
+ *
+ * Parameters:  region - The rectangle (x0, y0, x1, y1) (see image_region).
+ *              tiles  - Set to the number of tiles across and down.
+ *
+ * Return:      The number of tiles.
+ */
+int image_tiles(int *region, int *tiles) {
+    tiles[0] = (region[2] - region[0] + TILE_SIZE - 1) / TILE_SIZE;
+    tiles[1] = (region[3] - region[1] + TILE_SIZE - 1) / TILE_SIZE;
+
+    return tiles[0] * tiles[1];
+}
+
+/*
+ * image_tile: Finds the pixels of a tile, clipped to the rectangle.
+ *
+ * Parameters: region - The rectangle (x0, y0, x1, y1) (see image_region).
+ *             tiles  - The number of tiles across and down (image_tiles).
+ *             tile   - The tile index, in row major order.
+ *             rect   - The rectangle (x0, y0, x1, y1) of the tile.
+ */
+void image_tile(int *region, int *tiles, int tile, int *rect) {
+    rect[0] = region[0] + (tile % tiles[0]) * TILE_SIZE;
+    rect[1] = region[1] + (tile / tiles[0]) * TILE_SIZE;
+    rect[2] = rect[0] + TILE_SIZE < region[2] ? rect[0] + TILE_SIZE
+                                              : region[2];
+    rect[3] = rect[1] + TILE_SIZE < region[3] ? rect[1] + TILE_SIZE
+                                              : region[3];
+}
+
+/*
+ * image_cull: Marks the lights that cannot reach any primary hit of a
+ *             rectangle of pixels.  The rays of the rectangle, jitter
+ *             included, lie within the cone from the view point around the
+ *             directions to its corners.
+ *
+ * Parameters: model - The model being rendered.
+ *             rect  - The rectangle (x0, y0, x1, y1) of pixels.
+ */
+void image_cull(model_t *model, int *rect) {
+    proj_t *proj          = model->proj;       /* The projection        */
+    double axis[VEC_SIZE] = { 0.0, 0.0, 0.0 }; /* The cone axis         */
+    double angle          = 0.0;               /* The cone half angle   */
+    double corner[4][VEC_SIZE];                /* Directions to corners */
+    double world[VEC_SIZE];                    /* A corner in the world */
+    double cosine;                             /* Cosine to a corner    */
+    int    height;                             /* The image height      */
+    int    i;                                  /* Counter               */
+
+    height = proj->win_size_pixel[1];
+
+    for (i = 0; i < 4; ++i) {
+        map_xy_to_world(proj, (i & 1 ? rect[2] : rect[0]) - 0.5,
+                        height - (i & 2 ? rect[3] : rect[1]) + 0.5, world);
+        vec_diff3(proj->view_point, world, corner[i]);
+        vec_unit3(corner[i], corner[i]);
+        vec_sum3(axis, corner[i], axis);
+    }
+
+    vec_unit3(axis, axis);
+
+    for (i = 0; i < 4; ++i) {
+        cosine = vec_dot3(axis, corner[i]);
+        cosine = cosine > 1.0 ? 1.0 : cosine < -1.0 ? -1.0 : cosine;
+        angle  = acos(cosine) > angle ? acos(cosine) : angle;
+    }
 
+    light_cull(model, proj->view_point, axis, angle);
+}
+
+/*
+ * render_tile: Renders a rectangle of pixels of the image, skipping the
+ *              lights that cannot reach any of their primary hits.
+ *
+ * Parameters:  model  - The model on which the image will be based.
+ *              pixmap - Storage for the (r, g, b) image data, allocated by
+ *                       image_alloc.
+ *              region - The rectangle of traced pixels (see image_region).
+ *              rect   - The rectangle (x0, y0, x1, y1) of pixels to render.
+ */
+void render_tile(model_t *model, unsigned char *pixmap, int *region,
+                 int *rect) {
+    int height = model->proj->win_size_pixel[1]; /* The image height */
+    int i;                                       /* Counter variable */
+    int j;                                       /* Counter variable */
+
+    image_cull(model, rect);
+
+    for (i = rect[1]; i < rect[3]; ++i) {
+        for (j = rect[0]; j < rect[2]; ++j) {
             /* Create the next pixel in the image */
-            make_pixel(model, j, vals[1] - i, pixloc);
+            if (model->deps) {
+                deps_pixel(model->deps);
+            }
+
+            make_pixel(model, j, height - i,
+                       image_pixel(model, pixmap, region, j, i));
 
             /* Debugging information */
             #ifdef DBG_PIX
-                fprintf(stderr, "\nPIX %4d %4d - ", vals[0], vals[1]);
+                fprintf(stderr, "\nPIX %4d %4d - ", j, height - i);
             #endif
         }
     }
-    
-    /* Write the PPM image data to standard out */
-    write_ppm(pixmap, ID_COLOR, vals, stdout);
 
-    /* Free any memory associated with the ray tracer */
-    dalloc(model, pixmap);
+    /* Other renderers see every light */
+    light_cull(model, NULL, NULL, 0.0);
+}
+
+/* 
+ * render_image: Renders the pixels of the image described by the model's
+ *               projection into the specified buffer.  Only the crop
+ *               rectangle is traced, with each pixel mapped to the world
+ *               exactly as in the full image.  The rectangle is rendered a
+ *               tile at a time, so lights can be culled for whole tiles,
+ *               unless rays are being recorded, which must be in order.
+ *
+ * Parameters:   model  - The model on which the image will be based.
+ *               pixmap - Storage for the (r, g, b) image data, allocated by
+ *                        image_alloc.
+ */
+void render_image(model_t *model, unsigned char *pixmap) {
+    int region[CROP_SIZE]; /* The traced pixels        */
+    int rect[CROP_SIZE];   /* A tile's pixels          */
+    int tiles[2];          /* Tiles across and down    */
+    int num;               /* The number of tiles      */
+    int t;                 /* Tile index               */
+
+    image_region(model, region);
+
+    if (model->deps) {
+        render_tile(model, pixmap, region, region);
+        return;
+    }
+
+    num = image_tiles(region, tiles);
+
+    for (t = 0; t < num; ++t) {
+        image_tile(region, tiles, t, rect);
+        render_tile(model, pixmap, region, rect);
+    }
+}
+
+/*
+ * profile_hits: Traces every REORDER_STEP-th pixel of the image (or of its
+ *               crop rectangle), counting how often each object is the
+ *               closest hit for primary, shadow, and reflected rays, then
+ *               orders the traversal array so the most frequently hit
+ *               objects are tested first.
+ *
+ * Parameters:   model - The model whose scene will be ordered.
+ */
+void profile_hits(model_t *model) {
+    unsigned char pixval[PIXEL_SIZE]; /* Discarded pixel value */
+    int           region[CROP_SIZE];  /* The traced pixels     */
+    int           i;                  /* Counter variable      */
+    int           j;                  /* Counter variable      */
+
+    image_region(model, region);
+
+    /* Trace the low resolution pre-pass */
+    for (i = region[1]; i < region[3]; i += REORDER_STEP) {
+        for (j = region[0]; j < region[2]; j += REORDER_STEP) {
+            make_pixel(model, j, model->proj->win_size_pixel[1] - i, pixval);
+        }
+    }
+
+    model_reorder(model);
+
+    /* Debugging information */
+    #ifdef DBG_ORDER
+        fprintf(stderr, "Object order (id:hits) - \n");
+
+        for (i = 0; i < model->num_objs; ++i) {
+            fprintf(stderr, "%d:%ld ", model->objs[i]->objid,
+                                       model->objs[i]->nhits);
+        }
+
+        fprintf(stderr, "\n");
+    #endif
 }
 
 /* 
@@ -64,27 +379,44 @@ void make_image(model_t *model) {
  *             pixval - The newly computed pixel value (r, g, b).
  */
 void make_pixel(model_t *model, int x, int y, unsigned char *pixval) {
-    double *world = alloca(VEC_SIZE * sizeof(double)); /* World coordinates */
-    double *ivec  = alloca(VEC_SIZE * sizeof(double)); /* Intensity values  */
-    double *total = alloca(VEC_SIZE * sizeof(double)); /* Total intensity   */
-    double dir[VEC_SIZE];                              /* Direction vector  */
-    int    i;                                          /* Counter           */
+    double total[VEC_SIZE]; /* Total intensity */
 
     /* Initialize total intensity vector to zero */
     *total = *(total + 1) = *(total  + 2) = 0.0;
 
-    /* Check to see if anti-aliasing is turned off */
-    #ifndef AA_SAMPLES
-        #define AA_SAMPLES 1
-    #endif
-
     /* Take multiple samples for anti-aliasing */
-    for (i = 0; i < AA_SAMPLES; ++i) {
+    sample_pixel(model, x, y, 0, model->opts->samples, total);
+    set_pixel(total, model->opts->samples, pixval);
+}
+
+/* 
+ * sample_pixel: Traces a run of the anti-aliasing samples of a pixel,
+ *               adding their intensities to a running total.  Since every
+ *               sample has its own seed, tracing the samples in several runs
+ *               gives the same total as tracing them all at once.
+ *
+ * Parameters:   model - The model on which the pixel color will be based.
+ *               x     - The x pixel coordinate.
+ *               y     - The y pixel coordinate.
+ *               first - The index of the first sample to trace.
+ *               count - The number of samples to trace.
+ *               total - The total intensity (r, g, b) of the samples.
+ */
+void sample_pixel(model_t *model, int x, int y, int first, int count,
+                  double *total) {
+    double *world = alloca(VEC_SIZE * sizeof(double)); /* World coordinates */
+    double *ivec  = alloca(VEC_SIZE * sizeof(double)); /* Intensity values  */
+    double dir[VEC_SIZE];                              /* Direction vector  */
+    unsigned int seed;                                 /* Sample jitter     */
+    int    i;                                          /* Counter           */
+
+    for (i = first; i < first + count; ++i) {
         /* Initialize the intensity to zero */
         *ivec = *(ivec + 1) = *(ivec  + 2) = 0.0;
 
-        /* Get the world coordinates */
-        map_pix_to_world(model->proj, x, y, world);
+        /* Get the world coordinates, jittered by this sample's own seed */
+        seed = sample_seed(x, y, i);
+        map_pix_to_world(model->proj, x, y, &seed, world);
 
         /* Debugging information */
         #ifdef DBG_PIX
@@ -100,8 +432,20 @@ void make_pixel(model_t *model, int x, int y, unsigned char *pixval) {
         ray_trace(model, model->proj->view_point, dir, ivec, 0.0, NULL);
         vec_sum3(ivec, total, total);
     }
+}
 
-    vec_scale3((1.0 / AA_SAMPLES), total, ivec);
+/* 
+ * set_pixel:  Sets a pixel value from the total intensity of its samples.
+ *
+ * Parameters: total  - The total intensity (r, g, b) of the samples.
+ *             count  - The number of samples.
+ *             pixval - The pixel value (r, g, b).
+ */
+void set_pixel(double *total, int count, unsigned char *pixval) {
+    double ivec[VEC_SIZE]; /* Intensity values */
+    int    i;              /* Counter          */
+
+    vec_scale3((1.0 / count), total, ivec);
 
     /* Clamp each element of intensity to the range [0.0, 1.0] */
     for (i = 0; i < VEC_SIZE; ++i) {
@@ -124,15 +468,45 @@ void make_pixel(model_t *model, int x, int y, unsigned char *pixval) {
  * Parameters:       proj  - A pointer to a projection definition.
  *                   x     - The x pixel coordinate.
  *                   y     - The y pixel coordinate.
+ *                   seed  - The random number state of the pixel sample.
  *                   world - A pointer to the world coordinates (x, y, z).
  */
-void map_pix_to_world(proj_t *proj, int x, int y, double *world) {
+void map_pix_to_world(proj_t *proj, int x, int y, unsigned int *seed,
+                      double *world) {
     double rx; /* Random x value */
     double ry; /* Random y value */
 
     /* Compute the random pixel for anti-aliasing */
-    rx = randpix(x); 
-    ry = randpix(y);
+    rx = randpix(x, seed); 
+    ry = randpix(y, seed);
+
+    map_xy_to_world(proj, rx, ry, world);
+}
+
+/*
+ * map_xy_to_world: Maps a point of the screen, in pixels, to 3D world
+ *                  coordinates.
+ *
+ * Parameters:      proj  - A pointer to a projection definition.
+ *                  rx    - The x coordinate, in pixels.
+ *                  ry    - The y coordinate, in pixels.
+ *                  world - A pointer to the world coordinates (x, y, z).
+ */
+void map_xy_to_world(proj_t *proj, double rx, double ry, double *world) {
+    double u; /* Fraction of the window across */
+    double v; /* Fraction of the window up     */
+
+    /* Step across the camera's window from its corner */
+    if (proj->camera) {
+        u = rx / (proj->win_size_pixel[0] - 1);
+        v = ry / (proj->win_size_pixel[1] - 1);
+
+        *(world + 0) = proj->corner[0] + u * proj->du[0] + v * proj->dv[0];
+        *(world + 1) = proj->corner[1] + u * proj->du[1] + v * proj->dv[1];
+        *(world + 2) = proj->corner[2] + u * proj->du[2] + v * proj->dv[2];
+
+        return;
+    }
 
     /* Map the x value */
     *(world + 0)  = rx / (proj->win_size_pixel[0] - 1)
@@ -148,15 +522,42 @@ void map_pix_to_world(proj_t *proj, int x, int y, double *world) {
     *(world + 2)  = 0.0;
 }
 
+/*
+ * sample_seed: Computes the random number seed for a single pixel sample.
+ *              The seed depends only on the pixel, the sample index, and
+ *              RAND_SEED, so a sample is jittered identically no matter in
+ *              which order the image is rendered.
+ *
+ * Parameters:  x      - The x pixel coordinate.
+ *              y      - The y pixel coordinate.
+ *              sample - The index of the sample within the pixel.
+ *
+ * Return:      The seed for the pixel sample.
+ */
+unsigned int sample_seed(int x, int y, int sample) {
+    unsigned int hash = RAND_SEED; /* The mixed seed */
+
+    /* Mix in each coordinate (murmur3 finalizer after each step) */
+    hash = (hash ^ (unsigned int)x) * 0x85ebca6bu;
+    hash = (hash ^ (hash >> 13))    * 0xc2b2ae35u;
+    hash = (hash ^ (unsigned int)y) * 0x85ebca6bu;
+    hash = (hash ^ (hash >> 13))    * 0xc2b2ae35u;
+    hash = (hash ^ (unsigned int)sample) * 0x85ebca6bu;
+    hash = (hash ^ (hash >> 16))    * 0xc2b2ae35u;
+
+    return hash ^ (hash >> 16);
+}
+
 /*
  * randpix:    Calculates a random pixel value.
  *
- * Parameters: x - The coordinate on which to base the random pixel value.
+ * Parameters: x    - The coordinate on which to base the random pixel value.
+ *             seed - The random number state of the pixel sample.
  *
  * Return:     A random pixel value.
  */
-double randpix(int x) {
-   return x + ( ((double)rand() / RAND_MAX) - .5 );
+double randpix(int x, unsigned int *seed) {
+   return x + ( ((double)rand_r(seed) / RAND_MAX) - .5 );
 }
 
 /*
@@ -194,13 +595,46 @@ void write_ppm(unsigned char *buf, char *id, int *vals, FILE *stream) {
     }
 }
 
+/*
+ * read_ppm:   Reads a color PPM image with a maximum color value of
+ *             MAX_COLOR, as written by write_ppm.
+ *
+ * Parameters: in      - The input file stream.
+ *             vals[0] - Set to the image width.
+ *             vals[1] - Set to the image height.
+ *             vals[2] - Set to the maximum color value.
+ *
+ * Return:     A pointer to the image data.
+ */
+unsigned char *read_ppm(FILE *in, int *vals) {
+    unsigned char *buf = NULL;  /* The image data       */
+    char          id[VEC_SIZE]; /* The PPM header id    */
+    int           num_pix;      /* The number of pixels */
+
+    /* Read the PPM header information */
+    if (fscanf(in, "%2s %d %d %d", id, vals, vals + 1, vals + 2) != 4 ||
+        strcmp(id, ID_COLOR) || vals[0] < 1 || vals[1] < 1 ||
+        vals[2] != MAX_COLOR || fgetc(in) == EOF) {
+        msg_exit(stderr, "read_ppm: error: invalid header");
+    }
+
+    num_pix = vals[0] * vals[1];
+    buf     = (unsigned char *)Malloc(num_pix * PIXEL_SIZE);
+
+    /* Read the color PPM data */
+    if (fread(buf, PIXEL_SIZE, num_pix, in) != num_pix) {
+        msg_exit(stderr, "read_ppm: error: invalid pixel count");
+    }
+
+    return buf;
+}
+
 /*
  * dalloc:     Releases any memory associated with the ray tracer.
  *
  * Parameters: model  - The model to to free.
- *             pixmap - The image data to free.
  */
-void dalloc(model_t *model, unsigned char *pixmap) {
+void dalloc(model_t *model) {
     link_t *cursor = NULL; /* Cursor into the scene list      */
     obj_t  *obj    = NULL; /* The current object in the scene */
 
@@ -211,7 +645,8 @@ void dalloc(model_t *model, unsigned char *pixmap) {
             /* Get the current object */
             obj = (obj_t *)cursor->item;
 
-            /* Free memory associated with the object */
+            /* Free memory associated with the object and its lightmap */
+            lightmap_destroy(obj->lightmap);
             obj->destroy(obj);
         }
     }
@@ -232,8 +667,12 @@ void dalloc(model_t *model, unsigned char *pixmap) {
     list_del(model->scene);
     list_del(model->lights);
 
-    /* Free memory associated with the projection, model, and image */
+    /* Free memory associated with the projection and model */
+    bvh_destroy(model->insts);
+    lighttree_destroy(model->ltree);
+    light_table_destroy(model->ltab);
+    Free(model->objs);
+    Free(model->opts);
     Free(model->proj); 
     Free(model); 
-    Free(pixmap);
 }
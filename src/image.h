@@ -16,6 +16,16 @@
 #define PIXEL_SIZE 3 * sizeof(unsigned char)
 #define CHAR_SIZE  sizeof(unsigned char)
 
+/* The width and height of a tile in pixels */
+#ifndef TILE_SIZE
+    #define TILE_SIZE 32
+#endif
+
+/* The seed from which every pixel sample's jitter is derived */
+#ifndef RAND_SEED
+    #define RAND_SEED 1
+#endif
+
 #include <stdlib.h>
 #include <string.h>
 #include "model.h"
@@ -25,19 +35,71 @@
 /* Creates a new image based on the specified model */
 void make_image(model_t *model);
 
+/* Writes the recorded rays to the dependency file and stops recording */
+void save_deps(model_t *model);
+
+/* Finds the rectangle of pixels to trace */
+void image_region(model_t *model, int *region);
+
+/* Finds the size of the image and sets its PPM header values */
+void image_size(model_t *model, int *vals);
+
+/* Allocates a cleared buffer for the image and sets its PPM header values */
+unsigned char *image_alloc(model_t *model, int *vals);
+
+/* Finds the location of a pixel in an image buffer */
+unsigned char *image_pixel(model_t *model, unsigned char *pixmap,
+                           int *region, int x, int row);
+
+/* Counts the tiles covering a rectangle of pixels */
+int image_tiles(int *region, int *tiles);
+
+/* Finds the pixels of a tile, clipped to a rectangle of pixels */
+void image_tile(int *region, int *tiles, int tile, int *rect);
+
+/* Marks the lights that cannot reach any primary hit of a rectangle */
+void image_cull(model_t *model, int *rect);
+
+/* Renders a rectangle of pixels of the image into the specified buffer */
+void render_tile(model_t *model, unsigned char *pixmap, int *region,
+                 int *rect);
+
+/* Renders the pixels of the image into the specified buffer */
+void render_image(model_t *model, unsigned char *pixmap);
+
+/* Orders the scene by hit frequency measured on a low resolution pre-pass */
+void profile_hits(model_t *model);
+
 /* Creates a new pixel based on the specified model */
 void make_pixel(model_t *model, int x, int y, unsigned char *pixval);
 
+/* Adds the intensities of a run of a pixel's samples to a total */
+void sample_pixel(model_t *model, int x, int y, int first, int count,
+                  double *total);
+
+/* Sets a pixel value from the total intensity of its samples */
+void set_pixel(double *total, int count, unsigned char *pixval);
+
 /* Maps the 2D screen coordinates to 3D world coordinates */
-void map_pix_to_world(proj_t *proj, int x, int y, double *world);
+void map_pix_to_world(proj_t *proj, int x, int y, unsigned int *seed,
+                      double *world);
+
+/* Maps a point of the screen to 3D world coordinates */
+void map_xy_to_world(proj_t *proj, double rx, double ry, double *world);
+
+/* Computes the random number seed for a single pixel sample */
+unsigned int sample_seed(int x, int y, int sample);
 
 /* Calculates a random pixel value */
-double randpix(int x);
+double randpix(int x, unsigned int *seed);
 
 /* Writes the PPM image data pointed to by *buf to the specified file */
 void write_ppm(unsigned char *buf, char *id, int *vals, FILE *stream);
 
+/* Reads a color PPM image from the specified file */
+unsigned char *read_ppm(FILE *in, int *vals);
+
 /* Releases any memory associated with the ray tracer */
-void dalloc(model_t *model, unsigned char *pixmap);
+void dalloc(model_t *model);
 
 #endif
@@ -0,0 +1,441 @@
+/*
+ * incr.c:  This file contains the implementation details for incremental
+ *          rendering.  Given the earlier scene, the image rendered from it,
+ *          and the rays recorded for each of its pixels (see deps.c), only
+ *          the pixels that the edits could have changed are traced again:
+ *
+ *            - a ray of the pixel hit an object that was edited, or
+ *            - the earlier or the edited version of such an object lies
+ *              across a ray of the pixel, or across a shadow ray from one
+ *              of its hits toward a light (or near it, for a light with
+ *              an area).
+ *
+ *          Objects are matched by their index in file order and compared by
+ *          their dumps.  Editing a light, the projection, the camera, or the
+ *          sampling or shading options changes every pixel, so the whole
+ *          image is traced, as does any edit of a scene whose planes are
+ *          baked (--lightmap).  The view and options of the earlier render
+ *          are kept in the dependency file.  The
+ *          dependency file is rewritten for the new scene, ready for the
+ *          next edit.
+ *
+ * Author:  Scott Gigawatt
+ *
+ * Version: 18 October 2026
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "incr.h"
+#include "deps.h"
+#include "image.h"
+#include "light.h"
+#include "mem.h"
+
+/* Slack added to recorded distances, which are stored as floats */
+#define DIST_SLACK 1e-4
+
+/*
+ * id_compare: Compares two objects by their id.
+ *
+ * Parameters: a - A pointer to the first object pointer.
+ *             b - A pointer to the second object pointer.
+ *
+ * Return:     Negative if a was loaded first, positive otherwise.
+ */
+static int id_compare(const void *a, const void *b) {
+    return (*(obj_t **)a)->objid - (*(obj_t **)b)->objid;
+}
+
+/*
+ * file_order: Lists the objects and lights of a model in file order.
+ *
+ * Parameters: model - The model.
+ *             count - Set to the number of objects.
+ *
+ * Return:     The objects, in the order they were loaded.
+ */
+static obj_t **file_order(model_t *model, int *count) {
+    obj_t  **objs  = NULL; /* The objects in file order */
+    link_t *cursor = NULL; /* Cursor into a list        */
+    int    i       = 0;    /* Object index              */
+
+    /* Count the objects and lights */
+    for (cursor = model->scene->head; cursor; cursor = cursor->next) {
+        ++i;
+    }
+
+    for (cursor = model->lights->head; cursor; cursor = cursor->next) {
+        ++i;
+    }
+
+    objs   = (obj_t **)Malloc((i + 1) * sizeof(obj_t *));
+    *count = 0;
+
+    for (cursor = model->scene->head; cursor; cursor = cursor->next) {
+        objs[(*count)++] = (obj_t *)cursor->item;
+    }
+
+    for (cursor = model->lights->head; cursor; cursor = cursor->next) {
+        objs[(*count)++] = (obj_t *)cursor->item;
+    }
+
+    qsort(objs, *count, sizeof(obj_t *), id_compare);
+
+    return objs;
+}
+
+/*
+ * same_object: Compares two objects by their dumps.
+ *
+ * Parameters:  a - The first object.
+ *              b - The second object.
+ *
+ * Return:      Nonzero if the objects are identical, zero otherwise.
+ */
+static int same_object(obj_t *a, obj_t *b) {
+    char   *text[2] = { NULL, NULL }; /* The object dumps    */
+    size_t size[2];                   /* The dump lengths    */
+    FILE   *out;                      /* The dump stream     */
+    int    same;                      /* The comparison      */
+
+    if (a->objtype != b->objtype) {
+        return 0;
+    }
+
+    if ((out = open_memstream(&text[0], &size[0])) == NULL) {
+        msg_exit(stderr, "same_object: error: cannot dump object");
+    }
+
+    a->dump(out, a);
+    fclose(out);
+
+    if ((out = open_memstream(&text[1], &size[1])) == NULL) {
+        msg_exit(stderr, "same_object: error: cannot dump object");
+    }
+
+    b->dump(out, b);
+    fclose(out);
+
+    same = size[0] == size[1] && !memcmp(text[0], text[1], size[0]);
+
+    free(text[0]);
+    free(text[1]);
+
+    return same;
+}
+
+/*
+ * crosses:    Determines whether any of the probe objects lies across the
+ *             specified ray segment.
+ *
+ * Parameters: probes     - The objects to test.
+ *             num_probes - The number of objects.
+ *             base       - The origin of the segment (x, y, z).
+ *             dir        - The unit direction of the segment (x, y, z).
+ *             tmax       - The length of the segment.
+ *
+ * Return:     Nonzero if an object is hit, zero otherwise.
+ */
+static int crosses(obj_t **probes, int num_probes, double *base, double *dir,
+                   double tmax) {
+    int i; /* Probe index */
+
+    for (i = 0; i < num_probes; ++i) {
+        if (probes[i]->hits(base, dir, 0.0, tmax, probes[i]) != MISS) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * grazes:     Determines whether any of the probe objects may come within a
+ *             distance of the specified ray segment, which holds every
+ *             shadow ray from its origin to a light of that radius about
+ *             the end of the segment.  An object comes that near only if the
+ *             segment crosses its bounding box grown by the distance, and
+ *             an unbounded object is taken to come near every segment.
+ *
+ * Parameters: probes     - The objects to test.
+ *             num_probes - The number of objects.
+ *             base       - The origin of the segment (x, y, z).
+ *             dir        - The unit direction of the segment (x, y, z).
+ *             tmax       - The length of the segment.
+ *             radius     - The distance.
+ *
+ * Return:     Nonzero if an object may come near, zero otherwise.
+ */
+static int grazes(obj_t **probes, int num_probes, double *base, double *dir,
+                  double tmax, double radius) {
+    double lo[VEC_SIZE]; /* The low corner of a box  */
+    double hi[VEC_SIZE]; /* The high corner of a box */
+    double t0;           /* Entry along the segment  */
+    double t1;           /* Exit along the segment   */
+    double near;         /* Entry of one slab        */
+    double far;          /* Exit of one slab         */
+    int    i;            /* Probe index              */
+    int    j;            /* Axis index               */
+
+    for (i = 0; i < num_probes; ++i) {
+        if (!probes[i]->bounds || !probes[i]->bounds(probes[i], lo, hi)) {
+            return 1;
+        }
+
+        for (j = 0, t0 = 0.0, t1 = tmax; j < VEC_SIZE && t0 <= t1; ++j) {
+            lo[j] -= radius;
+            hi[j] += radius;
+
+            if (dir[j] == 0.0) {
+                t1 = base[j] < lo[j] || base[j] > hi[j] ? -1.0 : t1;
+                continue;
+            }
+
+            near = (lo[j] - base[j]) / dir[j];
+            far  = (hi[j] - base[j]) / dir[j];
+            t0   = fmax(t0, fmin(near, far));
+            t1   = fmin(t1, fmax(near, far));
+        }
+
+        if (t0 <= t1) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * affected:   Determines whether the edits could change a pixel.
+ *
+ * Parameters: model      - The edited model.
+ *             deps       - The rays recorded for the earlier render.
+ *             pixel      - The pixel index.
+ *             changed    - Nonzero for each edited file order index.
+ *             num_change - The number of file order indices.
+ *             probes     - Both versions of each edited object.
+ *             num_probes - The number of probe objects.
+ *
+ * Return:     Nonzero if the pixel must be traced again, zero otherwise.
+ */
+static int affected(model_t *model, deps_t *deps, int pixel, char *changed,
+                    int num_change, obj_t **probes, int num_probes) {
+    dep_ray_t *ray    = NULL;   /* A recorded ray                */
+    link_t    *cursor = NULL;   /* Cursor into the light list    */
+    double    base[VEC_SIZE];   /* The origin of the ray         */
+    double    dir[VEC_SIZE];    /* The direction of the ray      */
+    double    hit[VEC_SIZE];    /* The hit location of the ray   */
+    double    shadow[VEC_SIZE]; /* The direction toward a light  */
+    double    dist;             /* The length of a segment       */
+    light_t   *light;           /* A light                       */
+    long      r;                /* Ray index                     */
+    int       i;                /* Counter                       */
+
+    for (r = deps->start[pixel]; r < deps->start[pixel + 1]; ++r) {
+        ray = &deps->rays[r];
+
+        /* The ray hit an edited object */
+        if (ray->obj != MISS && (ray->obj >= num_change || changed[ray->obj])) {
+            return 1;
+        }
+
+        for (i = 0; i < VEC_SIZE; ++i) {
+            base[i] = ray->base[i];
+            dir[i]  = ray->dir[i];
+        }
+
+        /* An edited object lies in front of the hit */
+        dist = ray->dist == MISS ? HUGE_VAL : ray->dist + DIST_SLACK;
+
+        if (crosses(probes, num_probes, base, dir, dist)) {
+            return 1;
+        }
+
+        if (ray->obj == MISS) {
+            continue;
+        }
+
+        /* An edited object lies between the hit and a light */
+        vec_scale3(ray->dist, dir, hit);
+        vec_sum3(base, hit, hit);
+
+        for (cursor = model->lights->head; cursor; cursor = cursor->next) {
+            light = (light_t *)((obj_t *)cursor->item)->priv;
+            vec_diff3(hit, light->center, shadow);
+            dist = vec_length3(shadow);
+            vec_unit3(shadow, shadow);
+
+            /* Shadow rays toward a light with an area fan out across it */
+            if (light->radius > 0.0 ? grazes(probes, num_probes, hit, shadow,
+                                             dist, light->radius)
+                                    : crosses(probes, num_probes, hit, shadow,
+                                              dist)) {
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * open_file:  Opens a file named by the rendering options.
+ *
+ * Parameters: name - The file name.
+ *
+ * Return:     The open file.
+ */
+static FILE *open_file(char *name) {
+    FILE *in = fopen(name, "rb"); /* The file */
+
+    if (in == NULL) {
+        perror(name);
+        msg_exit(stderr, "incr_render: error: cannot open file");
+    }
+
+    return in;
+}
+
+/*
+ * incr_render: Renders the edited model to standard out, tracing only the
+ *              pixels the edits could have changed and copying the rest
+ *              from the earlier image.
+ *
+ * Parameters:  model - The edited model.
+ */
+void incr_render(model_t *model) {
+    model_t       *old       = NULL; /* The earlier model               */
+    deps_t        *prev      = NULL; /* The earlier rays                */
+    unsigned char *base      = NULL; /* The earlier image               */
+    unsigned char *pixmap    = NULL; /* The new image                   */
+    obj_t         **before   = NULL; /* Earlier objects in file order   */
+    obj_t         **after    = NULL; /* Edited objects in file order    */
+    obj_t         **probes   = NULL; /* Both versions of edited objects */
+    char          *changed   = NULL; /* Set for each edited index       */
+    FILE          *in        = NULL; /* An input file                   */
+    int           vals[VEC_SIZE];    /* The PPM header values           */
+    int           size[VEC_SIZE];    /* The earlier PPM header values   */
+    int           num_before;        /* The number of earlier objects   */
+    int           num_after;         /* The number of edited objects    */
+    int           num_change;        /* The larger object count         */
+    int           num_probes = 0;    /* The number of probe objects     */
+    int           edits      = 0;    /* The number of edited objects    */
+    int           full       = 0;    /* Set to trace every pixel        */
+    int           width;             /* The image width                 */
+    int           height;            /* The image height                */
+    long          traced     = 0;    /* The number of traced pixels     */
+    int           i;                 /* Counter variable                */
+    int           j;                 /* Counter variable                */
+
+    if (!model->opts->deps || !model->opts->base) {
+        msg_exit(stderr, "incr_render: error: --deps and --base are needed");
+    }
+
+    width  = model->proj->win_size_pixel[0];
+    height = model->proj->win_size_pixel[1];
+
+    /* Load the earlier scene, its rays, and its image */
+    in  = open_file(model->opts->incremental);
+    old = model_load(in, NULL, width, height);
+    fclose(in);
+
+    in   = open_file(model->opts->deps);
+    prev = deps_read(in);
+    fclose(in);
+
+    in   = open_file(model->opts->base);
+    base = read_ppm(in, size);
+    fclose(in);
+
+    if (size[0] != width || size[1] != height ||
+        prev->size[0] != width || prev->size[1] != height) {
+        msg_exit(stderr, "incr_render: error: image sizes do not match");
+    }
+
+    /* Find the edited objects */
+    before     = file_order(old, &num_before);
+    after      = file_order(model, &num_after);
+    num_change = num_before > num_after ? num_before : num_after;
+    changed    = (char *)Malloc(num_change + 1);
+    probes     = (obj_t **)Malloc((2 * num_change + 1) * sizeof(obj_t *));
+
+    for (i = 0; i < num_change; ++i) {
+        changed[i] = i >= num_before || i >= num_after ||
+                     !same_object(before[i], after[i]);
+
+        if (!changed[i]) {
+            continue;
+        }
+
+        ++edits;
+
+        /* Both versions of the object are probed, unless it is a light */
+        if (i < num_before && model_is_light(before[i]->objtype)) {
+            full = 1;
+        } else if (i < num_before) {
+            probes[num_probes++] = before[i];
+        }
+
+        if (i < num_after && model_is_light(after[i]->objtype)) {
+            full = 1;
+        } else if (i < num_after) {
+            probes[num_probes++] = after[i];
+        }
+    }
+
+    /* An edit may change the light baked anywhere on a plane */
+    if (model->opts->lightmap > 0 && edits > 0) {
+        full = 1;
+    }
+
+    pixmap = image_alloc(model, vals);
+
+    /* Order the scene objects by hit frequency */
+    if (model->opts->reorder) {
+        profile_hits(model);
+    }
+
+    /* Trace the affected pixels, recording the rays of every pixel */
+    model->deps = deps_init(model);
+
+    /* A different view, camera, sampling or shading changes every pixel */
+    if (!deps_match(prev, model->deps)) {
+        full = 1;
+    }
+
+    for (i = 0; i < height; ++i) {
+        for (j = 0; j < width; ++j) {
+            deps_pixel(model->deps);
+
+            if (full || affected(model, prev, i * width + j, changed,
+                                 num_change, probes, num_probes)) {
+                make_pixel(model, j, height - i,
+                           pixmap + (i * width + j) * PIXEL_SIZE);
+                ++traced;
+            } else {
+                memcpy(pixmap + (i * width + j) * PIXEL_SIZE,
+                       base   + (i * width + j) * PIXEL_SIZE, PIXEL_SIZE);
+                deps_copy(model->deps, prev, i * width + j);
+            }
+        }
+    }
+
+    /* Write the PPM image data to standard out */
+    write_ppm(pixmap, ID_COLOR, vals, stdout);
+    save_deps(model);
+
+    fprintf(stderr, "Re-traced %ld of %ld pixels (%d objects edited)\n",
+                    traced, (long)width * height, edits);
+
+    Free(pixmap);
+    Free(base);
+    Free(before);
+    Free(after);
+    Free(changed);
+    Free(probes);
+    deps_destroy(prev);
+    dalloc(old);
+}
@@ -0,0 +1,18 @@
+/*
+ * incr.h:  This header file contains the implementation specifications for
+ *          incremental rendering after a scene has been edited.
+ *
+ * Author:  Scott Gigawatt
+ *
+ * Version: 18 October 2026
+ */
+
+#ifndef INCR_H
+#define INCR_H
+
+#include "model.h"
+
+/* Re-renders the pixels that the scene edits could have changed */
+void incr_render(model_t *model);
+
+#endif
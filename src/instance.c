@@ -0,0 +1,582 @@
+/*
+ * instance.c: This file contains the implementation details for prototypes
+ *             and instances.  A prototype is a group of objects, which is
+ *             not drawn itself.  An instance draws the objects of a prototype
+ *             rotated, scaled, and moved, without copying them, so the memory
+ *             of a scene grows with its distinct objects rather than with the
+ *             number of times they are drawn.
+ *
+ *             Together they form a two level hierarchy.  Each prototype keeps
+ *             a bottom level bounding volume hierarchy over its objects, in
+ *             its own coordinates, and the model keeps the top level over its
+ *             instances (see model_accel).  A ray that reaches an instance is
+ *             taken into the coordinates of the prototype and traced through
+ *             the bottom level.  Since the scale is uniform and the rotation
+ *             keeps the ray direction a unit vector, distances along the ray
+ *             only need to be scaled.
+ *
+ *             The objects of a prototype are shared by its instances, so the
+ *             hit location and normal of the object last hit are kept in the
+ *             coordinates of the prototype, where its shaders expect them,
+ *             and those of the instance are kept in world coordinates.
+ *
+ * Author:     Scott Gigawatt
+ *
+ * Version:    18 October 2026
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "instance.h"
+#include "model.h"
+#include "plane.h"
+#include "mem.h"
+#include "veclib3d.h"
+
+/*
+ * proto_miss: The hits function of a prototype, which is never drawn.
+ *
+ * Parameters: base - Unused.
+ *             dir  - Unused.
+ *             tmin - Unused.
+ *             tmax - Unused.
+ *             obj  - Unused.
+ *
+ * Return:     MISS.
+ */
+static double proto_miss(double *base, double *dir, double tmin, double tmax,
+                         obj_t *obj) {
+    return MISS;
+}
+
+/*
+ * proto_build: Builds the bottom level hierarchy of a prototype, and hashes
+ *              the dump of its objects, which identifies it to instances.
+ *
+ * Parameters:  proto - The prototype.
+ */
+static void proto_build(proto_t *proto) {
+    obj_t  **objs  = NULL; /* The objects, as an array */
+    link_t *cursor = NULL; /* Cursor into the objects  */
+    char   *text   = NULL; /* The dump of the objects  */
+    size_t size    = 0;    /* The length of the dump   */
+    FILE   *out;           /* The dump stream          */
+    int    i       = 0;    /* Object index             */
+
+    objs = (obj_t **)Malloc((proto->count + 1) * sizeof(obj_t *));
+
+    for (cursor = proto->members->head; cursor; cursor = cursor->next) {
+        objs[i++] = (obj_t *)cursor->item;
+    }
+
+    bvh_destroy(proto->bvh);
+    proto->bvh = bvh_build(objs, proto->count);
+    Free(objs);
+
+    if ((out = open_memstream(&text, &size)) == NULL) {
+        msg_exit(stderr, "proto_build: error: cannot dump prototype");
+    }
+
+    objlist_dump(out, proto->members);
+    fclose(out);
+
+    proto->hash = hash_text(text, size);
+    free(text);
+}
+
+/*
+ * prototype_init: Allocates memory for, initializes, and returns a new
+ *                 prototype.  A prototype gives its number of objects, which
+ *                 follow it in the usual format.  Lights, prototypes, and
+ *                 instances cannot be members.  The members are numbered
+ *                 from 0 apart from the objects of the scene, so that the
+ *                 ids of the scene objects stay in file order.
+ *
+ * Parameters:     in      - The file containing the prototype.
+ *                 objtype - Represents the type of object to initialize.
+ *
+ * Return:         A pointer to the newly initialized prototype.
+ */
+obj_t *prototype_init(FILE *in, int objtype) {
+    obj_t   *obj = object_init(in, objtype);            /* The object    */
+    proto_t *new = (proto_t *)Malloc(sizeof(proto_t));  /* The prototype */
+    obj_t   *member;                                    /* A member      */
+    int     type;                                       /* Member type   */
+    int     next;                                       /* Next scene id */
+    int     i;                                          /* Member index  */
+
+    /* Link the prototype to the object structure */
+    obj->priv    = new;
+    obj->hits    = proto_miss;
+    obj->move    = prototype_move;
+    obj->destroy = prototype_destroy;
+    obj->dump    = prototype_dump;
+
+    new->members = list_init();
+    new->bvh     = NULL;
+
+    /* Read in the number of members and check for errors */
+    if (ivec_get1(in, &new->count) != 1 || new->count < 1) {
+        msg_exit(stderr, "prototype_init: error: invalid member count");
+    }
+
+    consume_line(in);
+
+    next = object_ids(0);
+
+    for (i = 0; i < new->count; ++i) {
+        if (ivec_get1(in, &type) != 1) {
+            msg_exit(stderr, "prototype_init: error: invalid read count");
+        }
+
+        consume_line(in);
+
+        if (model_is_light(type) || type == PROTOTYPE || type == INSTANCE) {
+            msg_exit(stderr, "prototype_init: error: invalid member type");
+        }
+
+        member = model_object(in, type);
+        list_add(new->members, member);
+
+        /* Planes are clipped at the screen in world coordinates only */
+        if (type == PLANE || type == FINITE_PLANE || type == TILED_PLANE ||
+            type == P_PLANE) {
+            plane_unclip(member);
+        }
+    }
+
+    object_ids(next);
+    proto_build(new);
+
+    return obj;
+}
+
+/*
+ * prototype_dump: Dumps the contents of the prototype object to the
+ *                 specified output file.
+ *
+ * Parameters:     out - The file to which the prototype will be dumped.
+ *                 obj - The prototype object to dump.
+ *
+ * Return:         EXIT_SUCCESS if successful, EXIT_FAILURE otherwise.
+ */
+int prototype_dump(FILE *out, obj_t *obj) {
+    proto_t *proto = (proto_t *)obj->priv; /* The prototype to dump */
+
+    fprintf(out, "Dumping object of type Prototype\n");
+
+    /* Print out the member information */
+    ivec_prn1(out, "members - ", &proto->count);
+    objlist_dump(out, proto->members);
+    fprintf(out, "End of Prototype\n");
+
+    return EXIT_SUCCESS;
+}
+
+/*
+ * prototype_move: Translates every object of the specified prototype by an
+ *                 offset, moving all of its instances.
+ *
+ * Parameters:     obj    - The prototype object to move.
+ *                 offset - The translation (x, y, z).
+ */
+void prototype_move(obj_t *obj, double *offset) {
+    proto_t *proto  = (proto_t *)obj->priv; /* The prototype to move   */
+    link_t  *cursor = NULL;                 /* Cursor into the members */
+    obj_t   *member = NULL;                 /* The current member      */
+
+    for (cursor = proto->members->head; cursor; cursor = cursor->next) {
+        member = (obj_t *)cursor->item;
+        member->move(member, offset);
+    }
+
+    /* The instances are bounded again by model_accel */
+    proto_build(proto);
+}
+
+/*
+ * prototype_destroy: Destroys the specified prototype object and its
+ *                    members.
+ *
+ * Parameters:        obj - The prototype object to destroy.
+ */
+void prototype_destroy(obj_t *obj) {
+    proto_t *proto  = (proto_t *)obj->priv; /* The prototype to destroy */
+    link_t  *cursor = NULL;                 /* Cursor into the members  */
+    obj_t   *member = NULL;                 /* The current member       */
+
+    for (cursor = proto->members->head; cursor; cursor = cursor->next) {
+        member = (obj_t *)cursor->item;
+        member->destroy(member);
+    }
+
+    list_del(proto->members);
+    bvh_destroy(proto->bvh);
+    Free(proto);
+}
+
+/*
+ * instance_getamb: Gets the ambient light information of the object of the
+ *                  prototype last hit through the instance.
+ *
+ * Parameters:      obj     - The instance.
+ *                  ambient - Storage for the ambient light information.
+ */
+static void instance_getamb(obj_t *obj, double *ambient) {
+    obj_t *hit = ((instance_t *)obj->priv)->hit; /* The object hit */
+
+    hit->getamb(hit, ambient);
+}
+
+/*
+ * instance_getdiff: Gets the diffuse light information of the object of the
+ *                   prototype last hit through the instance.
+ *
+ * Parameters:       obj     - The instance.
+ *                   diffuse - Storage for the diffuse light information.
+ */
+static void instance_getdiff(obj_t *obj, double *diffuse) {
+    obj_t *hit = ((instance_t *)obj->priv)->hit; /* The object hit */
+
+    hit->getdiff(hit, diffuse);
+}
+
+/*
+ * instance_getspec: Gets the specular light information of the object of
+ *                   the prototype last hit through the instance.
+ *
+ * Parameters:       obj      - The instance.
+ *                   specular - Storage for the specular light information.
+ */
+static void instance_getspec(obj_t *obj, double *specular) {
+    obj_t *hit = ((instance_t *)obj->priv)->hit; /* The object hit */
+
+    hit->getspec(hit, specular);
+}
+
+/*
+ * instance_gettrans: Gets the transmission information of the object of
+ *                    the prototype last hit through the instance.
+ *
+ * Parameters:        obj          - The instance.
+ *                    transmission - Storage for the transmission information.
+ *
+ * Return:            The index of refraction of the object, or 0 if opaque.
+ */
+static double instance_gettrans(obj_t *obj, double *transmission) {
+    obj_t *hit = ((instance_t *)obj->priv)->hit; /* The object hit */
+
+    return hit->gettrans(hit, transmission);
+}
+
+/*
+ * instance_init: Allocates memory for, initializes, and returns a new
+ *                instance.  An instance gives the number of its prototype,
+ *                counting from 0 in file order, the translation, the
+ *                rotation in degrees about the x, y, and z axes (applied in
+ *                that order), and the scale.  The prototype is bound by
+ *                instance_bind once the scene has been read.
+ *
+ * Parameters:    in      - The file containing the instance.
+ *                objtype - Represents the type of object to initialize.
+ *
+ * Return:        A pointer to the newly initialized instance.
+ */
+obj_t *instance_init(FILE *in, int objtype) {
+    obj_t      *obj = object_init(in, objtype);                /* The object */
+    instance_t *new = (instance_t *)Malloc(sizeof(instance_t)); /* Instance  */
+    double     rot[VEC_SIZE][VEC_SIZE];                        /* Rotation   */
+    double     rad;                                            /* An angle   */
+    int        i;                                              /* Axis index */
+
+    /* Link the instance to the object structure */
+    obj->priv     = new;
+    obj->hits     = hits_instance;
+    obj->rehits   = rehits_instance;
+    obj->surface  = instance_surface;
+    obj->bounds   = instance_bounds;
+    obj->getamb   = instance_getamb;
+    obj->getdiff  = instance_getdiff;
+    obj->getspec  = instance_getspec;
+    obj->gettrans = instance_gettrans;
+    obj->move     = instance_move;
+    obj->destroy  = instance_destroy;
+    obj->dump     = instance_dump;
+
+    new->proto = NULL;
+    new->cand  = NULL;
+    new->hit   = NULL;
+
+    /* Read in the prototype number and check for errors */
+    if (ivec_get1(in, &new->index) != 1 || new->index < 0) {
+        msg_exit(stderr, "instance_init: error: invalid prototype number");
+    }
+
+    consume_line(in);
+
+    /* Read in the translation and rotation and check for errors */
+    if (vec_get3(in, new->offset) != VEC_SIZE) {
+        msg_exit(stderr, "instance_init: error: invalid read count");
+    }
+
+    consume_line(in);
+
+    if (vec_get3(in, new->angles) != VEC_SIZE) {
+        msg_exit(stderr, "instance_init: error: invalid read count");
+    }
+
+    consume_line(in);
+
+    /* Read in the scale and check for errors */
+    if (vec_get1(in, &new->scale) != 1 || new->scale <= 0.0) {
+        msg_exit(stderr, "instance_init: error: invalid scale");
+    }
+
+    consume_line(in);
+
+    /* Compute the rotation matrix, about x first */
+    mat_id3(new->rotmat);
+
+    for (i = 0; i < VEC_SIZE; ++i) {
+        rad = new->angles[i] * M_PI / 180.0;
+
+        mat_id3(rot);
+        rot[(i + 1) % VEC_SIZE][(i + 1) % VEC_SIZE] =  cos(rad);
+        rot[(i + 1) % VEC_SIZE][(i + 2) % VEC_SIZE] = -sin(rad);
+        rot[(i + 2) % VEC_SIZE][(i + 1) % VEC_SIZE] =  sin(rad);
+        rot[(i + 2) % VEC_SIZE][(i + 2) % VEC_SIZE] =  cos(rad);
+        mat_mul3(rot, new->rotmat, new->rotmat);
+    }
+
+    mat_xpose3(new->rotmat, new->invmat);
+
+    return obj;
+}
+
+/*
+ * instance_bind: Binds an instance to the prototype it names.
+ *
+ * Parameters:    obj    - The instance object.
+ *                protos - The prototypes of the scene, in file order.
+ *                count  - The number of prototypes.
+ *
+ * Return:        Zero if successful, nonzero if there is no such prototype.
+ */
+int instance_bind(obj_t *obj, obj_t **protos, int count) {
+    instance_t *inst = (instance_t *)obj->priv; /* The instance */
+
+    if (inst->index >= count) {
+        return 1;
+    }
+
+    inst->proto = (proto_t *)protos[inst->index]->priv;
+
+    return 0;
+}
+
+/*
+ * instance_dump: Dumps the contents of the instance object to the specified
+ *                output file.  The hash of its prototype is included, so
+ *                that editing a prototype changes the dump of every instance
+ *                of it.
+ *
+ * Parameters:    out - The file to which the instance will be dumped.
+ *                obj - The instance object to dump.
+ *
+ * Return:        EXIT_SUCCESS if successful, EXIT_FAILURE otherwise.
+ */
+int instance_dump(FILE *out, obj_t *obj) {
+    instance_t *inst = (instance_t *)obj->priv; /* The instance to dump */
+
+    fprintf(out, "Dumping object of type Instance\n");
+
+    /* Print out the instance information */
+    ivec_prn1(out, "prototype - ", &inst->index);
+
+    if (inst->proto) {
+        fprintf(out, "prototype hash - \n%016lx\n", inst->proto->hash);
+    }
+
+    vec_prn3(out, "offset - ", inst->offset);
+    vec_prn3(out, "angles - ", inst->angles);
+    vec_prn1(out, "scale - ",  &inst->scale);
+
+    return EXIT_SUCCESS;
+}
+
+/*
+ * to_local:   Takes a ray into the coordinates of the prototype of an
+ *             instance.
+ *
+ * Parameters: inst  - The instance.
+ *             base  - The base location of the ray.
+ *             dir   - The unit vector direction of the ray.
+ *             lbase - Storage for the base location in the prototype.
+ *             ldir  - Storage for the unit direction in the prototype.
+ */
+static void to_local(instance_t *inst, double *base, double *dir,
+                     double *lbase, double *ldir) {
+    vec_diff3(inst->offset, base, lbase);
+    mat_xform3(inst->invmat, lbase, lbase);
+    vec_scale3(1.0 / inst->scale, lbase, lbase);
+    mat_xform3(inst->invmat, dir, ldir);
+}
+
+/*
+ * trace_local: Traces a ray through the bottom level hierarchy of the
+ *              prototype of an instance.
+ *
+ * Parameters:  base - The base location of the ray.
+ *              dir  - The unit vector direction of the ray.
+ *              tmin - Hits at or before this distance are misses.
+ *              tmax - Hits at or beyond this distance are misses.
+ *              obj  - The instance object to test.
+ *              skip - The object of the prototype the ray leaves, or NULL.
+ *
+ * Return:      The distance to the hit location, or MISS.
+ */
+static double trace_local(double *base, double *dir, double tmin,
+                          double tmax, obj_t *obj, obj_t *skip) {
+    instance_t *inst = (instance_t *)obj->priv; /* The instance       */
+    double     lbase[VEC_SIZE];                 /* The local base     */
+    double     ldir[VEC_SIZE];                  /* The local dir      */
+    double     ltmax = tmax / inst->scale;      /* The local tmax     */
+
+    to_local(inst, base, dir, lbase, ldir);
+
+    /* Keep the object hit, for instance_surface */
+    inst->cand = bvh_hits(inst->proto->bvh, lbase, ldir, tmin / inst->scale,
+                          &ltmax, skip, 0);
+
+    return inst->cand ? ltmax * inst->scale : MISS;
+}
+
+/*
+ * hits_instance: Determines if a ray hits an instance object, returning the
+ *                distance to the closest object of its prototype.
+ *
+ * Parameters:    base - The base location of the ray.
+ *                dir  - The unit vector direction of the ray.
+ *                tmin - Hits at or before this distance are misses.
+ *                tmax - Hits at or beyond this distance are misses.
+ *                obj  - The instance object to test.
+ *
+ * Return:        The distance to the hit location, or MISS.
+ */
+double hits_instance(double *base, double *dir, double tmin, double tmax,
+                     obj_t *obj) {
+    return trace_local(base, dir, tmin, tmax, obj, NULL);
+}
+
+/*
+ * rehits_instance: Determines if a ray leaving an instance object hits one
+ *                  of its other objects, such as a shadow ray from one
+ *                  sphere of a cluster blocked by another.
+ *
+ * Parameters:      base - The base location of the ray.
+ *                  dir  - The unit vector direction of the ray.
+ *                  tmin - Hits at or before this distance are misses.
+ *                  tmax - Hits at or beyond this distance are misses.
+ *                  obj  - The instance object the ray leaves.
+ *
+ * Return:          The distance to the hit location, or MISS.
+ */
+double rehits_instance(double *base, double *dir, double tmin, double tmax,
+                       obj_t *obj) {
+    return trace_local(base, dir, tmin, tmax, obj,
+                       ((instance_t *)obj->priv)->hit);
+}
+
+/*
+ * instance_surface: Computes the hit location and normal of a ray that hit
+ *                   an instance object, from those of the object of its
+ *                   prototype that was hit.
+ *
+ * Parameters:       base - The base location of the ray.
+ *                   dir  - The unit vector direction of the ray.
+ *                   dist - The distance returned by hits_instance.
+ *                   obj  - The instance object that was hit.
+ */
+void instance_surface(double *base, double *dir, double dist, obj_t *obj) {
+    instance_t *inst = (instance_t *)obj->priv; /* The instance   */
+    double     lbase[VEC_SIZE];                 /* The local base */
+    double     ldir[VEC_SIZE];                  /* The local dir  */
+
+    inst->hit = inst->cand;
+
+    /* Compute the hit in the coordinates of the prototype */
+    to_local(inst, base, dir, lbase, ldir);
+    inst->hit->surface(lbase, ldir, dist / inst->scale, inst->hit);
+
+    /* Save the hit location and normal in world coordinates */
+    vec_scale3(dist, dir, obj->hitloc);
+    vec_sum3(base, obj->hitloc, obj->hitloc);
+    mat_xform3(inst->rotmat, inst->hit->normal, obj->normal);
+}
+
+/*
+ * instance_bounds: Finds the bounding box of an instance object, around
+ *                  the transformed corners of the box of its prototype.
+ *
+ * Parameters:      obj - The instance object.
+ *                  lo  - Storage for the low corner of the box.
+ *                  hi  - Storage for the high corner of the box.
+ *
+ * Return:          Nonzero if the prototype is bounded, zero otherwise.
+ */
+int instance_bounds(obj_t *obj, double *lo, double *hi) {
+    instance_t *inst = (instance_t *)obj->priv; /* The instance        */
+    double     box[2][VEC_SIZE];                /* The prototype box   */
+    double     corner[VEC_SIZE];                /* A corner of the box */
+    int        c;                               /* Corner index        */
+    int        j;                               /* Axis index          */
+
+    if (!bvh_bounds(inst->proto->bvh, box[0], box[1])) {
+        return 0;
+    }
+
+    for (j = 0; j < VEC_SIZE; ++j) {
+        lo[j] = HUGE_VAL;
+        hi[j] = -HUGE_VAL;
+    }
+
+    for (c = 0; c < 8; ++c) {
+        for (j = 0; j < VEC_SIZE; ++j) {
+            corner[j] = box[(c >> j) & 1][j];
+        }
+
+        mat_xform3(inst->rotmat, corner, corner);
+        vec_scale3(inst->scale, corner, corner);
+        vec_sum3(inst->offset, corner, corner);
+
+        for (j = 0; j < VEC_SIZE; ++j) {
+            lo[j] = fmin(lo[j], corner[j]);
+            hi[j] = fmax(hi[j], corner[j]);
+        }
+    }
+
+    return 1;
+}
+
+/*
+ * instance_move: Translates the specified instance object by an offset.
+ *
+ * Parameters:    obj    - The instance object to move.
+ *                offset - The translation (x, y, z).
+ */
+void instance_move(obj_t *obj, double *offset) {
+    instance_t *inst = (instance_t *)obj->priv; /* The instance to move */
+
+    vec_sum3(inst->offset, offset, inst->offset);
+}
+
+/*
+ * instance_destroy: Destroys the specified instance object, but not its
+ *                   prototype.
+ *
+ * Parameters:       obj - The instance object to destroy.
+ */
+void instance_destroy(obj_t *obj) {
+    Free(obj->priv);
+}
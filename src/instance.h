@@ -0,0 +1,80 @@
+/*
+ * instance.h: This header file contains the implementation specifications
+ *             for prototypes, which are groups of objects, and instances,
+ *             which place a prototype in the scene with a transform.
+ *
+ * Author:     Scott Gigawatt
+ *
+ * Version:    18 October 2026
+ */
+
+#ifndef INSTANCE_H
+#define INSTANCE_H
+
+#include "object.h"
+#include "bvh.h"
+#include "list.h"
+
+/* Prototype */
+typedef struct proto_type {
+    list_t        *members; /* The objects of the prototype            */
+    int           count;    /* The number of objects                   */
+    bvh_t         *bvh;     /* The bottom level hierarchy over them    */
+    unsigned long hash;     /* The hash of the dump of the objects     */
+} proto_t;
+
+/* Instance of a prototype */
+typedef struct instance_type {
+    int     index;                      /* The prototype number (from 0) */
+    proto_t *proto;                     /* The prototype, once bound     */
+    double  offset[VEC_SIZE];           /* The translation (x, y, z)     */
+    double  angles[VEC_SIZE];           /* Rotation about x, y, z (deg)  */
+    double  scale;                      /* The uniform scale             */
+    double  rotmat[VEC_SIZE][VEC_SIZE]; /* World from prototype rotation */
+    double  invmat[VEC_SIZE][VEC_SIZE]; /* Prototype from world rotation */
+    obj_t   *cand;                      /* Object hit by the last test   */
+    obj_t   *hit;                       /* Object of the closest hit     */
+} instance_t;
+
+/* Allocates memory for, initializes, and returns a new prototype */
+obj_t *prototype_init(FILE *in, int objtype);
+
+/* Dumps the contents of the prototype object to the specified file */
+int prototype_dump(FILE *out, obj_t *obj);
+
+/* Translates every object of the specified prototype by an offset */
+void prototype_move(obj_t *obj, double *offset);
+
+/* Destroys the specified prototype object and its objects */
+void prototype_destroy(obj_t *obj);
+
+/* Allocates memory for, initializes, and returns a new instance */
+obj_t *instance_init(FILE *in, int objtype);
+
+/* Binds an instance to the prototype it names */
+int instance_bind(obj_t *obj, obj_t **protos, int count);
+
+/* Dumps the contents of the instance object to the specified file */
+int instance_dump(FILE *out, obj_t *obj);
+
+/* Determines if a ray hits an instance object */
+double hits_instance(double *base, double *dir, double tmin, double tmax,
+                     obj_t *obj);
+
+/* Determines if a ray leaving an instance hits it again */
+double rehits_instance(double *base, double *dir, double tmin, double tmax,
+                       obj_t *obj);
+
+/* Computes the hit location and normal of a ray that hit an instance */
+void instance_surface(double *base, double *dir, double dist, obj_t *obj);
+
+/* Finds the bounding box of an instance object */
+int instance_bounds(obj_t *obj, double *lo, double *hi);
+
+/* Translates the specified instance object by an offset */
+void instance_move(obj_t *obj, double *offset);
+
+/* Destroys the specified instance object */
+void instance_destroy(obj_t *obj);
+
+#endif
@@ -0,0 +1,311 @@
+/*
+ * libraytrace.c: This file contains the implementation details for using
+ *                the ray tracer as a library.  The renderer reports errors
+ *                through msg_exit, so each call sets a msg_trap, which turns
+ *                an error anywhere below it into a return from the call.
+ *                The model being loaded when an error is caught is destroyed;
+ *                objects that rt_add read before an error are kept.  If the
+ *                model cannot be rebuilt around them, it can only be freed.
+ *
+ *                Pixels are traced exactly as by render_image, so an image
+ *                rendered through the library is identical to the image the
+ *                command line program writes.
+ *
+ * Author:        Scott Gigawatt
+ *
+ * Version:       18 October 2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "libraytrace.h"
+#include "image.h"
+#include "mem.h"
+
+/* The message of the last error */
+static char rt_message[MSG_SIZE] = "";
+
+/*
+ * fail:       Records the message of an error detected by the library.
+ *
+ * Parameters: code - The error code.
+ *             msg  - The error message.
+ *
+ * Return:     The error code.
+ */
+static int fail(int code, char *msg) {
+    snprintf(rt_message, MSG_SIZE, "%s", msg);
+
+    return code;
+}
+
+/*
+ * rt_load:    Loads a model from scene text in the input file format.  The
+ *             model has the default rendering options, which the caller may
+ *             change through model->opts before rendering.
+ *
+ * Parameters: scene  - The scene text.
+ *             size   - The length of the scene text.
+ *             width  - The image width in pixels.
+ *             height - The image height in pixels.
+ *             model  - Set to the new model, to be destroyed by rt_free.
+ *
+ * Return:     RT_OK if successful, an error code otherwise.
+ */
+int rt_load(const char *scene, size_t size, int width, int height,
+            model_t **model) {
+    model_t *volatile new = NULL; /* The new model  */
+    FILE    *volatile in  = NULL; /* The scene text */
+    jmp_buf env;                  /* The error trap */
+
+    if (scene == NULL || size == 0 || model == NULL || width < 2 ||
+        height < 2) {
+        return fail(RT_EINVAL, "rt_load: error: invalid argument");
+    }
+
+    if (setjmp(env)) {
+        if (in) {
+            fclose(in);
+        }
+
+        /* The object being read is not yet in the model */
+        object_abandon();
+
+        if (new) {
+            dalloc(new);
+        }
+
+        return fail(RT_ESCENE, (char *)msg_last());
+    }
+
+    msg_trap(&env);
+
+    if ((in = fmemopen((char *)scene, size, "r")) == NULL) {
+        msg_exit(stderr, "rt_load: error: cannot open scene text");
+    }
+
+    /* Set up an empty model, so that dalloc can destroy it at any point */
+    new = (model_t *)Malloc(sizeof(model_t));
+    memset(new, 0, sizeof(model_t));
+    new->lights = list_init();
+    new->scene  = list_init();
+    new->opts   = (opts_t *)Malloc(sizeof(opts_t));
+    memset(new->opts, 0, sizeof(opts_t));
+    new->opts->output  = DEF_OUTPUT;
+    new->opts->samples = AA_SAMPLES;
+    new->opts->up[1]   = 1.0;
+
+    new->proj = projection_read(in, width, height);
+    model_init(in, new);
+
+    fclose(in);
+    msg_trap(NULL);
+    *model = new;
+
+    return RT_OK;
+}
+
+/*
+ * rt_add:     Adds the objects and lights in the specified text, in the
+ *             input file format, to a model.
+ *
+ * Parameters: model   - The model.
+ *             objects - The object text.
+ *             size    - The length of the object text.
+ *
+ * Return:     RT_OK if successful, an error code otherwise.
+ */
+int rt_add(model_t *model, const char *objects, size_t size) {
+    FILE    *volatile in = NULL; /* The object text          */
+    jmp_buf env;                 /* The error trap           */
+    jmp_buf again;               /* The trap for the rebuild */
+
+    if (model == NULL || objects == NULL || size == 0) {
+        return fail(RT_EINVAL, "rt_add: error: invalid argument");
+    }
+
+    if (setjmp(env)) {
+        if (in) {
+            fclose(in);
+        }
+
+        /* The object being read is not yet in the model */
+        object_abandon();
+
+        /* Traverse the objects that were read before the error */
+        Free(model->objs);
+        model->objs     = NULL;
+        model->num_objs = 0;
+
+        if (setjmp(again)) {
+            /* Leave the model for rt_free alone */
+            Free(model->objs);
+            model->objs     = NULL;
+            model->num_objs = 0;
+
+            return fail(RT_ERENDER, (char *)msg_last());
+        }
+
+        msg_trap(&again);
+        model_flatten(model);
+        msg_trap(NULL);
+
+        return fail(RT_ESCENE, (char *)msg_last());
+    }
+
+    msg_trap(&env);
+
+    if ((in = fmemopen((char *)objects, size, "r")) == NULL) {
+        msg_exit(stderr, "rt_add: error: cannot open object text");
+    }
+
+    /* The traversal array is rebuilt with the new objects */
+    Free(model->objs);
+    model->objs = NULL;
+    model_init(in, model);
+
+    fclose(in);
+    msg_trap(NULL);
+
+    return RT_OK;
+}
+
+/*
+ * rt_size:    Finds the size of the image rendered from a model, which is
+ *             the size of its crop rectangle unless the full frame was
+ *             requested.
+ *
+ * Parameters: model  - The model.
+ *             width  - Set to the image width in pixels.
+ *             height - Set to the image height in pixels.
+ *
+ * Return:     RT_OK if successful, an error code otherwise.
+ */
+int rt_size(model_t *model, int *width, int *height) {
+    int     vals[VEC_SIZE]; /* The image size */
+    jmp_buf env;            /* The error trap */
+
+    if (model == NULL || width == NULL || height == NULL) {
+        return fail(RT_EINVAL, "rt_size: error: invalid argument");
+    }
+
+    if (setjmp(env)) {
+        return fail(RT_EINVAL, (char *)msg_last());
+    }
+
+    msg_trap(&env);
+    image_size(model, vals);
+    msg_trap(NULL);
+
+    *width  = vals[0];
+    *height = vals[1];
+
+    return RT_OK;
+}
+
+/*
+ * rt_render:  Renders the image of a model into a caller-owned buffer, one
+ *             pixel at a time, without an intermediate image.  Pixels of a
+ *             full frame outside of the crop rectangle are left untouched.
+ *
+ * Parameters: model - The model.
+ *             image - The buffer, whose size must match rt_size.
+ *
+ * Return:     RT_OK if successful, an error code otherwise.
+ */
+int rt_render(model_t *model, rt_image_t *image) {
+    unsigned char *pix;               /* The caller's pixel           */
+    unsigned char rgb[PIXEL_SIZE];    /* A traced pixel               */
+    int           vals[VEC_SIZE];     /* The image size               */
+    int           region[CROP_SIZE];  /* The traced pixels            */
+    int           origin[2];          /* The image position of (0, 0) */
+    int           height;             /* The projection height        */
+    int           bpp;                /* The bytes per pixel          */
+    int           i;                  /* Counter variable             */
+    int           j;                  /* Counter variable             */
+    jmp_buf       env;                /* The error trap               */
+
+    if (model == NULL || image == NULL || image->pixels == NULL ||
+        image->format < RT_RGB || image->format > RT_BGRA) {
+        return fail(RT_EINVAL, "rt_render: error: invalid argument");
+    }
+
+    if (model->objs == NULL) {
+        return fail(RT_EINVAL, "rt_render: error: the model could not be "
+                               "rebuilt after an error");
+    }
+
+    if (rt_size(model, &vals[0], &vals[1])) {
+        return RT_EINVAL;
+    }
+
+    bpp = image->format == RT_RGB ? PIXEL_SIZE : PIXEL_SIZE + 1;
+
+    if (image->width != vals[0] || image->height != vals[1] ||
+        image->stride < (size_t)vals[0] * bpp) {
+        return fail(RT_EINVAL, "rt_render: error: buffer does not match "
+                               "the image size");
+    }
+
+    if (setjmp(env)) {
+        return fail(RT_ERENDER, (char *)msg_last());
+    }
+
+    msg_trap(&env);
+
+    projection_camera(model->proj, model->opts);
+    image_region(model, region);
+    height    = model->proj->win_size_pixel[1];
+    origin[0] = model->opts->full ? 0 : region[0];
+    origin[1] = model->opts->full ? 0 : region[1];
+
+    /* Order the scene objects by hit frequency */
+    if (model->opts->reorder) {
+        profile_hits(model);
+    }
+
+    for (i = region[1]; i < region[3]; ++i) {
+        pix = image->pixels + (i - origin[1]) * image->stride +
+                              (region[0] - origin[0]) * bpp;
+
+        for (j = region[0]; j < region[2]; ++j, pix += bpp) {
+            /* Trace each pixel exactly as render_image would */
+            if (image->format == RT_RGB) {
+                make_pixel(model, j, height - i, pix);
+                continue;
+            }
+
+            make_pixel(model, j, height - i, rgb);
+
+            pix[0] = image->format == RT_RGBA ? rgb[0] : rgb[2];
+            pix[1] = rgb[1];
+            pix[2] = image->format == RT_RGBA ? rgb[2] : rgb[0];
+            pix[3] = MAX_COLOR;
+        }
+    }
+
+    msg_trap(NULL);
+
+    return RT_OK;
+}
+
+/*
+ * rt_free:    Destroys a model returned by rt_load, with its options.
+ *
+ * Parameters: model - The model, or NULL.
+ */
+void rt_free(model_t *model) {
+    if (model) {
+        dalloc(model);
+    }
+}
+
+/*
+ * rt_error:   Returns the message of the last error.
+ *
+ * Return:     The error message, or an empty string.
+ */
+const char *rt_error(void) {
+    return rt_message;
+}
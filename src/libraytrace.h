@@ -0,0 +1,63 @@
+/*
+ * libraytrace.h: This header file contains the interface for embedding the
+ *                ray tracer as a library.  A model is loaded from scene text
+ *                held in memory, objects may be added to it, and its image is
+ *                rendered straight into a buffer owned by the caller.  Every
+ *                function returns an error code instead of exiting, with the
+ *                message available from rt_error.
+ *
+ *                The library keeps no state between calls other than the
+ *                last error message, and is not thread safe: call it from
+ *                one thread at a time, or from separate processes.
+ *
+ * Author:        Scott Gigawatt
+ *
+ * Version:       18 October 2026
+ */
+
+#ifndef LIBRAYTRACE_H
+#define LIBRAYTRACE_H
+
+#include <stddef.h>
+#include "model.h"
+
+/* Error codes */
+#define RT_OK      0 /* The call succeeded               */
+#define RT_EINVAL  1 /* An argument is invalid           */
+#define RT_ESCENE  2 /* The scene text could not be read */
+#define RT_ERENDER 3 /* The image could not be rendered  */
+
+/* Pixel formats */
+#define RT_RGB  0 /* 3 bytes per pixel: red, green, blue      */
+#define RT_RGBA 1 /* 4 bytes per pixel: red, green, blue, 255 */
+#define RT_BGRA 2 /* 4 bytes per pixel: blue, green, red, 255 */
+
+/* A caller-owned image buffer */
+typedef struct rt_image_type {
+    unsigned char *pixels; /* The top left pixel                 */
+    int           width;   /* The width in pixels (see rt_size)  */
+    int           height;  /* The height in pixels               */
+    size_t        stride;  /* The bytes from one row to the next */
+    int           format;  /* The pixel format (RT_RGB, ...)     */
+} rt_image_t;
+
+/* Loads a model from scene text, in the input file format */
+int rt_load(const char *scene, size_t size, int width, int height,
+            model_t **model);
+
+/* Adds the objects and lights in the specified text to a model */
+int rt_add(model_t *model, const char *objects, size_t size);
+
+/* Finds the width and height of the image rendered from a model */
+int rt_size(model_t *model, int *width, int *height);
+
+/* Renders the image of a model into a caller-owned buffer */
+int rt_render(model_t *model, rt_image_t *image);
+
+/* Destroys a model returned by rt_load */
+void rt_free(model_t *model);
+
+/* Returns the message of the last error */
+const char *rt_error(void);
+
+#endif
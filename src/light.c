@@ -9,9 +9,19 @@
 
 #include <math.h>
 #include "light.h"
+#include "lighttree.h"
+#include "lightmap.h"
 #include "mem.h"
 #include "raytrace.h"
 
+/* The direction, distance, and falloff of a block of lights from a point */
+typedef struct light_block_type {
+    double dir[VEC_SIZE][LIGHT_BLOCK]; /* Unit directions, by axis  */
+    double dist[LIGHT_BLOCK];          /* Distances to the lights   */
+    double cos[LIGHT_BLOCK];           /* Cosines with the normal   */
+    double falloff[LIGHT_BLOCK];       /* Cosines over distances    */
+} light_block_t;
+
 /*
  * light_init: Initializes and returns a new diffuse light source object.
  *
@@ -29,6 +39,14 @@ obj_t *light_init(FILE *in, int objtype) {
     obj->priv    = new;
     obj->destroy = light_destroy;
     obj->dump    = light_dump;
+    obj->move    = light_move;
+    new->priv    = NULL;
+    new->culled  = 0;
+    new->samples = 1;
+    new->radius  = 0.0;
+    new->spread  = NULL;
+    new->reaches = NULL;
+    new->sample  = NULL;
 
     /* Get the light emissivity information and check for errors */
     if (( rc = vec_get3(in, obj->emissivity) ) != VEC_SIZE) {
@@ -102,6 +120,21 @@ void default_getspec(obj_t *obj, double *specular) {
     vec_scale3(1.0, obj->material.specular, specular);
 }
 
+/*
+ * default_gettrans: Gets the transmission information from the specified
+ *                   object, which lets no light through.
+ *
+ * Parameters:       obj          - The object.
+ *                   transmission - Storage for the transmission information.
+ *
+ * Return:           Zero, since the object is opaque.
+ */
+double default_gettrans(obj_t *obj, double *transmission) {
+    vec_scale3(0.0, transmission, transmission);
+
+    return 0.0;
+}
+
 /* 
  * default_getemiss: Gets the light emissivity information from the specified 
  *                   object.
@@ -114,65 +147,104 @@ void default_getemiss(obj_t *obj, double *emissivity) {
     vec_scale3(1.0, obj->emissivity, emissivity);
 }
 
-/* 
- * diffuse_illumination: Gets the diffuse light information from the specified 
- *                       object.
+/*
+ * sample_lights: Gets the diffuse light information from a few lights
+ *                picked from the light tree (see lighttree.c), one shadow
+ *                ray's worth each, weighted by one over the chance of the
+ *                pick so that on average every light is counted in full.
+ *                The picks are spread evenly through the tree by a random
+ *                shift that is the same for the same point, and a light
+ *                picked again in a row is not processed again.
  *
- * Parameters: model  - A pointer to the world model containing the lights.
- *             hitobj - The object that was hit by the ray.
- *             ivec   - The (r, g, b) intensity vector.
+ * Parameters:    model   - A pointer to the world model.
+ *                hitobj  - The object that was hit by the ray.
+ *                primary - Nonzero if the ray came from the view point.
+ *                count   - The number of lights to pick.
+ *                ivec    - The (r, g, b) intensity vector.
  */
-void diffuse_illumination(model_t *model, obj_t *hitobj, double *ivec) {
-    link_t *cursor = NULL; /* Cursor into the list of lights */
+static void sample_lights(model_t *model, obj_t *hitobj, int primary,
+                          int count, double *ivec) {
+    lighttree_t  *tree = model->ltree;   /* The light tree           */
+    obj_t        *light;                 /* The light object         */
+    double       part[VEC_SIZE] = {0};   /* Light from the last pick */
+    double       prob;                   /* Chance of the pick       */
+    double       shift;                  /* Random shift of picks    */
+    unsigned int seed;                   /* Random state             */
+    int          last = MISS;            /* The last light picked    */
+    int          pick;                   /* The light picked         */
+    int          i;                      /* Pick index               */
+    int          j;                      /* Counter                  */
 
-    /* Iterate over the scene objects */
-    for (cursor = model->lights->head; cursor; cursor = cursor->next) {
-        /* Process the light object */
-        process_light(model->scene, hitobj, (obj_t *)cursor->item, ivec);
+    seed  = (unsigned int)hash_text((char *)hitobj->hitloc,
+                                    sizeof(hitobj->hitloc));
+    shift = (double)rand_r(&seed) / ((double)RAND_MAX + 1.0);
+
+    for (i = 0; i < count; ++i) {
+        pick = lighttree_pick(tree, hitobj->hitloc, hitobj->normal,
+                              (i + shift) / count, &prob);
+
+        if (pick == MISS) {
+            continue;
+        }
+
+        if (pick != last) {
+            light = tree->lights[pick];
+            last  = pick;
+            vec_scale3(0.0, part, part);
+
+            if (!(primary && ((light_t *)light->priv)->culled)) {
+                process_light(model, hitobj, light, part);
+            }
+        }
+
+        for (j = 0; j < VEC_SIZE; ++j) {
+            ivec[j] += part[j] / (count * prob);
+        }
     }
 }
 
-
-/* 
- * process_light: Processes the diffuse lighting information for the specified
- *                object.
+/*
+ * shade_point: Adds the diffuse light from a point light in front of the
+ *              surface, unless it is in shadow.  Points the light does not
+ *              shine toward, such as those outside the cone of a spotlight,
+ *              are rejected before the shadow ray is cast.
  *
- * Parameters:    lst      - The objects in the world scene.
- *                hitobj   - The object that was hit by the ray.
- *                lightobj - The current light source.
- *                ivec     - The (r, g, b) intensity vector.
+ * Parameters:  model    - A pointer to the world model.
+ *              hitobj   - The object that was hit by the ray.
+ *              lightobj - The light.
+ *              dir      - The unit direction to the light (x, y, z).
+ *              dist     - The distance to the light.
+ *              falloff  - The cosine with the normal over the distance.
+ *              diffuse  - The diffuse reflectivity of the object (r, g, b).
+ *              ivec     - The (r, g, b) intensity vector.
  *
- * Return:        EXIT_SUCCESS if no errors were encountered, failure otherwise.
+ * Return:      EXIT_SUCCESS if the light reached the object, MISS otherwise.
  */
-int process_light(list_t *lst, obj_t *hitobj, obj_t *lightobj, double *ivec) {
+static int shade_point(model_t *model, obj_t *hitobj, obj_t *lightobj,
+                       double *dir, double dist, double falloff,
+                       double *diffuse, double *ivec) {
     light_t *light = (light_t *)lightobj->priv; /* The light to process      */
     obj_t   *obj   = NULL;                      /* The occluding object      */
-    double  dir[VEC_SIZE];                      /* Unit vector direction     */
-    double  diffuse[VEC_SIZE];                  /* Diffuse light information */
-    double  light_dist;                         /* Distance to the light     */
     double  obj_dist;                           /* Distance to the object    */
-    double  cos;                                /* Cosine of light angle     */
+    double  spread = 1.0;                       /* Fraction sent to the hit  */
     int     i;                                  /* Counter                   */
-    
-    /* Compute direction from the hit point to the light source */
-    vec_diff3(hitobj->hitloc, light->center, dir);
 
-    /* Find the distance to the light source */
-    light_dist = vec_length3(dir);
+    /* Check to see if the light shines toward the hit point at all */
+    if (light->spread) {
+        double out[VEC_SIZE]; /* Unit direction from the light */
 
-    /* Compute direction unit vector */
-    vec_unit3(dir, dir);
+        vec_scale3(-1.0, dir, out);
 
-    /* Check to see if the light is self-occluded */
-    if ( (cos = vec_dot3(hitobj->normal, dir)) < 0 ) {
-        return MISS;
+        if ( (spread = light->spread(lightobj, out)) <= 0.0 ) {
+            return MISS;
+        }
     }
 
     /* See if there is an object in front of the light source */
-    obj = find_closest_obj(lst, hitobj->hitloc, dir, hitobj, &obj_dist);
+    obj = find_occluder(model, hitobj->hitloc, dir, hitobj, dist, &obj_dist);
 
     /* Check to see if the object is occluding the light source */
-    if ( (obj != NULL) && (obj_dist < light_dist) ) {
+    if (obj != NULL) {
         /* Debugging information */
         #ifdef DBG_DIFFUSE
             ivec_prn1(stderr, "hit object occluded by   ", &obj->objid);
@@ -182,12 +254,9 @@ int process_light(list_t *lst, obj_t *hitobj, obj_t *lightobj, double *ivec) {
         return MISS;
     }
 
-    /* Get diffuse lighting information from the object */
-    hitobj->getdiff(hitobj, diffuse);
-    
     /* Compute the illumination information */
     for (i = 0; i < VEC_SIZE; ++i) {
-        *(ivec + i) += diffuse[i] * lightobj->emissivity[i] * cos / light_dist;
+        *(ivec + i) += diffuse[i] * lightobj->emissivity[i] * spread * falloff;
     }
 
     /* Debugging information */
@@ -198,8 +267,8 @@ int process_light(list_t *lst, obj_t *hitobj, obj_t *lightobj, double *ivec) {
         ivec_prn1(stderr, "light object id was      ", &lightobj->objid);
         vec_prn3(stderr,  "light center was         ", light->center);
         vec_prn3(stderr,  "unit vector to light is  ", dir);
-        vec_prn1(stderr,  "distance to light is     ", &light_dist);
-        vec_prn1(stderr,  "cos is                   ", &cos);
+        vec_prn1(stderr,  "distance to light is     ", &dist);
+        vec_prn1(stderr,  "falloff is               ", &falloff);
         vec_prn3(stderr,  "emissivity of the light  ", lightobj->emissivity);
         vec_prn3(stderr,  "diffuse reflectivity     ", diffuse);
         vec_prn3(stderr,  "current ivec             ", ivec);
@@ -208,6 +277,415 @@ int process_light(list_t *lst, obj_t *hitobj, obj_t *lightobj, double *ivec) {
     return EXIT_SUCCESS;
 }
 
+/*
+ * light_block: Finds the direction, distance, cosine, and falloff of a
+ *              block of LIGHT_BLOCK lights from a point at once.  The loop
+ *              runs over the arrays of the light table with no branches, so
+ *              an optimizing compiler does several lights per instruction.
+ *
+ * Parameters:  table  - The light table.
+ *              start  - The first light of the block.
+ *              point  - The point (x, y, z).
+ *              normal - The unit normal at the point (x, y, z).
+ *              block  - Storage for the block.
+ */
+static void light_block(light_table_t *table, int start, double *point,
+                        double *normal, light_block_t *block) {
+    double *x = table->center[0] + start; /* Centers along x       */
+    double *y = table->center[1] + start; /* Centers along y       */
+    double *z = table->center[2] + start; /* Centers along z       */
+    double dx;                            /* Direction along x     */
+    double dy;                            /* Direction along y     */
+    double dz;                            /* Direction along z     */
+    double inv;                           /* One over the distance */
+    int    j;                             /* Light of the block    */
+
+    for (j = 0; j < LIGHT_BLOCK; ++j) {
+        dx  = x[j] - point[0];
+        dy  = y[j] - point[1];
+        dz  = z[j] - point[2];
+
+        block->dist[j]   = sqrt(dx * dx + dy * dy + dz * dz);
+        inv              = 1.0 / block->dist[j];
+        block->dir[0][j] = dx * inv;
+        block->dir[1][j] = dy * inv;
+        block->dir[2][j] = dz * inv;
+        block->cos[j]    = normal[0] * block->dir[0][j] +
+                           normal[1] * block->dir[1][j] +
+                           normal[2] * block->dir[2][j];
+        block->falloff[j] = block->cos[j] * inv;
+    }
+}
+
+/*
+ * process_area: Processes the diffuse lighting information for the
+ *               specified object from a light with an area, such as a
+ *               rectangle or a sphere, which casts soft shadows.  Each
+ *               shadow ray goes to its own point of the light, with its own
+ *               share of the emissivity.  The rays are tested as batches
+ *               (see find_occluders): first LIGHT_ADAPT of them, and then,
+ *               only if those disagree, the rest, since a point whose first
+ *               rays are all lit or all blocked is almost always wholly lit
+ *               or wholly in shadow.
+ *
+ * Parameters:   model    - A pointer to the world model.
+ *               hitobj   - The object that was hit by the ray.
+ *               lightobj - The current light source.
+ *               diffuse  - The diffuse reflectivity of the object (r, g, b).
+ *               ivec     - The (r, g, b) intensity vector.
+ *
+ * Return:       EXIT_SUCCESS if the light reached the object, MISS otherwise.
+ */
+static int process_area(model_t *model, obj_t *hitobj, obj_t *lightobj,
+                        double *diffuse, double *ivec) {
+    light_t       *light = (light_t *)lightobj->priv; /* The light        */
+    double        dirs[LIGHT_MAX_SAMPLES][VEC_SIZE];  /* Unit directions  */
+    double        dists[LIGHT_MAX_SAMPLES];           /* Their distances  */
+    double        weight[LIGHT_MAX_SAMPLES];          /* Their shares     */
+    char          blocked[LIGHT_MAX_SAMPLES];         /* Set if in shadow */
+    double        point[VEC_SIZE];                    /* Point of light   */
+    double        shift[2];                           /* Random shift     */
+    double        total = 0.0;                        /* Sum of shares    */
+    double        cos;                                /* Cosine to light  */
+    unsigned int  seed;                               /* Random state     */
+    int           count = light->samples;             /* Shadow rays      */
+    int           first;                              /* Rays cast first  */
+    int           facing = 0;                         /* First rays lit   */
+    int           lit;                                /* Unblocked rays   */
+    int           i;                                  /* Counter          */
+
+    /* The same point always gets the same shadow rays from the light */
+    seed     = (unsigned int)(hash_text((char *)hitobj->hitloc,
+                                        sizeof(hitobj->hitloc)) ^
+                              hash_text((char *)light->center,
+                                        sizeof(light->center)));
+    shift[0] = (double)rand_r(&seed) / ((double)RAND_MAX + 1.0);
+    shift[1] = (double)rand_r(&seed) / ((double)RAND_MAX + 1.0);
+
+    for (i = 0; i < count; ++i) {
+        light->sample(lightobj, hitobj->hitloc, i, shift, point);
+        vec_diff3(hitobj->hitloc, point, dirs[i]);
+        dists[i] = vec_length3(dirs[i]);
+        vec_unit3(dirs[i], dirs[i]);
+
+        /* Rays to the back of the surface are in shadow, and not cast */
+        cos        = vec_dot3(hitobj->normal, dirs[i]);
+        weight[i]  = cos > 0.0 && dists[i] > 0.0 ? cos / dists[i] : 0.0;
+        blocked[i] = weight[i] == 0.0;
+    }
+
+    /* Cast the first rays, and the rest only if they disagree */
+    first = count > LIGHT_ADAPT ? LIGHT_ADAPT : count;
+
+    for (i = 0; i < first; ++i) {
+        facing += !blocked[i];
+    }
+
+    lit = find_occluders(model, hitobj->hitloc, dirs, dists, first, hitobj,
+                         blocked);
+
+    if (facing > 0 && lit == 0) {
+        return MISS;
+    }
+
+    if (facing == 0 || lit < facing) {
+        find_occluders(model, hitobj->hitloc, dirs + first, dists + first,
+                       count - first, hitobj, blocked + first);
+    }
+
+    for (i = 0; i < count; ++i) {
+        total += blocked[i] ? 0.0 : weight[i];
+    }
+
+    if (total == 0.0) {
+        return MISS;
+    }
+
+    /* Compute the illumination information */
+    for (i = 0; i < VEC_SIZE; ++i) {
+        *(ivec + i) += diffuse[i] * lightobj->emissivity[i] * total / count;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/*
+ * table_lights: Gets the diffuse light information from every light of the
+ *               light table, a block at a time: the geometry of every light
+ *               of the block is found first (see light_block), and only the
+ *               lights in front of the surface are then tested for shadows
+ *               one by one.
+ *
+ * Parameters:   model   - A pointer to the world model.
+ *               hitobj  - The object that was hit by the ray.
+ *               primary - Nonzero if the ray came from the view point.
+ *               diffuse - The diffuse reflectivity of the object (r, g, b).
+ *               ivec    - The (r, g, b) intensity vector.
+ */
+static void table_lights(model_t *model, obj_t *hitobj, int primary,
+                         double *diffuse, double *ivec) {
+    light_table_t *table = model->ltab;  /* The light table          */
+    light_block_t block;                 /* The block of lights      */
+    obj_t         *obj;                  /* The light object         */
+    double        dir[VEC_SIZE];         /* Direction to a light     */
+    int           count;                 /* Lights of the block      */
+    int           start;                 /* First light of the block */
+    int           i;                     /* Counter                  */
+    int           j;                     /* Light of the block       */
+
+    if (table == NULL) {
+        return;
+    }
+
+    for (start = 0; start < table->count; start += LIGHT_BLOCK) {
+        light_block(table, start, hitobj->hitloc, hitobj->normal, &block);
+        count = table->count - start < LIGHT_BLOCK ? table->count - start :
+                                                     LIGHT_BLOCK;
+
+        for (j = 0; j < count; ++j) {
+            obj = table->objs[start + j];
+
+            if (primary && ((light_t *)obj->priv)->culled) {
+                continue;
+            }
+
+            /* Lights with an area cast many shadow rays */
+            if (((light_t *)obj->priv)->sample) {
+                process_area(model, hitobj, obj, diffuse, ivec);
+                continue;
+            }
+
+            /* Check to see if the light is self-occluded */
+            if (block.cos[j] < 0) {
+                continue;
+            }
+
+            for (i = 0; i < VEC_SIZE; ++i) {
+                dir[i] = block.dir[i][j];
+            }
+
+            shade_point(model, hitobj, obj, dir, block.dist[j],
+                        block.falloff[j], diffuse, ivec);
+        }
+    }
+}
+
+/* 
+ * diffuse_illumination: Gets the diffuse light information from the specified 
+ *                       object.  A hit on a plane with a baked lightmap
+ *                       takes its light from the map (see lightmap.c).
+ *                       Lights culled for the tile being rendered are
+ *                       skipped for the hits of primary rays.  With more
+ *                       lights than the shadow rays asked for per hit
+ *                       (--light-samples), only that many are sampled.
+ *                       Otherwise every light of the light table is
+ *                       processed (see table_lights).
+ *
+ * Parameters: model   - A pointer to the world model containing the lights.
+ *             hitobj  - The object that was hit by the ray.
+ *             primary - Nonzero if the ray came from the view point.
+ *             ivec    - The (r, g, b) intensity vector.
+ */
+void diffuse_illumination(model_t *model, obj_t *hitobj, int primary,
+                          double *ivec) {
+    double diffuse[VEC_SIZE]; /* Diffuse light             */
+    double light[VEC_SIZE];   /* Light baked at the hit    */
+    int    count;             /* Shadow rays per hit       */
+    int    i;                 /* Counter                   */
+
+    if (hitobj->lightmap &&
+        lightmap_lookup(hitobj->lightmap, hitobj->hitloc, light)) {
+        hitobj->getdiff(hitobj, diffuse);
+
+        for (i = 0; i < VEC_SIZE; ++i) {
+            ivec[i] += diffuse[i] * light[i];
+        }
+
+        return;
+    }
+
+    count = model->opts->light_samples;
+
+    if (model->ltree && count > 0 && count < model->ltree->num_lights) {
+        sample_lights(model, hitobj, primary, count, ivec);
+        return;
+    }
+
+    hitobj->getdiff(hitobj, diffuse);
+    table_lights(model, hitobj, primary, diffuse, ivec);
+}
+
+/*
+ * light_irradiance: Finds the light falling on a point of a surface from
+ *                   every light, shadows included, as the diffuse light of
+ *                   a white surface there, for baking into a lightmap.
+ *
+ * Parameters:       model  - A pointer to the world model.
+ *                   hitobj - The object, with the point and normal set as
+ *                            its last hit.
+ *                   light  - Storage for the light (r, g, b).
+ */
+void light_irradiance(model_t *model, obj_t *hitobj, double *light) {
+    double white[VEC_SIZE] = { 1.0, 1.0, 1.0 }; /* White reflectivity */
+
+    vec_scale3(0.0, light, light);
+    table_lights(model, hitobj, 0, white, light);
+}
+
+/*
+ * light_cull: Marks the lights that cannot reach any point of a cone of
+ *             primary rays, such as the rays of a tile of pixels, so that
+ *             the hits of those rays skip them.
+ *
+ * Parameters: model - A pointer to the world model containing the lights.
+ *             apex  - The view point, or NULL to unmark every light.
+ *             axis  - The unit axis of the cone.
+ *             angle - The half angle of the cone, in radians.
+ */
+void light_cull(model_t *model, double *apex, double *axis, double angle) {
+    link_t  *cursor = NULL; /* Cursor into the list of lights */
+    obj_t   *obj;           /* The light object               */
+    light_t *light;         /* The light                      */
+
+    for (cursor = model->lights->head; cursor; cursor = cursor->next) {
+        obj           = (obj_t *)cursor->item;
+        light         = (light_t *)obj->priv;
+        light->culled = apex && light->reaches &&
+                        !light->reaches(obj, apex, axis, angle);
+    }
+}
+
+/* 
+ * process_light: Processes the diffuse lighting information for the specified
+ *                object from one light (see shade_point and process_area).
+ *
+ * Parameters:    model    - A pointer to the world model.
+ *                hitobj   - The object that was hit by the ray.
+ *                lightobj - The current light source.
+ *                ivec     - The (r, g, b) intensity vector.
+ *
+ * Return:        EXIT_SUCCESS if no errors were encountered, failure otherwise.
+ */
+int process_light(model_t *model, obj_t *hitobj, obj_t *lightobj,
+                  double *ivec) {
+    light_t *light = (light_t *)lightobj->priv; /* The light to process      */
+    double  dir[VEC_SIZE];                      /* Unit vector direction     */
+    double  diffuse[VEC_SIZE];                  /* Diffuse light information */
+    double  light_dist;                         /* Distance to the light     */
+    double  cos;                                /* Cosine of light angle     */
+
+    /* Get diffuse lighting information from the object */
+    hitobj->getdiff(hitobj, diffuse);
+
+    /* Lights with an area cast many shadow rays */
+    if (light->sample) {
+        return process_area(model, hitobj, lightobj, diffuse, ivec);
+    }
+
+
+    /* Compute direction from the hit point to the light source */
+    vec_diff3(hitobj->hitloc, light->center, dir);
+
+    /* Find the distance to the light source */
+    light_dist = vec_length3(dir);
+
+    /* Compute direction unit vector */
+    vec_unit3(dir, dir);
+
+    /* Check to see if the light is self-occluded */
+    if ( (cos = vec_dot3(hitobj->normal, dir)) < 0 ) {
+        return MISS;
+    }
+
+    return shade_point(model, hitobj, lightobj, dir, light_dist,
+                       cos / light_dist, diffuse, ivec);
+}
+
+/*
+ * light_table: Builds the table of the specified lights, with the center
+ *              coordinates along each axis in an array of their own.  The
+ *              arrays are padded to a whole number of blocks (see
+ *              light_block) with copies of the last center.
+ *
+ * Parameters:  lights - The lights.
+ *
+ * Return:      The new light table, or NULL if there are no lights.
+ */
+light_table_t *light_table(list_t *lights) {
+    light_table_t *table  = NULL; /* The new table             */
+    link_t        *cursor = NULL; /* Cursor into the lights    */
+    light_t       *light  = NULL; /* The current light         */
+    int           count   = 0;    /* The number of lights      */
+    int           size;           /* The padded number         */
+    int           i;              /* Light index               */
+    int           j;              /* Axis                      */
+
+    for (cursor = lights->head; cursor; cursor = cursor->next) {
+        ++count;
+    }
+
+    if (count == 0) {
+        return NULL;
+    }
+
+    size         = (count + LIGHT_BLOCK - 1) / LIGHT_BLOCK * LIGHT_BLOCK;
+    table        = (light_table_t *)Malloc(sizeof(light_table_t));
+    table->objs  = (obj_t **)Malloc(count * sizeof(obj_t *));
+    table->count = count;
+
+    for (j = 0; j < VEC_SIZE; ++j) {
+        table->center[j] = (double *)Malloc(size * sizeof(double));
+    }
+
+    for (cursor = lights->head, i = 0; cursor; cursor = cursor->next, ++i) {
+        table->objs[i] = (obj_t *)cursor->item;
+        light          = (light_t *)table->objs[i]->priv;
+
+        for (j = 0; j < VEC_SIZE; ++j) {
+            table->center[j][i] = light->center[j];
+        }
+    }
+
+    for (; i < size; ++i) {
+        for (j = 0; j < VEC_SIZE; ++j) {
+            table->center[j][i] = table->center[j][count - 1];
+        }
+    }
+
+    return table;
+}
+
+/*
+ * light_table_destroy: Destroys the specified light table, but not its
+ *                      lights.
+ *
+ * Parameters:          table - The light table to destroy, or NULL.
+ */
+void light_table_destroy(light_table_t *table) {
+    int j; /* Axis */
+
+    if (table) {
+        for (j = 0; j < VEC_SIZE; ++j) {
+            Free(table->center[j]);
+        }
+
+        Free(table->objs);
+        Free(table);
+    }
+}
+
+/*
+ * light_move: Translates the specified light object by an offset.
+ *
+ * Parameters: obj    - The light object to move.
+ *             offset - The translation (x, y, z).
+ */
+void light_move(obj_t *obj, double *offset) {
+    light_t *light = (light_t *)obj->priv; /* The light to move */
+
+    vec_sum3(light->center, offset, light->center);
+}
+
 /* 
  * light_destroy: Destroys the specified light object.
  *
@@ -15,11 +15,49 @@
 #include "object.h"
 #include "veclib3d.h"
 
+/* The most shadow rays cast toward one light from one point */
+#define LIGHT_MAX_SAMPLES 256
+
+/* The shadow rays cast first; if they agree, no more are cast */
+#ifndef LIGHT_ADAPT
+    #define LIGHT_ADAPT 4
+#endif
+
+/* The lights whose geometry is found together by the diffuse sum */
+#ifndef LIGHT_BLOCK
+    #define LIGHT_BLOCK 8
+#endif
+
 /* Represents a source of light */
 typedef struct light_type {
     double center[VEC_SIZE];  /* The center location of the light source */
+    void   *priv;             /* Private data for specialized types      */
+    int    culled;            /* Set to skip the light for primary hits  */
+    int    samples;           /* Shadow rays cast toward it from a point */
+    double radius;            /* Radius about the center holding it      */
+
+    /* Fraction of the emissivity sent along a unit direction from the
+       center (NULL if the light shines equally in every direction) */
+    double (*spread)(struct obj_type *, double *dir);
+
+    /* Determines if the light may reach a point of the cone given by its
+       apex, unit axis, and half angle (NULL if it may reach any point) */
+    int (*reaches)(struct obj_type *, double *apex, double *axis,
+                   double angle);
+
+    /* Picks the point of the light for a shadow ray, seen from a point,
+       given the index of the ray and a random shift (NULL for a point) */
+    void (*sample)(struct obj_type *, double *from, int index,
+                   double *shift, double *point);
 } light_t;
 
+/* The lights of a scene, with their centers stored axis by axis */
+typedef struct light_table_type {
+    double *center[VEC_SIZE]; /* Center coordinates, an array per axis */
+    obj_t  **objs;            /* The light objects, in list order      */
+    int    count;             /* The number of lights                  */
+} light_table_t;
+
 /* Allocates, initializes and returns a new diffuse light source object */
 obj_t *light_init(FILE *in, int objtype);
 
@@ -35,14 +73,34 @@ void default_getdiff(obj_t *obj, double *diffuse);
 /* Gets the specular light information from the specified object */
 void default_getspec(obj_t *obj, double *specular);
 
+/* Gets the transmission information from the specified object */
+double default_gettrans(obj_t *obj, double *transmission);
+
 /* Gets the emissivity light information from the specified object */
 void default_getemiss(obj_t *obj, double *emissivity);
 
 /* Processes the diffuse light information for the world objects */
-void diffuse_illumination(model_t *model, obj_t *hitobj, double *ivec);
+void diffuse_illumination(model_t *model, obj_t *hitobj, int primary,
+                          double *ivec);
+
+/* Finds the light falling on the last hit of an object from every light */
+void light_irradiance(model_t *model, obj_t *hitobj, double *light);
+
+/* Marks the lights that cannot reach any point of a cone of primary rays */
+void light_cull(model_t *model, double *apex, double *axis, double angle);
 
 /* Processes the diffuse lighting information for the specified object */
-int process_light(list_t *lst, obj_t *hitobj, obj_t *lightobj, double *ivec);
+int process_light(model_t *model, obj_t *hitobj, obj_t *lightobj,
+                  double *ivec);
+
+/* Builds the table of the specified lights, or NULL if there are none */
+light_table_t *light_table(list_t *lights);
+
+/* Destroys the specified light table, but not its lights */
+void light_table_destroy(light_table_t *table);
+
+/* Translates the specified light object by an offset */
+void light_move(obj_t *obj, double *offset);
 
 /* Destroys the specified light object */
 void light_destroy(obj_t *obj);
@@ -0,0 +1,286 @@
+/*
+ * lightmap.c: This file contains the implementation details for lightmaps.
+ *             With --lightmap n, the diffuse light of every light falling on
+ *             each plane of the scene, shadows included, is found once at
+ *             the corners of a grid of texels over the plane, n texels along
+ *             its longer edge.  A hit on the plane then takes the light from
+ *             the four corners about it, blended by distance, instead of
+ *             casting shadow rays; only the diffuse reflectivity of the hit,
+ *             such as the color of a tile, is found as before.
+ *
+ *             A finite plane is baked whole.  An unbounded plane is baked
+ *             over a square about its point (see LIGHTMAP_EXTENT), and hits
+ *             beyond the square are lit by shadow rays.  The maps are baked
+ *             again whenever the lights move (see model_accel); when only
+ *             objects move, just the maps they could shade are baked again
+ *             (see lightmap_shades).
+ *
+ * Author:     Scott Gigawatt
+ *
+ * Version:    18 October 2026
+ */
+
+#include <math.h>
+#include "lightmap.h"
+#include "fplane.h"
+#include "light.h"
+#include "mem.h"
+
+/*
+ * plane_rect: Finds the rectangle of a plane that its lightmap covers.
+ *
+ * Parameters: obj    - The object.
+ *             origin - Storage for the first corner (x, y, z).
+ *             axis   - Storage for the unit directions of the edges.
+ *             size   - Storage for the lengths of the edges.
+ *
+ * Return:     Nonzero if the object is a plane, zero otherwise.
+ */
+static int plane_rect(obj_t *obj, double *origin, double axis[2][VEC_SIZE],
+                      double *size) {
+    plane_t  *plane  = (plane_t *)obj->priv;      /* The plane        */
+    fplane_t *fplane = NULL;                      /* The finite plane */
+    double   normal[VEC_SIZE];                    /* The unit normal  */
+    double   other[VEC_SIZE] = { 1.0, 0.0, 0.0 }; /* Not along it     */
+    int      i;                                   /* Counter          */
+
+    if (obj->objtype == FINITE_PLANE || obj->objtype == TEX_PLANE) {
+        /* The rectangle of the plane itself, as hits_fplane sees it */
+        fplane = (fplane_t *)plane->priv;
+
+        vec_scale3(1.0, plane->point, origin);
+        vec_scale3(1.0, fplane->rotmat[0], axis[0]);
+        vec_scale3(1.0, fplane->rotmat[1], axis[1]);
+        size[0] = fplane->size[0];
+        size[1] = fplane->size[1];
+
+        return 1;
+    }
+
+    if (obj->objtype != PLANE && obj->objtype != TILED_PLANE &&
+        obj->objtype != P_PLANE) {
+        return 0;
+    }
+
+    /* A square about the point of an unbounded plane */
+    vec_unit3(plane->normal, normal);
+
+    if (fabs(normal[0]) > 0.9) {
+        other[0] = 0.0;
+        other[1] = 1.0;
+    }
+
+    vec_cross3(normal, other, axis[0]);
+    vec_unit3(axis[0], axis[0]);
+    vec_cross3(normal, axis[0], axis[1]);
+
+    for (i = 0; i < VEC_SIZE; ++i) {
+        origin[i] = plane->point[i] - LIGHTMAP_EXTENT * (axis[0][i] +
+                                                         axis[1][i]);
+    }
+
+    size[0] = size[1] = 2.0 * LIGHTMAP_EXTENT;
+
+    return 1;
+}
+
+/*
+ * bake_plane: Bakes the lightmap of a plane, shading each corner of its
+ *             texels as a hit of the plane there.
+ *
+ * Parameters: model  - A pointer to the world model.
+ *             obj    - The object.
+ *             texels - The texels along the longer edge of the map.
+ *
+ * Return:     The new lightmap, or NULL if the object is not a plane.
+ */
+static lightmap_t *bake_plane(model_t *model, obj_t *obj, int texels) {
+    lightmap_t *map = NULL;       /* The new lightmap             */
+    double     origin[VEC_SIZE];  /* First corner of the map      */
+    double     axis[2][VEC_SIZE]; /* Directions of its edges      */
+    double     size[2];           /* Lengths of its edges         */
+    double     longest;           /* The longer of the two        */
+    int        row;               /* Corners along a row          */
+    int        i;                 /* Corner along the first edge  */
+    int        j;                 /* Corner along the second edge */
+    int        k;                 /* Counter                      */
+
+    if (!plane_rect(obj, origin, axis, size)) {
+        return NULL;
+    }
+
+    if ((longest = size[0] > size[1] ? size[0] : size[1]) <= 0.0) {
+        return NULL;
+    }
+
+    map = (lightmap_t *)Malloc(sizeof(lightmap_t));
+    vec_scale3(1.0, origin, map->origin);
+
+    for (k = 0; k < 2; ++k) {
+        vec_scale3(1.0, axis[k], map->axis[k]);
+        map->res[k]  = (int)ceil(texels * size[k] / longest);
+        map->res[k]  = map->res[k] > 0 ? map->res[k] : 1;
+        map->step[k] = size[k] > 0.0 ? size[k] / map->res[k] : 1.0;
+    }
+
+    row        = map->res[0] + 1;
+    map->light = Malloc(row * (map->res[1] + 1) * sizeof(*map->light));
+
+    /* The plane has the same normal everywhere (see plane_surface) */
+    vec_scale3(1.0, ((plane_t *)obj->priv)->normal, obj->normal);
+
+    for (j = 0; j <= map->res[1]; ++j) {
+        for (i = 0; i <= map->res[0]; ++i) {
+            for (k = 0; k < VEC_SIZE; ++k) {
+                obj->hitloc[k] = origin[k] + i * map->step[0] * axis[0][k] +
+                                             j * map->step[1] * axis[1][k];
+            }
+
+            light_irradiance(model, obj, map->light[j * row + i]);
+        }
+    }
+
+    return map;
+}
+
+/*
+ * lightmap_bake: Bakes the lightmap of each plane of the model, replacing
+ *                any baked before, if the rendering options ask for them.
+ *                Planes within prototypes are not baked.
+ *
+ * Parameters:    model - A pointer to the world model.
+ */
+void lightmap_bake(model_t *model) {
+    int i; /* Counter */
+
+    for (i = 0; i < model->num_objs; ++i) {
+        lightmap_rebake(model, model->objs[i]);
+    }
+}
+
+/*
+ * lightmap_rebake: Bakes the lightmap of one object of the model again, if
+ *                  it is a plane and the rendering options ask for maps.
+ *
+ * Parameters:      model - A pointer to the world model.
+ *                  obj   - The object.
+ */
+void lightmap_rebake(model_t *model, obj_t *obj) {
+    int texels = model->opts ? model->opts->lightmap : 0; /* Map size */
+
+    lightmap_destroy(obj->lightmap);
+    obj->lightmap = texels > 0 ? bake_plane(model, obj, texels) : NULL;
+}
+
+/*
+ * lightmap_shades: Determines whether an object within the specified box
+ *                  could shade the lightmap of a plane.  Every shadow ray
+ *                  baked into the map runs from a point of its rectangle to
+ *                  a point of a light, so it stays within the box about the
+ *                  rectangle and the lights.
+ *
+ * Parameters:      model - A pointer to the world model.
+ *                  obj   - The plane.
+ *                  lo    - The low corner of the box.
+ *                  hi    - The high corner of the box.
+ *
+ * Return:          Nonzero if the object has a lightmap the box meets,
+ *                  zero otherwise.
+ */
+int lightmap_shades(model_t *model, obj_t *obj, double *lo, double *hi) {
+    double  origin[VEC_SIZE];   /* First corner of the map  */
+    double  axis[2][VEC_SIZE];  /* Directions of its edges  */
+    double  size[2];            /* Lengths of its edges     */
+    double  box[2][VEC_SIZE];   /* The box of shadow rays   */
+    double  corner;             /* A corner of the map      */
+    link_t  *cursor = NULL;     /* Cursor into the lights   */
+    light_t *light  = NULL;     /* The current light        */
+    int     c;                  /* Corner index             */
+    int     k;                  /* Axis index               */
+
+    if (obj->lightmap == NULL || !plane_rect(obj, origin, axis, size)) {
+        return 0;
+    }
+
+    for (k = 0; k < VEC_SIZE; ++k) {
+        box[0][k] = HUGE_VAL;
+        box[1][k] = -HUGE_VAL;
+
+        /* The four corners of the map */
+        for (c = 0; c < 4; ++c) {
+            corner    = origin[k] + (c & 1) * size[0] * axis[0][k] +
+                                    (c >> 1) * size[1] * axis[1][k];
+            box[0][k] = fmin(box[0][k], corner);
+            box[1][k] = fmax(box[1][k], corner);
+        }
+
+        /* And every light, with the room it takes up */
+        for (cursor = model->lights->head; cursor; cursor = cursor->next) {
+            light     = (light_t *)((obj_t *)cursor->item)->priv;
+            box[0][k] = fmin(box[0][k], light->center[k] - light->radius);
+            box[1][k] = fmax(box[1][k], light->center[k] + light->radius);
+        }
+
+        if (hi[k] < box[0][k] || lo[k] > box[1][k]) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/*
+ * lightmap_lookup: Looks up the light at a point of a plane, blending the
+ *                  light at the four corners of the texel holding it.
+ *
+ * Parameters:      map   - The lightmap of the plane.
+ *                  point - The point (x, y, z).
+ *                  light - Storage for the light (r, g, b).
+ *
+ * Return:          Nonzero if the point is on the map, zero otherwise.
+ */
+int lightmap_lookup(lightmap_t *map, double *point, double *light) {
+    double (*corner)[VEC_SIZE];    /* First corner of the texel */
+    double offset[VEC_SIZE];       /* The point from the origin */
+    double uv[2];                  /* Its place in texels       */
+    double frac[2];                /* Its place in the texel    */
+    int    row = map->res[0] + 1;  /* Corners along a row       */
+    int    cell;                   /* The texel along an edge   */
+    int    k;                      /* Counter                   */
+
+    vec_diff3(map->origin, point, offset);
+    corner = map->light;
+
+    for (k = 0; k < 2; ++k) {
+        uv[k] = vec_dot3(offset, map->axis[k]) / map->step[k];
+
+        if (uv[k] < 0.0 || uv[k] > map->res[k]) {
+            return 0;
+        }
+
+        cell    = (int)uv[k] < map->res[k] ? (int)uv[k] : map->res[k] - 1;
+        frac[k] = uv[k] - cell;
+        corner += k == 0 ? cell : cell * row;
+    }
+
+    for (k = 0; k < VEC_SIZE; ++k) {
+        light[k] = (1.0 - frac[1]) * ((1.0 - frac[0]) * corner[0][k] +
+                                      frac[0] * corner[1][k]) +
+                   frac[1] * ((1.0 - frac[0]) * corner[row][k] +
+                              frac[0] * corner[row + 1][k]);
+    }
+
+    return 1;
+}
+
+/*
+ * lightmap_destroy: Destroys the specified lightmap.
+ *
+ * Parameters:       map - The lightmap to destroy, or NULL.
+ */
+void lightmap_destroy(lightmap_t *map) {
+    if (map) {
+        Free(map->light);
+        Free(map);
+    }
+}
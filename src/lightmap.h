@@ -0,0 +1,46 @@
+/*
+ * lightmap.h: This header file contains the implementation specifications
+ *             for lightmaps, the diffuse light falling on a plane, shadows
+ *             and all, baked once into a grid before rendering.
+ *
+ * Author:     Scott Gigawatt
+ *
+ * Version:    18 October 2026
+ */
+
+#ifndef LIGHTMAP_H
+#define LIGHTMAP_H
+
+#include "model.h"
+#include "object.h"
+
+/* Half the width of the square baked about the point of an unbounded plane */
+#ifndef LIGHTMAP_EXTENT
+    #define LIGHTMAP_EXTENT 20.0
+#endif
+
+/* The light falling on a rectangle of a plane, at the corners of its texels */
+typedef struct lightmap_type {
+    double origin[VEC_SIZE];   /* The first corner of the rectangle */
+    double axis[2][VEC_SIZE];  /* Unit directions of its edges      */
+    double step[2];            /* The width and height of a texel   */
+    int    res[2];             /* The texels along each edge        */
+    double (*light)[VEC_SIZE]; /* Light (r, g, b) at each corner    */
+} lightmap_t;
+
+/* Bakes the lightmap of each plane of the model, if the options ask */
+void lightmap_bake(model_t *model);
+
+/* Bakes the lightmap of one object of the model again, if it is a plane */
+void lightmap_rebake(model_t *model, obj_t *obj);
+
+/* Determines whether an object within a box could shade a plane's lightmap */
+int lightmap_shades(model_t *model, obj_t *obj, double *lo, double *hi);
+
+/* Looks up the light at a point of a plane, returning zero if off the map */
+int lightmap_lookup(lightmap_t *map, double *point, double *light);
+
+/* Destroys the specified lightmap */
+void lightmap_destroy(lightmap_t *map);
+
+#endif
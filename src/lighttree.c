@@ -0,0 +1,315 @@
+/*
+ * lighttree.c: This file contains the implementation details for a light
+ *              tree.  The lights are gathered into a bounding volume
+ *              hierarchy (see bvh.c), and each node keeps the total power
+ *              of the lights beneath it and the sphere about its box.  A
+ *              light is picked for a point by walking down from the root,
+ *              choosing each child in proportion to how much light it could
+ *              send the point: its power, over the distance to it, times
+ *              the largest cosine the surface could see it at.  Groups of
+ *              lights behind the surface are never picked, and far groups
+ *              seldom, so a few shadow rays stand in for many lights.
+ *
+ * Author:      Scott Gigawatt
+ *
+ * Version:     18 October 2026
+ */
+
+#include <math.h>
+#include "lighttree.h"
+#include "light.h"
+#include "mem.h"
+
+/*
+ * light_box:  Finds the bounding box of a light, the sphere about its
+ *             center that holds it.
+ *
+ * Parameters: data - The lights.
+ *             item - The light.
+ *             lo   - Storage for the low corner (x, y, z).
+ *             hi   - Storage for the high corner (x, y, z).
+ *
+ * Return:     Nonzero, since every light is bounded.
+ */
+static int light_box(void *data, int item, double *lo, double *hi) {
+    light_t *light = (light_t *)((obj_t **)data)[item]->priv; /* The light */
+    int     i;                                                /* Counter   */
+
+    for (i = 0; i < VEC_SIZE; ++i) {
+        lo[i] = light->center[i] - light->radius;
+        hi[i] = light->center[i] + light->radius;
+    }
+
+    return 1;
+}
+
+/*
+ * importance: Estimates how much light a sphere of lights could send a
+ *             point: their power over the distance to the center, times
+ *             the cosine of the smallest angle between the normal and a
+ *             direction into the sphere.  A sphere wholly behind the
+ *             surface sends none.
+ *
+ * Parameters: center - The center of the sphere (x, y, z).
+ *             radius - The radius of the sphere.
+ *             power  - The power of the lights.
+ *             point  - The point (x, y, z).
+ *             normal - The unit normal at the point (x, y, z).
+ *
+ * Return:     The estimate, or zero if the lights cannot reach the point.
+ */
+static double importance(double *center, double radius, double power,
+                         double *point, double *normal) {
+    double to[VEC_SIZE]; /* Toward the center             */
+    double dist;         /* Distance to it                */
+    double cosine;       /* Cosine of the angle to it     */
+    double sine;         /* Sine of the angle to it       */
+    double edge[2];      /* Cosine and sine of the radius */
+
+    vec_diff3(point, center, to);
+    dist = vec_length3(to);
+
+    /* A point among the lights may see them all head on */
+    if (dist <= radius) {
+        return power / (radius > LIGHTTREE_EPSILON ? radius :
+                                                     LIGHTTREE_EPSILON);
+    }
+
+    cosine = vec_dot3(normal, to) / dist;
+
+    if (radius == 0.0) {
+        return cosine > 0.0 ? power * cosine / dist : 0.0;
+    }
+
+    /* The normal may point into the sphere */
+    edge[1] = radius / dist;
+    edge[0] = sqrt(1.0 - edge[1] * edge[1]);
+
+    if (cosine >= edge[0]) {
+        return power / dist;
+    }
+
+    /* Otherwise take the cosine of the angle less the angular radius */
+    sine   = sqrt(1.0 - cosine * cosine);
+    cosine = cosine * edge[0] + sine * edge[1];
+
+    return cosine > 0.0 ? power * cosine / dist : 0.0;
+}
+
+/*
+ * node_importance: Estimates how much light the lights of a node could
+ *                  send a point, from the sphere about the node's box.
+ *
+ * Parameters:      tree   - The light tree.
+ *                  index  - The index of the node.
+ *                  point  - The point (x, y, z).
+ *                  normal - The unit normal at the point (x, y, z).
+ *
+ * Return:          The estimate, or zero if the lights cannot reach it.
+ */
+static double node_importance(lighttree_t *tree, int index, double *point,
+                              double *normal) {
+    return importance(tree->sphere[index], tree->sphere[index][VEC_SIZE],
+                      tree->power[index], point, normal);
+}
+
+/*
+ * light_importance: Estimates how much light one light could send a point.
+ *                   A point light that shines along some directions only,
+ *                   such as a spotlight, is weighed by its spread toward
+ *                   the point.
+ *
+ * Parameters:       tree   - The light tree.
+ *                   item   - The light.
+ *                   point  - The point (x, y, z).
+ *                   normal - The unit normal at the point (x, y, z).
+ *
+ * Return:           The estimate, or zero if the light cannot reach it.
+ */
+static double light_importance(lighttree_t *tree, int item, double *point,
+                               double *normal) {
+    obj_t   *obj   = tree->lights[item];    /* The light object        */
+    light_t *light = (light_t *)obj->priv;  /* The light               */
+    double  out[VEC_SIZE];                  /* From the light          */
+    double  weight;                         /* The estimate            */
+
+    weight = importance(light->center, light->radius, tree->item_power[item],
+                        point, normal);
+
+    if (weight > 0.0 && light->spread && light->radius == 0.0) {
+        vec_diff3(light->center, point, out);
+        vec_unit3(out, out);
+        weight *= light->spread(obj, out);
+    }
+
+    return weight;
+}
+
+/*
+ * lighttree_build: Builds a light tree over the specified lights.  The
+ *                  power of a light is the sum of its emissivity.
+ *
+ * Parameters:      lights - The lights.
+ *
+ * Return:          The new light tree, or NULL if there are no lights.
+ */
+lighttree_t *lighttree_build(list_t *lights) {
+    lighttree_t *tree   = NULL; /* The new tree             */
+    link_t      *cursor = NULL; /* Cursor into the lights   */
+    bvh_node_t  *node   = NULL; /* The current node         */
+    obj_t       *obj    = NULL; /* The current light        */
+    int         *items  = NULL; /* The lights in leaf order */
+    double      half[VEC_SIZE]; /* Half a node's diagonal   */
+    int         count   = 0;    /* The number of lights     */
+    int         i;              /* Light or node index      */
+    int         j;              /* Counter                  */
+
+    for (cursor = lights->head; cursor; cursor = cursor->next) {
+        ++count;
+    }
+
+    if (count == 0) {
+        return NULL;
+    }
+
+    tree             = (lighttree_t *)Malloc(sizeof(lighttree_t));
+    tree->lights     = (obj_t **)Malloc(count * sizeof(obj_t *));
+    tree->item_power = (double *)Malloc(count * sizeof(double));
+    tree->num_lights = count;
+
+    for (cursor = lights->head, i = 0; cursor; cursor = cursor->next, ++i) {
+        obj                 = (obj_t *)cursor->item;
+        tree->lights[i]     = obj;
+        tree->item_power[i] = 0.0;
+
+        for (j = 0; j < VEC_SIZE; ++j) {
+            tree->item_power[i] += fabs(obj->emissivity[j]);
+        }
+    }
+
+    tree->bvh   = bvh_tree(count, light_box, tree->lights);
+    tree->power  = (double *)Malloc(tree->bvh->num_nodes * sizeof(double));
+    tree->sphere = Malloc(tree->bvh->num_nodes * sizeof(*tree->sphere));
+    items        = tree->bvh->items;
+
+    /* Children follow their parents, so sum the powers from the last node */
+    for (i = tree->bvh->num_nodes - 1; i >= 0; --i) {
+        node = &tree->bvh->nodes[i];
+
+        for (j = 0; j < VEC_SIZE; ++j) {
+            tree->sphere[i][j] = (node->lo[j] + node->hi[j]) / 2.0;
+            half[j]            = (node->hi[j] - node->lo[j]) / 2.0;
+        }
+
+        tree->sphere[i][VEC_SIZE] = vec_length3(half);
+
+        if (node->count == 0) {
+            tree->power[i] = tree->power[i + 1] + tree->power[node->start];
+            continue;
+        }
+
+        tree->power[i] = 0.0;
+
+        for (j = 0; j < node->count; ++j) {
+            tree->power[i] += tree->item_power[items[node->start + j]];
+        }
+    }
+
+    return tree;
+}
+
+/*
+ * lighttree_pick: Picks a light for a shadow ray from a point, walking down
+ *                 the tree and choosing each child, and then each light of
+ *                 the leaf, in proportion to its importance.  The random
+ *                 number is rescaled at each choice and used again, so
+ *                 numbers spread evenly from 0 to 1 pick lights spread
+ *                 evenly through the tree.
+ *
+ * Parameters:     tree   - The light tree.
+ *                 point  - The point (x, y, z).
+ *                 normal - The unit normal at the point (x, y, z).
+ *                 u      - A random number, 0 to 1.
+ *                 prob   - Storage for the probability of the light picked.
+ *
+ * Return:         The index of the light in tree->lights, or MISS if no
+ *                 light can reach the point.
+ */
+int lighttree_pick(lighttree_t *tree, double *point, double *normal,
+                   double u, double *prob) {
+    bvh_node_t *node = tree->bvh->nodes;  /* The current node        */
+    double     weight[BVH_LEAF];          /* Importance of each      */
+    double     total;                     /* Their sum               */
+    double     share;                     /* Chance of the left one  */
+    int        index = 0;                 /* Index of the node       */
+    int        last  = MISS;              /* Last light that can     */
+    int        i;                         /* Counter                 */
+
+    *prob = 1.0;
+
+    while (node->count == 0) {
+        weight[0] = node_importance(tree, index + 1, point, normal);
+        weight[1] = node_importance(tree, node->start, point, normal);
+
+        if ((total = weight[0] + weight[1]) <= 0.0) {
+            return MISS;
+        }
+
+        share = weight[0] / total;
+
+        if (u < share) {
+            u     /= share;
+            *prob *= share;
+            index  = index + 1;
+        } else {
+            u      = (u - share) / (1.0 - share);
+            *prob *= 1.0 - share;
+            index  = node->start;
+        }
+
+        node = &tree->bvh->nodes[index];
+    }
+
+    for (i = 0, total = 0.0; i < node->count; ++i) {
+        weight[i] = light_importance(tree, tree->bvh->items[node->start + i],
+                                     point, normal);
+        total    += weight[i];
+    }
+
+    if (total <= 0.0) {
+        return MISS;
+    }
+
+    /* Skip the lights that cannot reach the point */
+    for (i = 0; i < node->count; ++i) {
+        if (weight[i] > 0.0) {
+            last = i;
+
+            if (u < weight[i] / total) {
+                break;
+            }
+
+            u -= weight[i] / total;
+        }
+    }
+
+    *prob *= weight[last] / total;
+
+    return tree->bvh->items[node->start + last];
+}
+
+/*
+ * lighttree_destroy: Destroys the specified light tree, but not its lights.
+ *
+ * Parameters:        tree - The light tree to destroy, or NULL.
+ */
+void lighttree_destroy(lighttree_t *tree) {
+    if (tree) {
+        bvh_destroy(tree->bvh);
+        Free(tree->power);
+        Free(tree->sphere);
+        Free(tree->item_power);
+        Free(tree->lights);
+        Free(tree);
+    }
+}
@@ -0,0 +1,41 @@
+/*
+ * lighttree.h: This header file contains the implementation specifications
+ *              for a light tree, a hierarchy over the lights of a scene
+ *              from which the few lights worth a shadow ray from a point
+ *              are picked at random.
+ *
+ * Author:      Scott Gigawatt
+ *
+ * Version:     18 October 2026
+ */
+
+#ifndef LIGHTTREE_H
+#define LIGHTTREE_H
+
+#include "bvh.h"
+#include "list.h"
+
+/* The nearest a point is taken to be to a light or a group of lights */
+#define LIGHTTREE_EPSILON 1e-6
+
+/* A hierarchy over the lights of a scene */
+typedef struct lighttree_type {
+    bvh_t  *bvh;                    /* The hierarchy over the lights      */
+    obj_t  **lights;                /* The lights, numbered as the items  */
+    double *power;                  /* The total power of each node       */
+    double (*sphere)[VEC_SIZE + 1]; /* Center and radius about each node  */
+    double *item_power;             /* The power of each light            */
+    int    num_lights;              /* The number of lights               */
+} lighttree_t;
+
+/* Builds a light tree over the specified lights, or NULL if there are none */
+lighttree_t *lighttree_build(list_t *lights);
+
+/* Picks a light for a shadow ray from a point, with its probability */
+int lighttree_pick(lighttree_t *tree, double *point, double *normal,
+                   double u, double *prob);
+
+/* Destroys the specified light tree, but not its lights */
+void lighttree_destroy(lighttree_t *tree);
+
+#endif
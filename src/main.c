@@ -11,6 +11,11 @@
 #include "raytrace.h"
 #include "mem.h"
 #include "image.h"
+#include "anim.h"
+#include "incr.h"
+#include "progress.h"
+#include "server.h"
+#include "shard.h"
 
 /*
  * main:       This function provides an entry point into the ray tracer
@@ -20,28 +25,61 @@
  *             argv[1] - The window width in pixels (x).
  *             argv[2] - The window height in pixels (y).
  *
+ *             Any "--" rendering options may precede or follow the window
+ *             dimensions (see options.c).
+ *
  * Return:     EXIT_SUCCESS if no errors were encountered, failure otherwise.
  */
 int main(int argc, char **argv) {
     model_t *model = (model_t *)Malloc(sizeof(model_t)); /* The world model */
     int     rc     = 0;                                  /* The read count  */
 
+    /* Initialize the rendering options */
+    model->opts = options_init(&argc, argv);
+    options_dump(stderr, model->opts);
+
+    /* Serve render jobs until stopped, rather than rendering standard in */
+    if (model->opts->serve) {
+        rc = serve(model->opts);
+        Free(model->opts);
+        Free(model);
+
+        return rc;
+    }
+
     /* Initialize the projection information */
     model->proj = projection_init(argc, argv, stdin);
+    projection_camera(model->proj, model->opts);
     projection_dump(stderr, model->proj);
 
     /* Initialize the light and scene object list */
     model->lights = list_init();
     model->scene  = list_init();
+    model->insts  = NULL;
+    model->ltree  = NULL;
+    model->ltab   = NULL;
 
     /* Initialize the model */
     rc = model_init(stdin, model);
     model_dump(stderr, model);
 
-    /* Create the image */
-    if (rc == 0) {
+    /* Create the image, every frame of the animation, or each pass */
+    if (rc == 0 && model->opts->animate) {
+        anim_render(model);
+    } else if (rc == 0 && model->opts->incremental) {
+        incr_render(model);
+    } else if (rc == 0 && model->opts->shard[1] > 0) {
+        shard_render(model);
+    } else if (rc == 0 && model->opts->budget > 0.0) {
+        budget_render(model);
+    } else if (rc == 0 && model->opts->progressive) {
+        progress_render(model);
+    } else if (rc == 0) {
         make_image(model);
     }
 
+    /* Free any memory associated with the ray tracer */
+    dalloc(model);
+
     return EXIT_SUCCESS;
 }
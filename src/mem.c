@@ -22,8 +22,8 @@
 void *Malloc(size_t size) {
     void *ptr = NULL;
 
-    /* Check for valid size */
-    if ( (int)size <= 0 ) {
+    /* Check for valid size (large meshes need more than an int can hold) */
+    if ( size == 0 ) {
         msg_exit(stderr, "Malloc: error: size must be > zero");
     /* Allocate memory and check for errors */
     } else if ( (ptr = malloc(size)) == NULL ) {
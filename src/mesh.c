@@ -0,0 +1,578 @@
+/*
+ * mesh.c:  This file contains the implementation details for a triangle
+ *          mesh object, read from a Wavefront OBJ file.  Only the vertices
+ *          ("v") and faces ("f") of the file are used; faces with more than
+ *          three corners are split into a fan of triangles, and texture and
+ *          normal indices are ignored.  The vertices are kept as floats and
+ *          the triangles as indices into them, so a mesh of millions of
+ *          triangles fits in memory, and a bounding volume hierarchy over
+ *          the triangles finds the ones along a ray.
+ *
+ *          The mesh is moved and scaled by taking each ray into the
+ *          coordinates of the file, so moving it never touches the
+ *          vertices or the hierarchy.  The ray is tested against each
+ *          triangle with the watertight test of Woop, Benthin, and Wald,
+ *          which computes the edge shared by two triangles the same way for
+ *          both, so no ray slips between them.
+ *
+ * Author:  Scott Gigawatt
+ *
+ * Version: 18 October 2026
+ */
+
+#include <ctype.h>
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mesh.h"
+#include "mem.h"
+#include "veclib3d.h"
+
+/* A ray, prepared for the watertight triangle test */
+typedef struct tri_ray_type {
+    mesh_t *mesh; /* The mesh being tested                */
+    int    skip;  /* The triangle the ray leaves, or -1   */
+    int    kx;    /* The first axis across the ray        */
+    int    ky;    /* The second axis across the ray       */
+    int    kz;    /* The major axis of the ray            */
+    double sx;    /* The shear of x along the major axis  */
+    double sy;    /* The shear of y along the major axis  */
+    double sz;    /* The scale of the major axis          */
+} tri_ray_t;
+
+/*
+ * grow:       Doubles the capacity of an array once it is full.
+ *
+ * Parameters: array - The array.
+ *             count - The number of elements in use.
+ *             cap   - The capacity, updated if the array grows.
+ *             size  - The size of an element.
+ *
+ * Return:     The array, which may have moved.
+ */
+static void *grow(void *array, int count, int *cap, size_t size) {
+    void *bigger; /* The new array */
+
+    if (count < *cap) {
+        return array;
+    }
+
+    *cap  *= 2;
+    bigger = Malloc(*cap * size);
+    memcpy(bigger, array, count * size);
+    Free(array);
+
+    return bigger;
+}
+
+/*
+ * mesh_error: Exits with an error about a line of the OBJ file.
+ *
+ * Parameters: mesh   - The mesh being read.
+ *             lineno - The line number.
+ *             what   - The problem.
+ */
+static void mesh_error(mesh_t *mesh, int lineno, char *what) {
+    char msg[MSG_SIZE]; /* The error message */
+
+    snprintf(msg, MSG_SIZE, "mesh_init: error: %.128s:%d: %s", mesh->name, lineno,
+             what);
+    msg_exit(stderr, msg);
+}
+
+/*
+ * mesh_read:  Reads the vertices and faces of an OBJ file, a line at a
+ *             time, into the mesh.
+ *
+ * Parameters: mesh - The mesh.
+ *             obj  - The OBJ file.
+ */
+static void mesh_read(mesh_t *mesh, FILE *obj) {
+    char   *line   = NULL; /* The current line               */
+    size_t len     = 0;    /* The size of the line buffer    */
+    char   *p;             /* Cursor into the line           */
+    char   *end;           /* The end of a number            */
+    int    vcap    = 1024; /* The capacity of the vertices   */
+    int    tcap    = 1024; /* The capacity of the triangles  */
+    int    lineno  = 0;    /* The current line number        */
+    int    corners;        /* The corners of a face so far   */
+    int    first   = 0;    /* The first corner of a face     */
+    int    prev    = 0;    /* The previous corner of a face  */
+    long   index;          /* A vertex index                 */
+    int    *tri;           /* A new triangle                 */
+    int    i;              /* Index                          */
+
+    mesh->verts     = (float *)Malloc(vcap * VEC_SIZE * sizeof(float));
+    mesh->tris      = (int *)Malloc(tcap * VEC_SIZE * sizeof(int));
+    mesh->num_verts = 0;
+    mesh->num_tris  = 0;
+
+    while (getline(&line, &len, obj) > 0) {
+        ++lineno;
+
+        for (p = line; isspace((unsigned char)*p); ++p);
+
+        if (p[0] == 'v' && isspace((unsigned char)p[1])) {
+            /* A vertex (x, y, z), with any weight ignored */
+            mesh->verts = (float *)grow(mesh->verts, mesh->num_verts, &vcap,
+                                        VEC_SIZE * sizeof(float));
+
+            for (++p, i = 0; i < VEC_SIZE; ++i, p = end) {
+                mesh->verts[mesh->num_verts * VEC_SIZE + i] = strtod(p, &end);
+
+                if (end == p) {
+                    mesh_error(mesh, lineno, "invalid vertex");
+                }
+            }
+
+            ++mesh->num_verts;
+        } else if (p[0] == 'f' && isspace((unsigned char)p[1])) {
+            /* A face, each corner "v", "v/vt", "v//vn", or "v/vt/vn" */
+            for (++p, corners = 0; ; ++corners) {
+                for (; isspace((unsigned char)*p); ++p);
+
+                if (*p == '\0' || *p == '#') {
+                    break;
+                }
+
+                index = strtol(p, &end, 10);
+
+                if (end == p || index == 0) {
+                    mesh_error(mesh, lineno, "invalid face");
+                }
+
+                /* Negative indices count back from the last vertex */
+                index = index < 0 ? mesh->num_verts + index : index - 1;
+
+                /* Later vertices are checked once read, but an index must
+                   fit the triangle it is stored in */
+                if (index < 0 || index > INT_MAX) {
+                    mesh_error(mesh, lineno, "no such vertex");
+                }
+
+                for (p = end; *p && !isspace((unsigned char)*p); ++p);
+
+                /* Split the face into a fan, dropping empty triangles */
+                if (corners == 0) {
+                    first = index;
+                } else if (corners >= 2 && first != prev && prev != index &&
+                           index != first) {
+                    mesh->tris = (int *)grow(mesh->tris, mesh->num_tris, &tcap,
+                                             VEC_SIZE * sizeof(int));
+                    tri        = mesh->tris + mesh->num_tris++ * VEC_SIZE;
+                    tri[0]     = first;
+                    tri[1]     = prev;
+                    tri[2]     = index;
+                }
+
+                prev = index;
+            }
+
+            if (corners < 3) {
+                mesh_error(mesh, lineno, "face with fewer than 3 corners");
+            }
+        }
+    }
+
+    free(line);
+
+    /* Faces may name vertices that come after them */
+    for (i = 0; i < mesh->num_tris * VEC_SIZE; ++i) {
+        if (mesh->tris[i] >= mesh->num_verts) {
+            mesh_error(mesh, lineno, "no such vertex");
+        }
+    }
+
+    if (mesh->num_tris == 0) {
+        mesh_error(mesh, lineno, "no triangles");
+    }
+}
+
+/*
+ * tri_box:    Finds the bounding box of a triangle of a mesh.
+ *
+ * Parameters: data - The mesh.
+ *             item - The triangle.
+ *             lo   - Storage for the low corner of the box.
+ *             hi   - Storage for the high corner of the box.
+ *
+ * Return:     Nonzero, since a triangle is bounded.
+ */
+static int tri_box(void *data, int item, double *lo, double *hi) {
+    mesh_t *mesh = (mesh_t *)data;                   /* The mesh     */
+    int    *tri  = mesh->tris + item * VEC_SIZE;     /* The triangle */
+    float  *vert;                                    /* A vertex     */
+    int    i;                                        /* Corner index */
+    int    j;                                        /* Axis index   */
+
+    for (j = 0; j < VEC_SIZE; ++j) {
+        lo[j] = HUGE_VAL;
+        hi[j] = -HUGE_VAL;
+    }
+
+    for (i = 0; i < VEC_SIZE; ++i) {
+        vert = mesh->verts + tri[i] * VEC_SIZE;
+
+        for (j = 0; j < VEC_SIZE; ++j) {
+            lo[j] = fmin(lo[j], vert[j]);
+            hi[j] = fmax(hi[j], vert[j]);
+        }
+    }
+
+    return 1;
+}
+
+/*
+ * tri_test:   Tests a ray against a triangle of a mesh with the watertight
+ *             test.  The triangle is sheared so that the ray runs down the
+ *             z axis from the origin, where the ray hits it only if the
+ *             origin is on the same side of all three edges.
+ *
+ * Parameters: data - The prepared ray.
+ *             item - The triangle.
+ *             base - The base location of the ray.
+ *             dir  - The unit vector direction of the ray.
+ *             tmin - Hits at or before this distance are misses.
+ *             tmax - Hits at or beyond this distance are misses.
+ *
+ * Return:     The distance to the hit location, or MISS.
+ */
+static double tri_test(void *data, int item, double *base, double *dir,
+                       double tmin, double tmax) {
+    tri_ray_t *ray  = (tri_ray_t *)data;                  /* The ray       */
+    int       *tri  = ray->mesh->tris + item * VEC_SIZE;  /* The triangle  */
+    double    a[VEC_SIZE][VEC_SIZE];                      /* The corners   */
+    double    x[VEC_SIZE];                                /* Sheared x     */
+    double    y[VEC_SIZE];                                /* Sheared y     */
+    double    u;                                          /* Edge function */
+    double    v;                                          /* Edge function */
+    double    w;                                          /* Edge function */
+    double    det;                                        /* Their sum     */
+    double    dist;                                       /* The distance  */
+    float     *vert;                                      /* A vertex      */
+    int       i;                                          /* Corner index  */
+    int       j;                                          /* Axis index    */
+
+    if (item == ray->skip) {
+        return MISS;
+    }
+
+    /* Take the corners relative to the ray and shear them */
+    for (i = 0; i < VEC_SIZE; ++i) {
+        vert = ray->mesh->verts + tri[i] * VEC_SIZE;
+
+        for (j = 0; j < VEC_SIZE; ++j) {
+            a[i][j] = vert[j] - base[j];
+        }
+
+        x[i] = a[i][ray->kx] - ray->sx * a[i][ray->kz];
+        y[i] = a[i][ray->ky] - ray->sy * a[i][ray->kz];
+    }
+
+    u = x[2] * y[1] - y[2] * x[1];
+    v = x[0] * y[2] - y[0] * x[2];
+    w = x[1] * y[0] - y[1] * x[0];
+
+    /* The origin must be inside every edge, or on it */
+    if ((u < 0.0 || v < 0.0 || w < 0.0) && (u > 0.0 || v > 0.0 || w > 0.0)) {
+        return MISS;
+    }
+
+    if ((det = u + v + w) == 0.0) {
+        return MISS;
+    }
+
+    dist = ray->sz * (u * a[0][ray->kz] + v * a[1][ray->kz] +
+                      w * a[2][ray->kz]) / det;
+
+    return dist > tmin && dist < tmax ? dist : MISS;
+}
+
+/*
+ * trace_mesh: Traces a ray through the hierarchy of a mesh, in the
+ *             coordinates of its OBJ file.
+ *
+ * Parameters: base - The base location of the ray.
+ *             dir  - The unit vector direction of the ray.
+ *             tmin - Hits at or before this distance are misses.
+ *             tmax - Hits at or beyond this distance are misses.
+ *             obj  - The mesh object to test.
+ *             skip - The triangle the ray leaves, or -1.
+ *
+ * Return:     The distance to the hit location, or MISS.
+ */
+static double trace_mesh(double *base, double *dir, double tmin,
+                         double tmax, obj_t *obj, int skip) {
+    mesh_t    *mesh = (mesh_t *)obj->priv;  /* The mesh                 */
+    double    lbase[VEC_SIZE];              /* The base in the file     */
+    double    ltmin = tmin / mesh->scale;   /* The tmin in the file     */
+    double    ltmax = tmax / mesh->scale;   /* The tmax in the file     */
+    tri_ray_t ray;                          /* The prepared ray         */
+    int       swap;                         /* Swap space               */
+    int       hit;                          /* The triangle hit         */
+    int       j;                            /* Axis index               */
+
+    for (j = 0; j < VEC_SIZE; ++j) {
+        lbase[j] = (base[j] - mesh->offset[j]) / mesh->scale;
+    }
+
+    /* A ray leaving the mesh must not hit beside the triangle it leaves */
+    if (skip >= 0) {
+        ltmin += MESH_EPSILON;
+    }
+
+    /* Shear along the major axis of the ray, keeping the winding */
+    ray.mesh = mesh;
+    ray.skip = skip;
+    ray.kz   = fabs(dir[0]) > fabs(dir[1]) ? 0 : 1;
+    ray.kz   = fabs(dir[2]) > fabs(dir[ray.kz]) ? 2 : ray.kz;
+    ray.kx   = (ray.kz + 1) % VEC_SIZE;
+    ray.ky   = (ray.kx + 1) % VEC_SIZE;
+
+    if (dir[ray.kz] < 0.0) {
+        swap   = ray.kx;
+        ray.kx = ray.ky;
+        ray.ky = swap;
+    }
+
+    ray.sx = dir[ray.kx] / dir[ray.kz];
+    ray.sy = dir[ray.ky] / dir[ray.kz];
+    ray.sz = 1.0 / dir[ray.kz];
+
+    hit = bvh_trace(mesh->bvh, lbase, dir, ltmin, &ltmax, tri_test, &ray, 0);
+
+    /* Keep the triangle hit, for mesh_surface */
+    if (hit < 0) {
+        return MISS;
+    }
+
+    mesh->cand = hit;
+
+    return ltmax * mesh->scale;
+}
+
+/*
+ * mesh_init:  Allocates memory for, initializes, and returns a new mesh.  A
+ *             mesh gives the name of its OBJ file, the translation, and the
+ *             scale.  A relative name is found as model_path describes.
+ *
+ * Parameters: in      - The file containing the mesh specifications.
+ *             objtype - Represents the type of object to initialize.
+ *
+ * Return:     A pointer to the newly initialized mesh.
+ */
+obj_t *mesh_init(FILE *in, int objtype) {
+    obj_t  *obj = object_init(in, objtype);         /* The mesh object   */
+    mesh_t *new = (mesh_t *)Malloc(sizeof(mesh_t)); /* The new mesh      */
+    char   path[2 * BUF_SIZE];                      /* The OBJ file path */
+    FILE   *file;                                   /* The OBJ file      */
+
+    /* Link the mesh to the object structure */
+    obj->priv    = new;
+    obj->hits    = hits_mesh;
+    obj->rehits  = rehits_mesh;
+    obj->surface = mesh_surface;
+    obj->bounds  = mesh_bounds;
+    obj->move    = mesh_move;
+    obj->destroy = mesh_destroy;
+    obj->dump    = mesh_dump;
+
+    new->cand  = -1;
+    new->hit   = -1;
+    new->verts = NULL;
+    new->tris  = NULL;
+    new->bvh   = NULL;
+
+    /* Read in the OBJ file name */
+    model_path(in, new->name, path);
+
+    /* Read in the translation and scale and check for errors */
+    if (vec_get3(in, new->offset) != VEC_SIZE) {
+        msg_exit(stderr, "mesh_init: error: invalid read count");
+    }
+
+    consume_line(in);
+
+    if (vec_get1(in, &new->scale) != 1 || new->scale <= 0.0) {
+        msg_exit(stderr, "mesh_init: error: invalid scale");
+    }
+
+    consume_line(in);
+
+    if ((file = fopen(path, "r")) == NULL) {
+        msg_exit(stderr, "mesh_init: error: cannot open OBJ file");
+    }
+
+    mesh_read(new, file);
+    fclose(file);
+
+    new->bvh  = bvh_tree(new->num_tris, tri_box, new);
+    new->hash = (hash_text((char *)new->verts,
+                           new->num_verts * VEC_SIZE * sizeof(float)) * 31) ^
+                hash_text((char *)new->tris,
+                          new->num_tris * VEC_SIZE * sizeof(int));
+
+    return obj;
+}
+
+/*
+ * mesh_dump:  Dumps the contents of the mesh object to the specified output
+ *             file.  The hash of the vertices and faces is included, so
+ *             that editing the OBJ file changes the dump.
+ *
+ * Parameters: out - The file to which the mesh object will be dumped.
+ *             obj - The mesh object to dump.
+ *
+ * Return:     EXIT_SUCCESS if successful, EXIT_FAILURE otherwise.
+ */
+int mesh_dump(FILE *out, obj_t *obj) {
+    mesh_t *mesh = (mesh_t *)obj->priv; /* The mesh object to dump */
+
+    fprintf(out, "Dumping object of type Mesh\n");
+
+    /* Print out the object reflectivity information */
+    material_dump(out, &obj->material);
+
+    /* Print out the mesh information */
+    fprintf(out, "\nMesh data\n");
+    fprintf(out, "file - \n%s\n", mesh->name);
+    vec_prn3(out, "offset - ", mesh->offset);
+    vec_prn1(out, "scale - ", &mesh->scale);
+    ivec_prn1(out, "vertices - ", &mesh->num_verts);
+    ivec_prn1(out, "triangles - ", &mesh->num_tris);
+    fprintf(out, "mesh hash - \n%016lx\n", mesh->hash);
+
+    return EXIT_SUCCESS;
+}
+
+/*
+ * hits_mesh:  Determines if a ray hits a mesh object, returning the distance
+ *             to the closest triangle.
+ *
+ * Parameters: base - The base location of the ray.
+ *             dir  - The unit vector direction of the ray.
+ *             tmin - Hits at or before this distance are misses.
+ *             tmax - Hits at or beyond this distance are misses.
+ *             obj  - The mesh object to test.
+ *
+ * Return:     The distance to the hit location, or MISS.
+ */
+double hits_mesh(double *base, double *dir, double tmin, double tmax,
+                 obj_t *obj) {
+    return trace_mesh(base, dir, tmin, tmax, obj, -1);
+}
+
+/*
+ * rehits_mesh: Determines if a ray leaving a mesh object hits another of
+ *              its triangles, such as a shadow ray blocked by another part
+ *              of the same model.
+ *
+ * Parameters:  base - The base location of the ray.
+ *              dir  - The unit vector direction of the ray.
+ *              tmin - Hits at or before this distance are misses.
+ *              tmax - Hits at or beyond this distance are misses.
+ *              obj  - The mesh object the ray leaves.
+ *
+ * Return:      The distance to the hit location, or MISS.
+ */
+double rehits_mesh(double *base, double *dir, double tmin, double tmax,
+                   obj_t *obj) {
+    return trace_mesh(base, dir, tmin, tmax, obj,
+                      ((mesh_t *)obj->priv)->hit);
+}
+
+/*
+ * mesh_surface: Computes the hit location and normal of a ray that hit a
+ *               mesh object.  The normal is that of the flat triangle,
+ *               turned to face the ray, since the faces of an OBJ file are
+ *               not always wound the same way.
+ *
+ * Parameters:   base - The base location of the ray.
+ *               dir  - The unit vector direction of the ray.
+ *               dist - The distance returned by hits_mesh.
+ *               obj  - The mesh object that was hit.
+ */
+void mesh_surface(double *base, double *dir, double dist, obj_t *obj) {
+    mesh_t *mesh = (mesh_t *)obj->priv; /* The mesh object       */
+    double edge[2][VEC_SIZE];           /* Edges of the triangle */
+    double normal[VEC_SIZE];            /* The triangle normal   */
+    float  *vert[VEC_SIZE];             /* Its vertices          */
+    int    i;                           /* Corner index          */
+    int    j;                           /* Axis index            */
+
+    mesh->hit = mesh->cand;
+
+    for (i = 0; i < VEC_SIZE; ++i) {
+        vert[i] = mesh->verts + mesh->tris[mesh->hit * VEC_SIZE + i] *
+                                VEC_SIZE;
+    }
+
+    for (i = 0; i < 2; ++i) {
+        for (j = 0; j < VEC_SIZE; ++j) {
+            edge[i][j] = vert[i + 1][j] - vert[0][j];
+        }
+    }
+
+    /* Save the hit location */
+    vec_scale3(dist, dir, obj->hitloc);
+    vec_sum3(base, obj->hitloc, obj->hitloc);
+
+    /* Save the unit normal, facing the ray */
+    vec_cross3(edge[0], edge[1], normal);
+    vec_unit3(normal, obj->normal);
+
+    if (vec_dot3(obj->normal, dir) > 0.0) {
+        vec_scale3(-1.0, obj->normal, obj->normal);
+    }
+}
+
+/*
+ * mesh_bounds: Finds the bounding box of a mesh object.
+ *
+ * Parameters:  obj - The mesh object.
+ *              lo  - Storage for the low corner of the box.
+ *              hi  - Storage for the high corner of the box.
+ *
+ * Return:      Nonzero, since a mesh is bounded.
+ */
+int mesh_bounds(obj_t *obj, double *lo, double *hi) {
+    mesh_t *mesh = (mesh_t *)obj->priv; /* The mesh object */
+    int    j;                           /* Axis index      */
+
+    bvh_bounds(mesh->bvh, lo, hi);
+
+    for (j = 0; j < VEC_SIZE; ++j) {
+        lo[j] = lo[j] * mesh->scale + mesh->offset[j];
+        hi[j] = hi[j] * mesh->scale + mesh->offset[j];
+    }
+
+    return 1;
+}
+
+/*
+ * mesh_move:  Translates the specified mesh object by an offset.
+ *
+ * Parameters: obj    - The mesh object to move.
+ *             offset - The translation (x, y, z).
+ */
+void mesh_move(obj_t *obj, double *offset) {
+    mesh_t *mesh = (mesh_t *)obj->priv; /* The mesh to move */
+
+    vec_sum3(mesh->offset, offset, mesh->offset);
+}
+
+/*
+ * mesh_destroy: Destroys the specified mesh object.
+ *
+ * Parameters:   obj - The mesh object to destroy.
+ */
+void mesh_destroy(obj_t *obj) {
+    mesh_t *mesh = (mesh_t *)obj->priv; /* The mesh to destroy */
+
+    bvh_destroy(mesh->bvh);
+    Free(mesh->verts);
+    Free(mesh->tris);
+    Free(mesh);
+}
@@ -0,0 +1,62 @@
+/*
+ * mesh.h:  This header file contains the implementation specifications for
+ *          a triangle mesh, read from a Wavefront OBJ file.
+ *
+ * Author:  Scott Gigawatt
+ *
+ * Version: 18 October 2026
+ */
+
+#ifndef MESH_H
+#define MESH_H
+
+#include "object.h"
+#include "bvh.h"
+
+/* The distance a ray leaving a mesh travels before it can hit it again */
+#ifndef MESH_EPSILON
+    #define MESH_EPSILON 1e-6
+#endif
+
+/* Triangle mesh */
+typedef struct mesh_type {
+    char          name[BUF_SIZE];   /* The OBJ file name, as given         */
+    double        offset[VEC_SIZE]; /* The translation (x, y, z)           */
+    double        scale;            /* The uniform scale                   */
+    float         *verts;           /* The vertices (x, y, z), in the file */
+    int           num_verts;        /* The number of vertices              */
+    int           *tris;            /* The vertices of each triangle       */
+    int           num_tris;         /* The number of triangles             */
+    bvh_t         *bvh;             /* The hierarchy over the triangles    */
+    unsigned long hash;             /* The hash of the vertices and faces  */
+    int           cand;             /* Triangle hit by the last test       */
+    int           hit;              /* Triangle of the closest hit         */
+} mesh_t;
+
+/* Allocates memory for, initializes, and returns a new mesh */
+obj_t *mesh_init(FILE *in, int objtype);
+
+/* Dumps the contents of the mesh object to the specified file */
+int mesh_dump(FILE *out, obj_t *obj);
+
+/* Determines if a ray hits a mesh object */
+double hits_mesh(double *base, double *dir, double tmin, double tmax,
+                 obj_t *obj);
+
+/* Determines if a ray leaving a mesh object hits it again */
+double rehits_mesh(double *base, double *dir, double tmin, double tmax,
+                   obj_t *obj);
+
+/* Computes the hit location and normal of a ray that hit a mesh object */
+void mesh_surface(double *base, double *dir, double dist, obj_t *obj);
+
+/* Finds the bounding box of a mesh object */
+int mesh_bounds(obj_t *obj, double *lo, double *hi);
+
+/* Translates the specified mesh object by an offset */
+void mesh_move(obj_t *obj, double *offset);
+
+/* Destroys the specified mesh object */
+void mesh_destroy(obj_t *obj);
+
+#endif
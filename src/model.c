@@ -10,34 +10,50 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "model.h"
+#include "mem.h"
 #include "light.h"
+#include "spotlight.h"
+#include "arealight.h"
 #include "sphere.h"
 #include "psphere.h"
+#include "refsphere.h"
 #include "plane.h"
 #include "pplane.h"
 #include "tplane.h"
 #include "fplane.h"
+#include "texplane.h"
+#include "instance.h"
+#include "mesh.h"
+#include "quadric.h"
+#include "bvh.h"
+#include "lighttree.h"
+#include "lightmap.h"
 
 /* Dummy initialization function for unimplemented objects */
 obj_t *dummy_init(FILE *in, int objtype){ return NULL; }
 
 /* Table of function pointers for object initialization */
 static obj_t *(*obj_loaders[])(FILE *in, int objtype) = {
-    light_init,   /* Placeholder for a light object             (type 10) */
-    dummy_init,   /* Placeholder for a spotlight object         (type 11) */
-    dummy_init,   /* Placeholder for a projector object         (type 12) */
-    sphere_init,  /* Placeholder for a sphere object            (type 13) */
-    plane_init,   /* Placeholder for a plane object             (type 14) */
-    fplane_init,  /* Placeholder for a finite plane object      (type 15) */
-    tplane_init,  /* Placeholder for a tiled plane object       (type 16) */
-    dummy_init,   /* Placeholder for a textured plane object    (type 17) */
-    dummy_init,   /* Placeholder for a ref sphere object        (type 18) */
-    psphere_init, /* Placeholder for a procedural sphere object (type 19) */
-    pplane_init,  /* Placeholder for a procedural plane object  (type 20) */
-    dummy_init,   /* Placeholder for a paraboloid object        (type 21) */
-    dummy_init,   /* Placeholder for a cylinder object          (type 22) */
-    dummy_init,   /* Placeholder for a cone object              (type 23) */
-    dummy_init    /* Placeholder for a hyperboloid object       (type 24) */
+    light_init,     /* Placeholder for a light object             (type 10) */
+    spotlight_init, /* Placeholder for a spotlight object         (type 11) */
+    dummy_init,     /* Placeholder for a projector object         (type 12) */
+    sphere_init,    /* Placeholder for a sphere object            (type 13) */
+    plane_init,     /* Placeholder for a plane object             (type 14) */
+    fplane_init,    /* Placeholder for a finite plane object      (type 15) */
+    tplane_init,    /* Placeholder for a tiled plane object       (type 16) */
+    texplane_init,  /* Placeholder for a textured plane object    (type 17) */
+    refsphere_init, /* Placeholder for a ref sphere object        (type 18) */
+    psphere_init,   /* Placeholder for a procedural sphere object (type 19) */
+    pplane_init,    /* Placeholder for a procedural plane object  (type 20) */
+    quadric_init,   /* Placeholder for a paraboloid object        (type 21) */
+    quadric_init,   /* Placeholder for a cylinder object          (type 22) */
+    quadric_init,   /* Placeholder for a cone object              (type 23) */
+    quadric_init,   /* Placeholder for a hyperboloid object       (type 24) */
+    prototype_init, /* Placeholder for a prototype object         (type 25) */
+    instance_init,  /* Placeholder for an instance object         (type 26) */
+    mesh_init,      /* Placeholder for a triangle mesh object     (type 27) */
+    arealight_init, /* Placeholder for a rectangular light object (type 28) */
+    arealight_init  /* Placeholder for a spherical light object   (type 29) */
 };
 
 /* 
@@ -52,22 +68,19 @@ int model_init(FILE *in, model_t *model) {
     obj_t *new = NULL; /* A Pointer to the newly created object */
     int   obj_type;    /* The object type read from the model   */
 
+    /* Rays are not recorded unless a renderer asks for them */
+    model->deps = NULL;
+
     /* Read in the world scene information */
     while ( ivec_get1(in, &obj_type) == 1 ) {
         consume_line(in);
 
         /* Initialize the appropriate object type */
         if ( (obj_type >= FIRST_TYPE) && (obj_type <= LAST_TYPE) ) {
-            /* Initialize object from object loader function table */
-            new = (*obj_loaders[obj_type - FIRST_TYPE])(in, obj_type);
-
-            /* Check for successful object initialization */
-            if (new == NULL) {
-                msg_exit(stderr, "model_init: error: initialization failed");
-            }
+            new = model_object(in, obj_type);
 
             /* Add new object to appropriate scene list */
-            if (obj_type == LIGHT) {
+            if (model_is_light(obj_type)) {
                 list_add(model->lights, new);
             } else {
                 list_add(model->scene, new);
@@ -75,9 +88,240 @@ int model_init(FILE *in, model_t *model) {
         }
     }
 
+    /* Build the traversal array from the scene list */
+    model_flatten(model);
+
     return EXIT_SUCCESS;
 }
 
+/*
+ * model_object: Reads one object of the specified type from the specified
+ *               file, through the object loader function table.
+ *
+ * Parameters:   in      - The file from which the object will be read.
+ *               objtype - The object type, already read from the file.
+ *
+ * Return:       A pointer to the new object.
+ */
+obj_t *model_object(FILE *in, int objtype) {
+    obj_t *new = NULL; /* A Pointer to the newly created object */
+
+    if ( (objtype < FIRST_TYPE) || (objtype > LAST_TYPE) ) {
+        msg_exit(stderr, "model_object: error: invalid object type");
+    }
+
+    /* Initialize object from object loader function table */
+    new = (*obj_loaders[objtype - FIRST_TYPE])(in, objtype);
+
+    /* Check for successful object initialization */
+    if (new == NULL) {
+        msg_exit(stderr, "model_init: error: initialization failed");
+    }
+
+    /* The caller now owns the object */
+    object_done();
+
+    return new;
+}
+
+/*
+ * model_load: Allocates and reads a model from the specified file.
+ *
+ * Parameters: in     - The file from which the model will be read.
+ *             opts   - The rendering options (owned by the model).
+ *             width  - The window width in pixels (x).
+ *             height - The window height in pixels (y).
+ *
+ * Return:     A pointer to the new model.
+ */
+model_t *model_load(FILE *in, opts_t *opts, int width, int height) {
+    model_t *model = (model_t *)Malloc(sizeof(model_t)); /* The new model */
+
+    model->opts   = opts;
+    model->proj   = projection_read(in, width, height);
+    model->lights = list_init();
+    model->scene  = list_init();
+    model->insts  = NULL;
+    model->ltree  = NULL;
+    model->ltab   = NULL;
+
+    model_init(in, model);
+
+    return model;
+}
+
+/*
+ * model_flatten: Flattens the scene list into the array of objects that is
+ *                traversed by each ray, keeping the scene order, and builds
+ *                the hierarchy over the instances.
+ *
+ * Parameters:    model - The model whose scene will be flattened.
+ */
+void model_flatten(model_t *model) {
+    link_t *cursor = NULL; /* Cursor into the scene list */
+    obj_t  *obj    = NULL; /* The current object         */
+    int    count   = 0;    /* The number of objects      */
+
+    /* Count the objects in the scene */
+    for (cursor = model->scene->head; cursor; cursor = cursor->next) {
+        ++count;
+    }
+
+    /* Copy the objects into the traversal array */
+    model->objs     = (obj_t **)Malloc((count + 1) * sizeof(obj_t *));
+    model->num_objs = 0;
+
+    /* Prototypes are not drawn, and instances are traced by model_accel */
+    for (cursor = model->scene->head; cursor; cursor = cursor->next) {
+        obj = (obj_t *)cursor->item;
+
+        if (obj->objtype != PROTOTYPE && obj->objtype != INSTANCE) {
+            model->objs[model->num_objs++] = obj;
+        }
+    }
+
+    model_accel(model, ACCEL_ALL);
+}
+
+/*
+ * accel_insts: Binds every instance to its prototype and builds the top
+ *              level of the hierarchy over the instances.
+ *
+ * Parameters:  model - The model.
+ */
+static void accel_insts(model_t *model) {
+    obj_t  **protos = NULL; /* The prototypes, in file order */
+    obj_t  **insts  = NULL; /* The instances                 */
+    link_t *cursor  = NULL; /* Cursor into the scene list    */
+    obj_t  *obj     = NULL; /* The current object            */
+    int    count    = 0;    /* The number of objects         */
+    int    num[2]   = {0};  /* Prototypes and instances      */
+    int    i;               /* Instance index                */
+
+    for (cursor = model->scene->head; cursor; cursor = cursor->next) {
+        ++count;
+    }
+
+    protos = (obj_t **)Malloc((count + 1) * sizeof(obj_t *));
+    insts  = (obj_t **)Malloc((count + 1) * sizeof(obj_t *));
+
+    for (cursor = model->scene->head; cursor; cursor = cursor->next) {
+        obj = (obj_t *)cursor->item;
+
+        if (obj->objtype == PROTOTYPE) {
+            protos[num[0]++] = obj;
+        } else if (obj->objtype == INSTANCE) {
+            insts[num[1]++] = obj;
+        }
+    }
+
+    for (i = 0; i < num[1]; ++i) {
+        if (instance_bind(insts[i], protos, num[0])) {
+            /* The library may carry on after the error */
+            Free(protos);
+            Free(insts);
+            msg_exit(stderr, "model_accel: error: no such prototype");
+        }
+    }
+
+    bvh_destroy(model->insts);
+    model->insts = num[1] > 0 ? bvh_build(insts, num[1]) : NULL;
+
+    Free(protos);
+    Free(insts);
+}
+
+/*
+ * model_accel: Builds the parts of the model that depend on where things
+ *              are: the hierarchy over the instances, which must be built
+ *              again whenever an instance or a prototype moves, the light
+ *              tree and table, whenever a light moves, and the lightmaps of
+ *              the planes, whenever anything that lights or shades them
+ *              moves (see lightmap_shades for single planes).
+ *
+ * Parameters:  model - The model.
+ *              parts - The parts to build (ACCEL_INSTS, ...).
+ */
+void model_accel(model_t *model, int parts) {
+    if (parts & ACCEL_INSTS) {
+        accel_insts(model);
+    }
+
+    if (parts & ACCEL_LIGHTS) {
+        lighttree_destroy(model->ltree);
+        light_table_destroy(model->ltab);
+        model->ltree = lighttree_build(model->lights);
+        model->ltab  = light_table(model->lights);
+    }
+
+    /* The light on the planes, once everything else is in place */
+    if (parts & ACCEL_MAPS) {
+        lightmap_bake(model);
+    }
+}
+
+/*
+ * model_is_light: Determines whether the specified type of object is a
+ *                 light, which is kept in the model's list of lights.
+ *
+ * Parameters:     objtype - The type of object.
+ *
+ * Return:         Nonzero if the type is a light, zero otherwise.
+ */
+int model_is_light(int objtype) {
+    return objtype == LIGHT || objtype == SPOTLIGHT ||
+           objtype == AREA_LIGHT || objtype == SPHERE_LIGHT;
+}
+
+/*
+ * obj_is_plane: Determines whether the specified object is an unbounded
+ *               plane, which is likely to be hit by many rays.
+ *
+ * Parameters:   obj - The object to check.
+ *
+ * Return:       Nonzero if the object is an unbounded plane, zero otherwise.
+ */
+static int obj_is_plane(obj_t *obj) {
+    return obj->objtype == PLANE || obj->objtype == TILED_PLANE ||
+                                    obj->objtype == P_PLANE;
+}
+
+/*
+ * obj_compare: Compares two objects for the traversal order, putting the
+ *              most frequently hit objects first, then unbounded planes,
+ *              then the remaining objects in scene order.
+ *
+ * Parameters:  a - A pointer to the first object pointer.
+ *              b - A pointer to the second object pointer.
+ *
+ * Return:      Negative if a comes first, positive if b comes first.
+ */
+static int obj_compare(const void *a, const void *b) {
+    obj_t *obj1 = *(obj_t **)a; /* The first object  */
+    obj_t *obj2 = *(obj_t **)b; /* The second object */
+
+    if (obj1->nhits != obj2->nhits) {
+        return obj1->nhits > obj2->nhits ? -1 : 1;
+    }
+
+    if (obj_is_plane(obj1) != obj_is_plane(obj2)) {
+        return obj_is_plane(obj1) ? -1 : 1;
+    }
+
+    return obj1->objid - obj2->objid;
+}
+
+/*
+ * model_reorder: Orders the traversal array by the number of times each
+ *                object was the closest hit, so the objects most likely to
+ *                produce a tight minimum distance are tested first.
+ *
+ * Parameters:    model - The model whose traversal array will be ordered.
+ */
+void model_reorder(model_t *model) {
+    qsort(model->objs, model->num_objs, sizeof(obj_t *), obj_compare);
+}
+
 /* 
  * model_dump: Dumps the model information to the specified file.
  *
@@ -96,6 +340,53 @@ int model_dump(FILE* out, model_t *model) {
     return EXIT_SUCCESS;
 }
 
+/*
+ * model_hash: Computes a hash of the projection and every object of the
+ *             model, which identifies the scene being rendered.
+ *
+ * Parameters: model - The model to hash.
+ *
+ * Return:     The hash of the model.
+ */
+unsigned long model_hash(model_t *model) {
+    char          *text = NULL; /* The model dump         */
+    size_t        size  = 0;    /* The length of the dump */
+    unsigned long hash;         /* The hash of the dump   */
+    FILE          *out;         /* The dump stream        */
+
+    if ((out = open_memstream(&text, &size)) == NULL) {
+        msg_exit(stderr, "model_hash: error: cannot dump model");
+    }
+
+    projection_dump(out, model->proj);
+    model_dump(out, model);
+    fclose(out);
+
+    hash = hash_text(text, size);
+    free(text);
+
+    return hash;
+}
+
+/*
+ * hash_text:  Computes the 64-bit FNV-1a hash of the specified text.
+ *
+ * Parameters: text - The text to hash.
+ *             size - The length of the text.
+ *
+ * Return:     The hash of the text.
+ */
+unsigned long hash_text(char *text, size_t size) {
+    unsigned long long hash = 0xcbf29ce484222325ull; /* The hash value  */
+    size_t             i;                            /* Character index */
+
+    for (i = 0; i < size; ++i) {
+        hash = (hash ^ (unsigned char)text[i]) * 0x100000001b3ull;
+    }
+
+    return (unsigned long)hash;
+}
+
 /* 
  * objlist_dump: Dumps the list of objects to the specified file.
  *
@@ -112,7 +403,7 @@ void objlist_dump(FILE* out, list_t *scene) {
         for (cursor = scene->head; cursor; cursor = cursor->next) {
             /* Get the current object */
             obj = (obj_t *)cursor->item;
-            obj->dump(stderr, obj);
+            obj->dump(out, obj);
         }
     }
 }
@@ -128,3 +419,30 @@ void consume_line(FILE *in) {
     /* Consume one line from the file */
     fgets(junk, BUF_SIZE, in);
 }
+
+/*
+ * model_path: Reads the first word of the next line of the specified file
+ *             that has one, naming a data file such as a mesh or a texture,
+ *             and finds the file.  A relative name is found in the directory
+ *             named by DATA_DIR_ENV, if it is set, or the current directory.
+ *
+ * Parameters: in   - The file from which the name is read.
+ *             name - Storage for the name, as given (BUF_SIZE characters).
+ *             path - Storage for the path (2 * BUF_SIZE characters).
+ */
+void model_path(FILE *in, char *name, char *path) {
+    char line[BUF_SIZE];             /* A line of input   */
+    char *dir = getenv(DATA_DIR_ENV); /* The data directory */
+
+    do {
+        if (fgets(line, BUF_SIZE, in) == NULL) {
+            msg_exit(stderr, "model_path: error: invalid read count");
+        }
+    } while (sscanf(line, "%s", name) != 1);
+
+    if (name[0] != '/' && dir && *dir) {
+        snprintf(path, 2 * BUF_SIZE, "%s/%s", dir, name);
+    } else {
+        snprintf(path, 2 * BUF_SIZE, "%s", name);
+    }
+}
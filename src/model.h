@@ -32,35 +32,89 @@
 #define CYLINDER     22
 #define CONE         23
 #define HYPERBOLOID  24
-#define LAST_TYPE    25
+#define PROTOTYPE    25
+#define INSTANCE     26
+#define MESH         27
+#define AREA_LIGHT   28
+#define SPHERE_LIGHT 29
+#define LAST_TYPE    29
 #define LAST_LIGHT   12
 #define TEX_FIT      1
 #define TEX_TILE     2
 #define MISS        -1 
 #define MAX_DIST     20
 
+/* The environment variable naming the directory of relative data files */
+#define DATA_DIR_ENV "RT_DATA_DIR"
+
 #include <stdlib.h>
 #include "list.h"
 #include "object.h"
+#include "options.h"
 #include "projection.h"
 
+/* Only every REORDER_STEP-th pixel is traced by the hit profiling pre-pass */
+#ifndef REORDER_STEP
+    #define REORDER_STEP 8
+#endif
+
+/* The parts of the model built by model_accel */
+#define ACCEL_INSTS  1 /* The hierarchy over the instances */
+#define ACCEL_LIGHTS 2 /* The light tree and table         */
+#define ACCEL_MAPS   4 /* The lightmaps of the planes      */
+#define ACCEL_ALL    7 /* Every part                       */
+
 /* A structure to contain the model information */
 typedef struct model_type {
-    proj_t *proj;   /* The projection information */
-    list_t *lights; /* The lights in the scene    */
-    list_t *scene;  /* The scene information      */
+    proj_t                  *proj;    /* The projection information           */
+    opts_t                  *opts;    /* The rendering options                */
+    list_t                  *lights;  /* The lights in the scene              */
+    list_t                  *scene;   /* The scene information                */
+    struct obj_type         **objs;   /* The scene flattened for traversal    */
+    int                     num_objs; /* The number of objects in the scene   */
+    struct bvh_type         *insts;   /* The instances for traversal, or NULL */
+    struct lighttree_type   *ltree;   /* The lights for sampling, or NULL     */
+    struct light_table_type *ltab;    /* The lights for shading, or NULL      */
+    struct deps_type        *deps;    /* Records the traced rays, or NULL     */
 } model_t;
 
 /* Read the model information from the specified file */
 int model_init(FILE *in, model_t *model);
 
+/* Determines whether the specified type of object is a light */
+int model_is_light(int objtype);
+
+/* Reads one object of the specified type from the specified file */
+struct obj_type *model_object(FILE *in, int objtype);
+
+/* Allocates and reads a model from the specified file */
+model_t *model_load(FILE *in, opts_t *opts, int width, int height);
+
 /* Dumps the model information to the specified file */
 int model_dump(FILE* out, model_t *model);
 
+/* Flattens the scene list into the traversal array */
+void model_flatten(model_t *model);
+
+/* Builds the instance hierarchy, light tree and table, and lightmaps */
+void model_accel(model_t *model, int parts);
+
+/* Orders the traversal array by descending hit count */
+void model_reorder(model_t *model);
+
+/* Computes a hash identifying the scene of the model */
+unsigned long model_hash(model_t *model);
+
+/* Computes the 64-bit FNV-1a hash of the specified text */
+unsigned long hash_text(char *text, size_t size);
+
 /* Dumps the list of objects to the specified file */
 void objlist_dump(FILE* out, list_t *scene);
 
 /* Consumes a line from the specified file */
 void consume_line(FILE *in);
 
+/* Reads the name of a data file, such as a mesh or texture, and finds it */
+void model_path(FILE *in, char *name, char *path);
+
 #endif
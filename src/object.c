@@ -7,10 +7,18 @@
  * Version:  22 March 2011
  */
 
+#include <string.h>
 #include "object.h"
 #include "light.h"
 #include "mem.h"
 
+/* The id of the next object */
+static int next_id = 0;
+
+/* The objects being read, innermost last, so that an error can free them */
+static obj_t *reading[OBJ_NESTING];
+static int   num_reading = 0;
+
 /* 
  * object_init: Allocates memory for, initializes, and returns a new object.
  *
@@ -20,21 +28,126 @@
  * Return:      A pointer to the newly initialized object.
  */
 obj_t *object_init(FILE *in, int objtype) {
-    obj_t      *obj  = (obj_t *)Malloc(sizeof(obj_t)); /* The new object    */
-    static int objid = 0;                              /* Unique identifier */
+    obj_t *obj = (obj_t *)Malloc(sizeof(obj_t)); /* The new object */
+
+    if (num_reading == OBJ_NESTING) {
+        Free(obj);
+        msg_exit(stderr, "object_init: error: objects nested too deeply");
+    }
+
+    /* Until it is read, the object can be destroyed if an error occurs */
+    reading[num_reading++] = obj;
 
     /* Set the object type, id, and light fields */
     obj->objtype  = objtype;
-    obj->objid    = objid++;
+    obj->objid    = next_id++;
+    obj->priv     = NULL;
+    obj->nhits    = 0;
+    obj->rehits   = NULL;
+    obj->bounds   = object_unbounded;
     obj->getamb   = default_getamb;
     obj->getdiff  = default_getdiff;
     obj->getspec  = default_getspec;
+    obj->gettrans = default_gettrans;
     obj->getemiss = default_getemiss;
+    obj->destroy  = object_bare;
+    obj->lightmap = NULL;
 
-    /* If the object is not a light, initialize the reflectivity materials */
-    if (objtype != LIGHT) {
+    /* Lights, prototypes, and instances have no reflectivity materials */
+    if (!model_is_light(objtype) && objtype != PROTOTYPE &&
+                                    objtype != INSTANCE) {
         material_init(in, &obj->material);
+    } else {
+        memset(&obj->material, 0, sizeof(material_t));
     }
 
     return obj;
 }
+
+/*
+ * object_done: Marks the most recently initialized object as read, leaving
+ *              it to whoever asked for it to destroy.
+ */
+void object_done(void) {
+    if (num_reading > 0) {
+        --num_reading;
+    }
+}
+
+/*
+ * object_abandon: Destroys the objects whose reading was cut short by an
+ *                 error, innermost first.  A trap set around the reading
+ *                 of a model (see msg_trap) calls this, since the objects
+ *                 are not yet in the model for dalloc to destroy.
+ */
+void object_abandon(void) {
+    obj_t *obj; /* The object to destroy */
+
+    while (num_reading > 0) {
+        obj = reading[--num_reading];
+        obj->destroy(obj);
+        Free(obj);
+    }
+}
+
+/*
+ * object_ids: Sets the id of the next object, so that the members of a
+ *             prototype can be numbered apart from the objects of the scene.
+ *
+ * Parameters: next - The id of the next object.
+ *
+ * Return:     The id the next object would have had.
+ */
+int object_ids(int next) {
+    int prev = next_id; /* The replaced id */
+
+    next_id = next;
+
+    return prev;
+}
+
+/*
+ * object_unbounded: The bounds function of objects without a bounding box,
+ *                   such as infinite planes.
+ *
+ * Parameters:       obj - The object.
+ *                   lo  - Unused.
+ *                   hi  - Unused.
+ *
+ * Return:           Zero, since the object is unbounded.
+ */
+int object_unbounded(obj_t *obj, double *lo, double *hi) {
+    return 0;
+}
+
+/*
+ * object_bare: The destroy function of objects without private data, which
+ *              is every object until its type gives it some.
+ *
+ * Parameters:  obj - Unused.
+ */
+void object_bare(obj_t *obj) {
+}
+
+/*
+ * object_hits: Tests a ray against an object.  A ray leaving the object is
+ *              tested with its rehits function, which skips only the part of
+ *              the object the ray leaves, or not at all if it has none.
+ *
+ * Parameters:  obj  - The object to test.
+ *              base - The base location of the ray.
+ *              dir  - The unit vector direction of the ray.
+ *              tmin - Hits at or before this distance are misses.
+ *              tmax - Hits at or beyond this distance are misses.
+ *              skip - The object the ray leaves, or NULL.
+ *
+ * Return:      The distance to the hit location, or MISS.
+ */
+double object_hits(obj_t *obj, double *base, double *dir, double tmin,
+                   double tmax, obj_t *skip) {
+    if (obj != skip) {
+        return obj->hits(base, dir, tmin, tmax, obj);
+    }
+
+    return obj->rehits ? obj->rehits(base, dir, tmin, tmax, obj) : MISS;
+}
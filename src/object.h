@@ -12,6 +12,11 @@
 
 #define MISS -1
 
+/* The objects that can be read at once, such as a prototype and a member */
+#ifndef OBJ_NESTING
+    #define OBJ_NESTING 2
+#endif
+
 #include "material.h"
 #include "model.h"
 #include "veclib3d.h"
@@ -24,14 +29,34 @@ typedef struct obj_type {
     int    objtype;              /* Type code (14 -> Plane)     */
     void   *priv;                /* Private type-dependent data */
 
-    /* Hits function */
-    double (*hits)(double *base, double *dir, struct obj_type *);
+    /* Hits function (only hits between tmin and tmax are reported) */
+    double (*hits)(double *base, double *dir, double tmin, double tmax,
+                   struct obj_type *);
+
+    /* Computes hitloc and normal, called only for the closest hit */
+    void (*surface)(double *base, double *dir, double dist,
+                    struct obj_type *);
+
+    /* Hits function for a ray leaving the object's last hit (NULL if the
+       object cannot hit itself), used for groups of objects like instances */
+    double (*rehits)(double *base, double *dir, double tmin, double tmax,
+                     struct obj_type *);
+
+    /* Finds the bounding box (lo, hi), returning zero if it is unbounded */
+    int (*bounds)(struct obj_type *, double *lo, double *hi);
+
+    /* Number of times the object was the closest hit (for ordering) */
+    long   nhits;
 
     /* Plugins for retrieval of reflectivity (e.g. tiled floor) */
     void (*getamb) (struct obj_type *, double *);
     void (*getdiff)(struct obj_type *, double *);
     void (*getspec)(struct obj_type *, double *);
 
+    /* Retrieves the transmission (r, g, b) of the surface, returning the
+       index of refraction within it (0 for an opaque object) */
+    double (*gettrans)(struct obj_type *, double *);
+
     /* Reflectivity for reflective objects */
     material_t material;
 
@@ -41,6 +66,12 @@ typedef struct obj_type {
     double hitloc[VEC_SIZE];     /* Last hit point      */
     double normal[VEC_SIZE];     /* Normal at hit point */
 
+    /* The light baked over the surface, or NULL (see lightmap.c) */
+    struct lightmap_type *lightmap;
+
+    /* Translates the object by an offset (x, y, z), for animation */
+    void (*move)(struct obj_type *, double *offset);
+
     /* For memory management */
     void (*destroy)(struct obj_type *);
 
@@ -51,4 +82,23 @@ typedef struct obj_type {
 /* Allocates memory for, initializes, and returns a new object */
 obj_t *object_init(FILE *in, int objtype);
 
+/* Marks the most recently initialized object as read */
+void object_done(void);
+
+/* Destroys the objects whose reading was cut short by an error */
+void object_abandon(void);
+
+/* Sets the id of the next object, returning the id it replaces */
+int object_ids(int next);
+
+/* Bounds function of unbounded objects */
+int object_unbounded(obj_t *obj, double *lo, double *hi);
+
+/* Destroy function of objects without private data */
+void object_bare(obj_t *obj);
+
+/* Tests a ray against an object, which may be the object the ray leaves */
+double object_hits(obj_t *obj, double *base, double *dir, double tmin,
+                   double tmax, obj_t *skip);
+
 #endif
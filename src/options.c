@@ -0,0 +1,342 @@
+/*
+ * options.c: This file contains the implementation details for parsing the
+ *            command line rendering options.
+ *
+ * Author:    Scott Gigawatt
+ *
+ * Version:   18 October 2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "options.h"
+#include "mem.h"
+
+/*
+ * option_arg: Returns the value of an option that takes an argument,
+ *             advancing the argument index past it.
+ *
+ * Parameters: argc - The number of command line arguments.
+ *             argv - The command line arguments.
+ *             i    - A pointer to the index of the option.
+ *
+ * Return:     The option value.
+ */
+static char *option_arg(int argc, char **argv, int *i) {
+    if (*i + 1 >= argc) {
+        fprintf(stderr, "missing value for option: %s\n", argv[*i]);
+        msg_exit(stderr, "options_init: error: invalid option");
+    }
+
+    return argv[++*i];
+}
+
+/*
+ * option_vec: Reads the three values of an option that takes a vector,
+ *             advancing the argument index past them.
+ *
+ * Parameters: argc - The number of command line arguments.
+ *             argv - The command line arguments.
+ *             i    - A pointer to the index of the option.
+ *             vec  - Storage for the vector.
+ */
+static void option_vec(int argc, char **argv, int *i, double *vec) {
+    int j; /* Value index */
+
+    for (j = 0; j < 3; ++j) {
+        vec[j] = atof(option_arg(argc, argv, i));
+    }
+}
+
+/*
+ * output_ok:  Checks a frame file name pattern, which is passed to printf
+ *             with the frame number, so it must hold exactly one integer
+ *             conversion (%d with optional flags and width) and no other %
+ *             than %%.
+ *
+ * Parameters: pattern - The frame file name pattern.
+ *
+ * Return:     Nonzero if the pattern is safe to use, zero otherwise.
+ */
+static int output_ok(char *pattern) {
+    int count = 0; /* The number of %d conversions */
+
+    while ((pattern = strchr(pattern, '%')) != NULL) {
+        if (*++pattern == '%') {
+            ++pattern;
+            continue;
+        }
+
+        pattern += strspn(pattern, "-+ #0");
+        pattern += strspn(pattern, "0123456789");
+
+        if (*pattern++ != 'd') {
+            return 0;
+        }
+
+        ++count;
+    }
+
+    return count == 1;
+}
+
+/*
+ * options_init: Parses the rendering options from the command line.  Every
+ *               option is removed from the argument list, leaving only the
+ *               program name and the positional arguments in place.
+ *
+ * Parameters:   argc - A pointer to the number of command line arguments.
+ *               argv - The command line arguments.
+ *
+ * Return:       A pointer to the rendering options.
+ */
+opts_t *options_init(int *argc, char **argv) {
+    opts_t *opts = (opts_t *)Malloc(sizeof(opts_t)); /* The new options  */
+    int    kept  = 1;                                /* Positional count */
+    int    i;                                        /* Argument index   */
+    int    j;                                        /* Value index      */
+
+    /* Set the default options */
+    memset(opts, 0, sizeof(opts_t));
+    opts->output    = DEF_OUTPUT;
+    opts->up[1]     = 1.0;
+    opts->ckpt_secs = CKPT_SECS;
+
+    for (i = 1; i < *argc; ++i) {
+        /* Keep the positional arguments */
+        if (strncmp(argv[i], "--", 2)) {
+            argv[kept++] = argv[i];
+        /* Order objects by hit frequency */
+        } else if (!strcmp(argv[i], "--reorder")) {
+            opts->reorder = 1;
+        /* Render the frames of an animation */
+        } else if (!strcmp(argv[i], "--animate")) {
+            opts->animate = option_arg(*argc, argv, &i);
+        /* Name the animation frame files */
+        } else if (!strcmp(argv[i], "--output")) {
+            opts->output = option_arg(*argc, argv, &i);
+
+            if (!output_ok(opts->output)) {
+                msg_exit(stderr, "options_init: error: invalid output "
+                                 "pattern");
+            }
+        /* Take this many anti-aliasing samples per pixel */
+        } else if (!strcmp(argv[i], "--samples")) {
+            opts->samples = atoi(option_arg(*argc, argv, &i));
+
+            if (opts->samples < 1) {
+                msg_exit(stderr, "options_init: error: invalid sample count");
+            }
+        /* Cast this many shadow rays per hit, picking among the lights */
+        } else if (!strcmp(argv[i], "--light-samples")) {
+            opts->light_samples = atoi(option_arg(*argc, argv, &i));
+
+            if (opts->light_samples < 1) {
+                msg_exit(stderr, "options_init: error: invalid light samples");
+            }
+        /* Bake the light on each plane into a lightmap this many texels wide */
+        } else if (!strcmp(argv[i], "--lightmap")) {
+            opts->lightmap = atoi(option_arg(*argc, argv, &i));
+
+            if (opts->lightmap < 1 || opts->lightmap > LIGHTMAP_MAX) {
+                msg_exit(stderr, "options_init: error: invalid lightmap size");
+            }
+        /* Trace only a rectangle of the image */
+        } else if (!strcmp(argv[i], "--crop")) {
+            for (j = 0; j < CROP_SIZE; ++j) {
+                opts->crop[j] = atoi(option_arg(*argc, argv, &i));
+            }
+
+            if (opts->crop[2] <= 0) {
+                msg_exit(stderr, "options_init: error: invalid crop rectangle");
+            }
+        /* Write the full frame around the crop rectangle */
+        } else if (!strcmp(argv[i], "--full")) {
+            opts->full = 1;
+        /* Write the image after each pass of increasing quality */
+        } else if (!strcmp(argv[i], "--progressive")) {
+            opts->progressive = option_arg(*argc, argv, &i);
+        /* Record the rays of each pixel for incremental renders */
+        } else if (!strcmp(argv[i], "--deps")) {
+            opts->deps = option_arg(*argc, argv, &i);
+        /* Re-render only the pixels changed since an earlier scene */
+        } else if (!strcmp(argv[i], "--incremental")) {
+            opts->incremental = option_arg(*argc, argv, &i);
+        /* The image rendered from the earlier scene */
+        } else if (!strcmp(argv[i], "--base")) {
+            opts->base = option_arg(*argc, argv, &i);
+        /* Checkpoint the finished tiles of a long render */
+        } else if (!strcmp(argv[i], "--checkpoint")) {
+            opts->checkpoint = option_arg(*argc, argv, &i);
+        /* Skip the tiles finished in the checkpoint */
+        } else if (!strcmp(argv[i], "--resume")) {
+            opts->resume = 1;
+        /* Set the time between checkpoints */
+        } else if (!strcmp(argv[i], "--checkpoint-every")) {
+            opts->ckpt_secs = atoi(option_arg(*argc, argv, &i));
+
+            if (opts->ckpt_secs < 0) {
+                msg_exit(stderr, "options_init: error: invalid checkpoint "
+                                 "time");
+            }
+        /* Render within a time budget */
+        } else if (!strcmp(argv[i], "--time-budget")) {
+            opts->budget = atof(option_arg(*argc, argv, &i));
+
+            if (opts->budget <= 0.0) {
+                msg_exit(stderr, "options_init: error: invalid time budget");
+            }
+        /* Render one of several shards of the tiles */
+        } else if (!strcmp(argv[i], "--shard")) {
+            if (sscanf(option_arg(*argc, argv, &i), "%d/%d", &opts->shard[0],
+                                                   &opts->shard[1]) != 2 ||
+                opts->shard[0] < 0 || opts->shard[0] >= opts->shard[1]) {
+                msg_exit(stderr, "options_init: error: invalid shard");
+            }
+        /* Place the camera */
+        } else if (!strcmp(argv[i], "--eye")) {
+            option_vec(*argc, argv, &i, opts->eye);
+            opts->camera |= CAMERA_EYE;
+        /* Aim the camera */
+        } else if (!strcmp(argv[i], "--look")) {
+            option_vec(*argc, argv, &i, opts->look);
+            opts->camera |= CAMERA_LOOK;
+        /* Turn the camera about its view direction */
+        } else if (!strcmp(argv[i], "--up")) {
+            option_vec(*argc, argv, &i, opts->up);
+            opts->camera |= CAMERA_UP;
+        /* Set the camera's vertical field of view */
+        } else if (!strcmp(argv[i], "--fov")) {
+            opts->fov     = atof(option_arg(*argc, argv, &i));
+            opts->camera |= CAMERA_FOV;
+
+            if (opts->fov <= 0.0 || opts->fov >= 180.0) {
+                msg_exit(stderr, "options_init: error: invalid field of view");
+            }
+        /* Set the camera's aspect ratio */
+        } else if (!strcmp(argv[i], "--aspect")) {
+            opts->aspect  = atof(option_arg(*argc, argv, &i));
+            opts->camera |= CAMERA_ASPECT;
+
+            if (opts->aspect <= 0.0) {
+                msg_exit(stderr, "options_init: error: invalid aspect ratio");
+            }
+        /* Serve render jobs instead of rendering standard in */
+        } else if (!strcmp(argv[i], "--serve")) {
+            opts->serve = option_arg(*argc, argv, &i);
+        } else {
+            fprintf(stderr, "unknown option: %s\n", argv[i]);
+            msg_exit(stderr, "options_init: error: invalid option");
+        }
+    }
+
+    /* A checkpoint is of one image, rendered in one go */
+    if (opts->resume && !opts->checkpoint) {
+        msg_exit(stderr, "options_init: error: --resume needs --checkpoint");
+    } else if (opts->checkpoint && (opts->animate || opts->progressive ||
+                                    opts->budget > 0.0 || opts->shard[1] ||
+                                    opts->incremental)) {
+        msg_exit(stderr, "options_init: error: --checkpoint cannot be "
+                         "combined with --animate, --progressive, "
+                         "--time-budget, --shard or --incremental");
+    }
+
+    /* A time budget decides how many of its samples are traced */
+    if (opts->samples == 0) {
+        opts->samples = opts->budget > 0.0 ? BUDGET_SAMPLES : AA_SAMPLES;
+    }
+
+    *argc = kept;
+
+    return opts;
+}
+
+/*
+ * options_dump: Dumps the rendering options to the specified file.
+ *
+ * Parameters:   out  - The file to which the options will be dumped.
+ *               opts - The rendering options to dump.
+ *
+ * Return:       EXIT_SUCCESS if successful, EXIT_FAILURE otherwise.
+ */
+int options_dump(FILE *out, opts_t *opts) {
+    fprintf(out, "Options data - \n");
+
+    /* Print out the object ordering mode */
+    ivec_prn1(out, "reorder - ", &opts->reorder);
+
+    /* Print out the anti-aliasing sample count */
+    ivec_prn1(out, "samples - ", &opts->samples);
+
+    /* Print out the shadow rays per hit, if the lights are sampled */
+    if (opts->light_samples > 0) {
+        ivec_prn1(out, "light samples - ", &opts->light_samples);
+    }
+
+    /* Print out the lightmap size, if the planes are baked */
+    if (opts->lightmap > 0) {
+        ivec_prn1(out, "lightmap - ", &opts->lightmap);
+    }
+
+    /* Print out the animation settings */
+    if (opts->animate) {
+        fprintf(out, "animate - \n%s\n", opts->animate);
+        fprintf(out, "output - \n%s\n", opts->output);
+    }
+
+    /* Print out the crop rectangle */
+    if (opts->crop[2] > 0) {
+        fprintf(out, "crop - \n%d %d %d %d\n", opts->crop[0], opts->crop[1],
+                                              opts->crop[2], opts->crop[3]);
+        ivec_prn1(out, "full - ", &opts->full);
+    }
+
+    /* Print out the progressive image file */
+    if (opts->progressive) {
+        fprintf(out, "progressive - \n%s\n", opts->progressive);
+    }
+
+    /* Print out the incremental render files */
+    if (opts->deps) {
+        fprintf(out, "deps - \n%s\n", opts->deps);
+    }
+
+    if (opts->incremental) {
+        fprintf(out, "incremental - \n%s\n", opts->incremental);
+        fprintf(out, "base - \n%s\n", opts->base ? opts->base : "(none)");
+    }
+
+    /* Print out the time budget */
+    if (opts->budget > 0.0) {
+        vec_prn1(out, "time budget - ", &opts->budget);
+    }
+
+    /* Print out the shard */
+    if (opts->shard[1] > 0) {
+        fprintf(out, "shard - \n%d/%d\n", opts->shard[0], opts->shard[1]);
+    }
+
+    /* Print out the camera */
+    if (opts->camera) {
+        vec_prn3(out, "eye - ",     opts->eye);
+        vec_prn3(out, "look - ",    opts->look);
+        vec_prn3(out, "up - ",      opts->up);
+        vec_prn1(out, "fov - ",    &opts->fov);
+        vec_prn1(out, "aspect - ", &opts->aspect);
+    }
+
+    /* Print out the checkpoint file */
+    if (opts->checkpoint) {
+        fprintf(out, "checkpoint - \n%s\n", opts->checkpoint);
+        ivec_prn1(out, "resume - ", &opts->resume);
+        ivec_prn1(out, "checkpoint every - ", &opts->ckpt_secs);
+    }
+
+    /* Print out the server socket */
+    if (opts->serve) {
+        fprintf(out, "serve - \n%s\n", opts->serve);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,80 @@
+/*
+ * options.h: This header file contains the implementation specifications for
+ *            the command line rendering options.
+ *
+ * Author:    Scott Gigawatt
+ *
+ * Version:   18 October 2026
+ */
+
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#include <stdio.h>
+
+/* The number of crop rectangle values: x0, y0, x1, y1 */
+#define CROP_SIZE 4
+
+/* The camera options given, as bits of opts_t.camera */
+#define CAMERA_EYE     1 /* --eye    */
+#define CAMERA_LOOK    2 /* --look   */
+#define CAMERA_UP      4 /* --up     */
+#define CAMERA_FOV     8 /* --fov    */
+#define CAMERA_ASPECT 16 /* --aspect */
+
+/* A structure to contain the rendering options */
+typedef struct options_type {
+    int    reorder;         /* Order objects by hit frequency from a pre-pass */
+    char   *animate;        /* Keyframe file for rendering an animation       */
+    char   *output;         /* Frame file name pattern (printf style)         */
+    int    samples;         /* Anti-aliasing samples per pixel                */
+    int    light_samples;   /* Shadow rays per hit across lights (0: all)     */
+    int    lightmap;        /* Lightmap texels across each plane (0: none)    */
+    char   *serve;          /* Unix domain socket on which to serve jobs      */
+    int    crop[CROP_SIZE]; /* Rectangle of pixels to trace (x1 of 0: all)    */
+    int    full;            /* Write the full frame around the crop rectangle */
+    char   *progressive;    /* Image file rewritten after each pass ("-")     */
+    char   *deps;           /* Per-pixel ray dependency file                  */
+    char   *incremental;    /* Earlier scene to re-render the changes of      */
+    char   *base;           /* Earlier image to re-render the changes of      */
+    char   *checkpoint;     /* File to which finished tiles are checkpointed  */
+    int    resume;          /* Skip the tiles finished in the checkpoint      */
+    int    ckpt_secs;       /* Least seconds between checkpoints (0: tiles)   */
+    double budget;          /* Seconds in which to render (0: no limit)       */
+    int    shard[2];        /* Shard index and count (count of 0: no shards)  */
+    int    camera;          /* The camera options given (CAMERA_EYE, ...)     */
+    double eye[3];          /* Camera position                                */
+    double look[3];         /* Point the camera looks at                      */
+    double up[3];           /* Camera up direction                            */
+    double fov;             /* Camera vertical field of view in degrees       */
+    double aspect;          /* Camera window width over height                */
+} opts_t;
+
+/* The default frame file name pattern */
+#define DEF_OUTPUT "frame%04d.ppm"
+
+/* The default number of anti-aliasing samples per pixel */
+#ifndef AA_SAMPLES
+    #define AA_SAMPLES 1
+#endif
+
+/* The default samples per pixel of a time-budgeted render */
+#ifndef BUDGET_SAMPLES
+    #define BUDGET_SAMPLES 64
+#endif
+
+/* The most texels across a lightmap (--lightmap) */
+#define LIGHTMAP_MAX 4096
+
+/* The default least number of seconds between checkpoints */
+#ifndef CKPT_SECS
+    #define CKPT_SECS 10
+#endif
+
+/* Parses the rendering options, removing them from the argument list */
+opts_t *options_init(int *argc, char **argv);
+
+/* Dumps the rendering options to the specified file */
+int options_dump(FILE *out, opts_t *opts);
+
+#endif
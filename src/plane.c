@@ -28,9 +28,12 @@ obj_t *plane_init(FILE *in, int objtype) {
     /* Link the plane to the object structure */
     obj->priv    = new;
     obj->hits    = hits_plane;
+    obj->surface = plane_surface;
+    obj->move    = plane_move;
     obj->destroy = plane_destroy;
     obj->dump    = plane_dump;
     new->priv    = NULL;
+    new->clip    = 1;
      
     /* Get the normal vector information (x, y, z) and check for errors */
     if (( rc = vec_get3(in, new->normal) ) != VEC_SIZE) {
@@ -84,13 +87,15 @@ int plane_dump(FILE *out, obj_t *obj) {
  *
  * Parameters: base - The origins of the ray (x, y, z).
  *             dir  - The direction of the ray (x, y, z).
+ *             tmin - Hits at or before this distance are misses.
+ *             tmax - Hits at or beyond this distance are misses.
  *             obj  - The plane object we want to hit.
  *
- * Return:     The distance to the hit location.
+ * Return:     The distance to the hit location, or MISS.
  */
-double hits_plane(double *base, double *dir, obj_t *obj) {
+double hits_plane(double *base, double *dir, double tmin, double tmax,
+                  obj_t *obj) {
     plane_t *plane = (plane_t *)obj->priv; /* The plane to test for a hit   */
-    double  hit_loc[VEC_SIZE];             /* The hit location of the ray   */
     double  distance;                      /* The distance to the hit point */
     double  a;                             /* Value a for distance formula  */
     double  b;                             /* Value b for distance formula  */
@@ -104,22 +109,61 @@ double hits_plane(double *base, double *dir, obj_t *obj) {
     /* Find the distance to the plane */
     distance = (a - b) / c;
 
-    /* Find the hit location */
-    vec_scale3(distance, dir, hit_loc);
-    vec_sum3(base, hit_loc, hit_loc);
-
-    if (distance < 0 || hit_loc[2] > 0.01 || c == 0) {
-        /* Ray missed the plane*/
-        distance = MISS;
-    } else {
-        /* Ray hit the sphere, save hit location and normal */
-        vec_scale3(1.0, hit_loc, obj->hitloc);
-        vec_scale3(1.0, plane->normal, obj->normal);
+    if (c == 0 || !(distance > tmin && distance < tmax)) {
+        /* Ray missed the plane or hit it outside of the distance bounds */
+        return MISS;
+    }
+
+    if (plane->clip && *(base + 2) + distance * *(dir + 2) > 0.01) {
+        /* Ray hit the plane in front of the screen */
+        return MISS;
     }
 
     return distance;
 }
 
+/*
+ * plane_surface: Computes the hit location and normal of a ray that hit a
+ *                plane object.
+ *
+ * Parameters:    base - The origins of the ray (x, y, z).
+ *                dir  - The direction of the ray (x, y, z).
+ *                dist - The distance returned by the hits function.
+ *                obj  - The plane object that was hit.
+ */
+void plane_surface(double *base, double *dir, double dist, obj_t *obj) {
+    plane_t *plane = (plane_t *)obj->priv; /* The plane that was hit */
+
+    /* Save the hit location and normal */
+    vec_scale3(dist, dir, obj->hitloc);
+    vec_sum3(base, obj->hitloc, obj->hitloc);
+    vec_scale3(1.0, plane->normal, obj->normal);
+}
+
+/*
+ * plane_unclip: Stops clipping the specified plane object at the screen,
+ *               which only makes sense in world coordinates, for planes of
+ *               a prototype.
+ *
+ * Parameters:   obj - The plane object.
+ */
+void plane_unclip(obj_t *obj) {
+    ((plane_t *)obj->priv)->clip = 0;
+}
+
+/*
+ * plane_move: Translates the specified plane object by an offset.  Finite
+ *             and tiled planes are positioned by the same point.
+ *
+ * Parameters: obj    - The plane object to move.
+ *             offset - The translation (x, y, z).
+ */
+void plane_move(obj_t *obj, double *offset) {
+    plane_t *plane = (plane_t *)obj->priv; /* The plane to move */
+
+    vec_sum3(plane->point, offset, plane->point);
+}
+
 /* 
  * plane_destroy: Destroys the specified plane object.
  *
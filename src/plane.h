@@ -16,6 +16,7 @@
 typedef struct plane_type {
     double normal[VEC_SIZE]; /* A normal vector to the plane       */
     double point[VEC_SIZE];  /* A point on the plane               */
+    int    clip;             /* Set to miss hits before the screen */
     void   *priv;            /* Private data for specialized types */
 } plane_t;
 
@@ -26,7 +27,17 @@ obj_t *plane_init(FILE *in, int objtype);
 int plane_dump(FILE *out, obj_t *obj);
 
 /* Determines if a ray hits a plane object */
-double hits_plane(double *base, double *dir, obj_t *obj);
+double hits_plane(double *base, double *dir, double tmin, double tmax,
+                  obj_t *obj);
+
+/* Computes the hit location and normal of a ray that hit a plane */
+void plane_surface(double *base, double *dir, double dist, obj_t *obj);
+
+/* Stops clipping the specified plane object at the screen */
+void plane_unclip(obj_t *obj);
+
+/* Translates the specified plane object by an offset */
+void plane_move(obj_t *obj, double *offset);
 
 /* Destroys the specified plane object */
 void plane_destroy(obj_t *obj);
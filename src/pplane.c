@@ -13,6 +13,13 @@
 #include "mem.h"
 #include "veclib3d.h"
 
+/* Function pointers to plane shading procedures */
+void (*plane_shaders[NUM_PSHADERS])(obj_t *obj, double *ivec) = {
+    pplane0_amb, /* Alternating bands of color  */
+    pplane1_amb, /* Alternating colored circles */
+    pplane2_amb  /* Asymtotic color bands       */
+};
+
 /* 
  * pplane_init: Allocates memory for, initializes, and returns a new plane.
  *
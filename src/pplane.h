@@ -24,14 +24,10 @@ void pplane1_amb(obj_t *obj, double *ivec);
 /* Shader function for creating asymtotic color bands */
 void pplane2_amb(obj_t *obj, double *ivec);
 
-/* Function pointers to plane shading procedures */
-static void (*plane_shaders[])(obj_t *obj, double *ivec) = {
-    pplane0_amb, /* Alternating bands of color  */
-    pplane1_amb, /* Alternating colored circles */
-    pplane2_amb  /* Asymtotic color bands       */
-};
-
 /* The number of plane shading functions */
-#define NUM_PSHADERS sizeof(plane_shaders) / sizeof(void *)
+#define NUM_PSHADERS 3
+
+/* Function pointers to plane shading procedures (see pplane.c) */
+extern void (*plane_shaders[NUM_PSHADERS])(obj_t *obj, double *ivec);
 
 #endif
@@ -0,0 +1,464 @@
+/*
+ * progress.c: This file contains the implementation details for progressive
+ *             rendering.  The first pass traces one sample of one pixel in
+ *             each PROGRESS_STEP square block and fills the block with it.
+ *             Each following pass halves the block size, tracing only the
+ *             pixels not yet traced, until every pixel has one sample.  The
+ *             remaining passes then double the samples per pixel until the
+ *             configured count is reached.  The image is written after every
+ *             pass.
+ *
+ *             Each pixel keeps the running total of its sample intensities,
+ *             and samples are traced with the same seeds as make_pixel, so
+ *             the last pass is identical to a normal render.
+ *
+ *             A time-budgeted render starts with the same block passes, the
+ *             coarsest of which always finishes so the image is complete.
+ *             Each following round doubles the samples of the pixels whose
+ *             estimated error is still visible, noisiest first, up to the
+ *             configured count.  The render stops refining the moment the
+ *             budget runs out.
+ *
+ * Author:     Scott Gigawatt
+ *
+ * Version:    18 October 2026
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include "progress.h"
+#include "image.h"
+#include "mem.h"
+
+/* The errors being ordered by error_compare */
+static double *sort_errors = NULL;
+
+/*
+ * elapsed:    Returns the number of seconds since the specified time.
+ *
+ * Parameters: start - The start time.
+ *
+ * Return:     The elapsed time in seconds.
+ */
+static double elapsed(struct timeval *start) {
+    struct timeval now; /* The current time */
+
+    gettimeofday(&now, NULL);
+
+    return (now.tv_sec - start->tv_sec) + (now.tv_usec - start->tv_usec) / 1e6;
+}
+
+/*
+ * write_pass: Writes the image of a finished pass.  A file is replaced in
+ *             a single step, so that a viewer never reads a partial image;
+ *             on standard out the images simply follow one another.
+ *
+ * Parameters: pixmap - The image data.
+ *             vals   - The PPM header values (see write_ppm).
+ *             name   - The output file, or PROGRESS_STDOUT.
+ */
+static void write_pass(unsigned char *pixmap, int *vals, char *name) {
+    char temp[BUF_SIZE]; /* The file being written */
+    FILE *out;           /* The output file        */
+
+    if (!strcmp(name, PROGRESS_STDOUT)) {
+        write_ppm(pixmap, ID_COLOR, vals, stdout);
+        fflush(stdout);
+        return;
+    }
+
+    snprintf(temp, BUF_SIZE, "%s.tmp", name);
+
+    if ((out = fopen(temp, "wb")) == NULL) {
+        msg_exit(stderr, "write_pass: error: cannot create image file");
+    }
+
+    write_ppm(pixmap, ID_COLOR, vals, out);
+
+    if (fclose(out) || rename(temp, name)) {
+        msg_exit(stderr, "write_pass: error: cannot replace image file");
+    }
+}
+
+/*
+ * fill_block: Fills a block of pixels with the value of its corner pixel,
+ *             clipped to the traced rectangle.
+ *
+ * Parameters: model  - The model on which the image is based.
+ *             pixmap - The image data.
+ *             region - The rectangle of traced pixels (see image_region).
+ *             x      - The column of the corner pixel.
+ *             row    - The row of the corner pixel.
+ *             step   - The width and height of the block.
+ */
+static void fill_block(model_t *model, unsigned char *pixmap, int *region,
+                       int x, int row, int step) {
+    unsigned char *corner;  /* The corner pixel value */
+    int           i;        /* Counter variable       */
+    int           j;        /* Counter variable       */
+
+    corner = image_pixel(model, pixmap, region, x, row);
+
+    for (i = row; i < row + step && i < region[3]; ++i) {
+        for (j = x; j < x + step && j < region[2]; ++j) {
+            memcpy(image_pixel(model, pixmap, region, j, i), corner,
+                                                        PIXEL_SIZE);
+        }
+    }
+}
+
+/*
+ * block_pass: Traces the first sample of one pixel in each block of the
+ *             specified size and fills the block with it, skipping pixels
+ *             traced by the coarser passes before it.
+ *
+ * Parameters: model  - The model on which the image is based.
+ *             pixmap - The image data.
+ *             region - The rectangle of traced pixels (see image_region).
+ *             totals - The total intensity of each pixel of the rectangle.
+ *             step   - The width and height of the blocks.
+ *             start  - The time rendering started, or NULL for no limit.
+ *             limit  - The number of seconds after start at which to stop.
+ *             traced - Incremented for each pixel traced, unless NULL.
+ *
+ * Return:     Nonzero if the pass was finished, zero if time ran out.
+ */
+static int block_pass(model_t *model, unsigned char *pixmap, int *region,
+                      double *totals, int step, struct timeval *start,
+                      double limit, long *traced) {
+    double *total;                                  /* A pixel's intensity */
+    int    width  = region[2] - region[0];          /* The rectangle width */
+    int    height = model->proj->win_size_pixel[1]; /* The image height    */
+    int    i;                                       /* Counter variable    */
+    int    j;                                       /* Counter variable    */
+
+    for (i = region[1]; i < region[3]; i += step) {
+        for (j = region[0]; j < region[2]; j += step) {
+            /* Skip pixels traced by an earlier pass */
+            if (step < PROGRESS_STEP && (i - region[1]) % (2 * step) == 0
+                                     && (j - region[0]) % (2 * step) == 0) {
+                continue;
+            }
+
+            if (start && elapsed(start) >= limit) {
+                return 0;
+            }
+
+            total = totals + ((i - region[1]) * width + j - region[0])
+                                                          * VEC_SIZE;
+
+            sample_pixel(model, j, height - i, 0, 1, total);
+            set_pixel(total, 1, image_pixel(model, pixmap, region, j, i));
+            fill_block(model, pixmap, region, j, i, step);
+
+            if (traced) {
+                ++*traced;
+            }
+        }
+    }
+
+    return 1;
+}
+
+/*
+ * progress_render: Renders the image in passes of increasing quality,
+ *                  writing the image named by the rendering options after
+ *                  each pass.
+ *
+ * Parameters:      model - The model on which the image will be based.
+ */
+void progress_render(model_t *model) {
+    unsigned char  *pixmap = NULL;    /* The image data                */
+    double         *totals = NULL;    /* Total intensity of each pixel */
+    double         *total;            /* Total intensity of a pixel    */
+    int            vals[VEC_SIZE];    /* The PPM header values         */
+    int            region[CROP_SIZE]; /* The traced pixels             */
+    int            width;             /* The width of the rectangle    */
+    int            height;            /* The image height              */
+    int            step;              /* The block size of the pass    */
+    int            done;              /* Samples traced in every pixel */
+    int            count;             /* Samples traced by the pass    */
+    int            pass = 0;          /* The pass number               */
+    int            i;                 /* Counter variable              */
+    int            j;                 /* Counter variable              */
+    struct timeval start;             /* The time rendering started    */
+
+    gettimeofday(&start, NULL);
+
+    pixmap = image_alloc(model, vals);
+    image_region(model, region);
+    width  = region[2] - region[0];
+    height = model->proj->win_size_pixel[1];
+
+    totals = (double *)Malloc(width * (region[3] - region[1]) * VEC_SIZE *
+                                                         sizeof(double));
+    memset(totals, 0, width * (region[3] - region[1]) * VEC_SIZE *
+                                                  sizeof(double));
+
+    /* Order the scene objects by hit frequency */
+    if (model->opts->reorder) {
+        profile_hits(model);
+    }
+
+    /* Trace the first sample of each pixel, coarsest blocks first */
+    for (step = PROGRESS_STEP; step >= 1; step /= 2) {
+        block_pass(model, pixmap, region, totals, step, NULL, 0.0, NULL);
+        write_pass(pixmap, vals, model->opts->progressive);
+        fprintf(stderr, "Pass %d: %dx%d blocks, 1 sample, %.3fs\n", ++pass,
+                                              step, step, elapsed(&start));
+    }
+
+    /* Double the samples of every pixel until the sample count is reached */
+    for (done = 1; done < model->opts->samples; done += count) {
+        count = model->opts->samples - done;
+        count = count < done ? count : done;
+
+        for (i = region[1]; i < region[3]; ++i) {
+            for (j = region[0]; j < region[2]; ++j) {
+                total = totals + ((i - region[1]) * width + j - region[0])
+                                                              * VEC_SIZE;
+
+                sample_pixel(model, j, height - i, done, count, total);
+                set_pixel(total, done + count,
+                          image_pixel(model, pixmap, region, j, i));
+            }
+        }
+
+        write_pass(pixmap, vals, model->opts->progressive);
+        fprintf(stderr, "Pass %d: %d samples, %.3fs\n", ++pass, done + count,
+                                                        elapsed(&start));
+    }
+
+    Free(totals);
+    Free(pixmap);
+}
+
+/*
+ * luminance:  Computes the displayed brightness of an intensity, clamped to
+ *             the range of a pixel value.
+ *
+ * Parameters: ivec  - The intensity (r, g, b).
+ *             count - The number of samples summed in the intensity.
+ *
+ * Return:     The mean of the clamped components, from 0.0 to 1.0.
+ */
+static double luminance(double *ivec, int count) {
+    double sum = 0.0; /* The sum of the components */
+    double val;       /* A component               */
+    int    i;         /* Counter                   */
+
+    for (i = 0; i < VEC_SIZE; ++i) {
+        val  = ivec[i] / count;
+        sum += val < 0.0 ? 0.0 : val > 1.0 ? 1.0 : val;
+    }
+
+    return sum / VEC_SIZE;
+}
+
+/*
+ * error_compare: Orders pixel indices by descending estimated error.
+ *
+ * Parameters:    a - A pointer to the first pixel index.
+ *                b - A pointer to the second pixel index.
+ *
+ * Return:        Negative if the first pixel is noisier, positive if the
+ *                second is, zero otherwise.
+ */
+static int error_compare(const void *a, const void *b) {
+    double diff = sort_errors[*(int *)b] - sort_errors[*(int *)a]; /* Gap */
+
+    return diff > 0.0 ? 1 : diff < 0.0 ? -1 : *(int *)a - *(int *)b;
+}
+
+/*
+ * pixel_error: Estimates how far the displayed brightness of a pixel may be
+ *              from its converged value.  Until a pixel has BUDGET_MIN
+ *              samples, the contrast with its neighbours is also counted,
+ *              so that edges are refined even if their first samples agree.
+ *
+ * Parameters:  totals  - The total intensity of each pixel.
+ *              squares - The sum of squared sample brightness of each pixel.
+ *              counts  - The number of samples of each pixel.
+ *              width   - The number of pixels in a row.
+ *              rows    - The number of rows.
+ *              pixel   - The pixel index.
+ *
+ * Return:      The standard error of the mean brightness of the pixel.
+ */
+static double pixel_error(double *totals, double *squares, int *counts,
+                          int width, int rows, int pixel) {
+    double mean;              /* The mean brightness   */
+    double var;               /* The sample variance   */
+    double error = 0.0;       /* The estimated error   */
+    double gap;               /* A neighbour contrast  */
+    int    n = counts[pixel]; /* The sample count      */
+    int    near[4];           /* The neighbour indices */
+    int    i;                 /* Counter               */
+
+    mean = luminance(totals + pixel * VEC_SIZE, n);
+
+    if (n > 1) {
+        var   = (squares[pixel] - n * mean * mean) / (n - 1);
+        error = var > 0.0 ? sqrt(var / n) : 0.0;
+    }
+
+    if (n >= BUDGET_MIN) {
+        return error;
+    }
+
+    near[0] = pixel % width > 0         ? pixel - 1     : pixel;
+    near[1] = pixel % width < width - 1 ? pixel + 1     : pixel;
+    near[2] = pixel / width > 0         ? pixel - width : pixel;
+    near[3] = pixel / width < rows - 1  ? pixel + width : pixel;
+
+    for (i = 0; i < 4; ++i) {
+        gap = fabs(luminance(totals + near[i] * VEC_SIZE, counts[near[i]])
+                                                            - mean);
+        error = gap > error ? gap : error;
+    }
+
+    return error;
+}
+
+/*
+ * budget_render: Renders the image within the number of seconds given by
+ *                the rendering options, spending the samples on the pixels
+ *                where they are most visible, and writes it to standard out
+ *                (or to the progressive image file after each round).
+ *
+ * Parameters:    model - The model on which the image will be based.
+ */
+void budget_render(model_t *model) {
+    unsigned char  *pixmap  = NULL;   /* The image data                 */
+    double         *totals  = NULL;   /* Total intensity of each pixel  */
+    double         *squares = NULL;   /* Sum of squared sample values   */
+    double         *errors  = NULL;   /* Estimated error of each pixel  */
+    int            *counts  = NULL;   /* Samples traced in each pixel   */
+    int            *order   = NULL;   /* The pixels to refine, noisiest */
+    double         sample[VEC_SIZE];  /* The intensity of one sample    */
+    double         limit;             /* The budget in seconds          */
+    double         lum;               /* The brightness of a sample     */
+    int            vals[VEC_SIZE];    /* The PPM header values          */
+    int            region[CROP_SIZE]; /* The traced pixels              */
+    int            width;             /* The width of the rectangle     */
+    int            rows;              /* The height of the rectangle    */
+    int            height;            /* The image height               */
+    int            pixels;            /* The number of traced pixels    */
+    int            step;              /* The block size of the pass     */
+    int            num;               /* The number of pixels to refine */
+    int            add;               /* Samples to add to a pixel      */
+    int            x;                 /* The column of a pixel          */
+    int            row;               /* The row of a pixel             */
+    int            rounds  = 0;       /* The refinement rounds          */
+    int            out     = 0;       /* Set when the budget runs out   */
+    long           traced  = 0;       /* The samples traced             */
+    int            i;                 /* Counter variable               */
+    int            k;                 /* Counter variable               */
+    struct timeval start;             /* The time rendering started     */
+
+    gettimeofday(&start, NULL);
+    limit = model->opts->budget;
+
+    pixmap = image_alloc(model, vals);
+    image_region(model, region);
+    width  = region[2] - region[0];
+    rows   = region[3] - region[1];
+    height = model->proj->win_size_pixel[1];
+    pixels = width * rows;
+
+    totals  = (double *)Malloc(pixels * VEC_SIZE * sizeof(double));
+    squares = (double *)Malloc(pixels * sizeof(double));
+    errors  = (double *)Malloc(pixels * sizeof(double));
+    counts  = (int *)Malloc(pixels * sizeof(int));
+    order   = (int *)Malloc(pixels * sizeof(int));
+    memset(totals, 0, pixels * VEC_SIZE * sizeof(double));
+
+    /* Order the scene objects by hit frequency */
+    if (model->opts->reorder) {
+        profile_hits(model);
+    }
+
+    /* The coarsest pass always finishes, so that the image is complete */
+    for (step = PROGRESS_STEP; step >= 1 && !out; step /= 2) {
+        out = !block_pass(model, pixmap, region, totals, step,
+                          step < PROGRESS_STEP ? &start : NULL, limit,
+                          &traced);
+    }
+
+    /* Until every pixel has a sample, only the block passes are refined */
+    for (i = 0; i < pixels && !out; ++i) {
+        counts[i]  = 1;
+        lum        = luminance(totals + i * VEC_SIZE, 1);
+        squares[i] = lum * lum;
+    }
+
+    while (!out) {
+        /* Find the pixels whose error is visible, noisiest first */
+        for (i = num = 0; i < pixels; ++i) {
+            errors[i] = pixel_error(totals, squares, counts, width, rows, i);
+
+            if (counts[i] < model->opts->samples && errors[i] > BUDGET_ERROR) {
+                order[num++] = i;
+            }
+        }
+
+        if (num == 0) {
+            break;
+        }
+
+        sort_errors = errors;
+        qsort(order, num, sizeof(int), error_compare);
+        ++rounds;
+
+        /* Double the samples of each pixel, until the budget runs out */
+        for (i = 0; i < num && !out; ++i) {
+            x   = region[0] + order[i] % width;
+            row = region[1] + order[i] / width;
+            add = model->opts->samples - counts[order[i]];
+            add = add < counts[order[i]] ? add : counts[order[i]];
+
+            for (k = 0; k < add; ++k) {
+                if (elapsed(&start) >= limit) {
+                    out = 1;
+                    break;
+                }
+
+                sample[0] = sample[1] = sample[2] = 0.0;
+                sample_pixel(model, x, height - row, counts[order[i]], 1,
+                                                                 sample);
+                vec_sum3(sample, totals + order[i] * VEC_SIZE,
+                                 totals + order[i] * VEC_SIZE);
+
+                lum                = luminance(sample, 1);
+                squares[order[i]] += lum * lum;
+                ++counts[order[i]];
+                ++traced;
+            }
+
+            set_pixel(totals + order[i] * VEC_SIZE, counts[order[i]],
+                      image_pixel(model, pixmap, region, x, row));
+        }
+
+        if (model->opts->progressive) {
+            write_pass(pixmap, vals, model->opts->progressive);
+        }
+    }
+
+    /* Write the finished image */
+    write_pass(pixmap, vals, model->opts->progressive ?
+                             model->opts->progressive : PROGRESS_STDOUT);
+
+    fprintf(stderr, "Budget: %ld samples (%.2f per pixel), %d rounds, "
+                    "%.3fs%s\n", traced, (double)traced / pixels, rounds,
+                    elapsed(&start), out ? " (budget reached)" : "");
+
+    Free(totals);
+    Free(squares);
+    Free(errors);
+    Free(counts);
+    Free(order);
+    Free(pixmap);
+}
@@ -0,0 +1,37 @@
+/*
+ * progress.h: This header file contains the implementation specifications
+ *             for progressive rendering.
+ *
+ * Author:     Scott Gigawatt
+ *
+ * Version:    18 October 2026
+ */
+
+#ifndef PROGRESS_H
+#define PROGRESS_H
+
+#include "model.h"
+
+/* The first pass traces one pixel in each PROGRESS_STEP square block */
+#ifndef PROGRESS_STEP
+    #define PROGRESS_STEP 8
+#endif
+
+/* The output name that writes each pass to standard out */
+#define PROGRESS_STDOUT "-"
+
+/* A time-budgeted render refines pixels while their error is visible */
+#define BUDGET_ERROR (0.5 / MAX_COLOR)
+
+/* Neighbour contrast counts toward the error until this many samples */
+#ifndef BUDGET_MIN
+    #define BUDGET_MIN 4
+#endif
+
+/* Renders the image in passes of increasing quality */
+void progress_render(model_t *model);
+
+/* Renders the image within a time budget, refining the noisiest pixels */
+void budget_render(model_t *model);
+
+#endif
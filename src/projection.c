@@ -7,38 +7,55 @@
  * Version:      22 March 2011
  */
 
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include "projection.h"
 #include "mem.h"
+#include "texture.h"
 
 /* 
  * projection_init: Initializes the world dimensions and viewpoint.
  *
- * Parameters:      in    - The file from which the information will be read.
- *                  model - The model to initialize.
+ * Parameters:      argc    - The number of command line arguments.
+ *                  argv[1] - The window width in pixels (x).
+ *                  argv[2] - The window height in pixels (y).
+ *                  in      - The file from which the information will be read.
  *
  * Return:          A pointer to the projection information.
  */
 proj_t *projection_init(int argc, char **argv, FILE *in) {
-    proj_t *proj = (proj_t *)Malloc(sizeof(proj_t)); /* The new projection */
-    int    rc    = 0;                                /* The read count     */
-    int    i;                                        /* Counter            */
-
     /* Check for valid arguments */
     if (argc != VEC_SIZE) {
         msg_exit(stderr, "projection_init: error: invalid argument count");
     }
 
-    /* Get the screen size in pixels (x, y) */
-    for (i = 0; i < VEC_SIZE - 1; ++i) {
-        proj->win_size_pixel[i] = atoi( *(argv + i + 1) );
-    }
+    return projection_read(in, atoi(*(argv + 1)), atoi(*(argv + 2)));
+}
+
+/* 
+ * projection_read: Reads the world dimensions and viewpoint for an image of
+ *                  the specified size.
+ *
+ * Parameters:      in     - The file from which the information will be read.
+ *                  width  - The window width in pixels (x).
+ *                  height - The window height in pixels (y).
+ *
+ * Return:          A pointer to the projection information.
+ */
+proj_t *projection_read(FILE *in, int width, int height) {
+    proj_t *proj = (proj_t *)Malloc(sizeof(proj_t)); /* The new projection */
+    int    rc    = 0;                                /* The read count     */
+
+    /* Set the screen size in pixels (x, y) */
+    proj->win_size_pixel[0] = width;
+    proj->win_size_pixel[1] = height;
+    proj->camera            = 0;
 
     /* Get the world dimensions (x, y) and check for errors */
     if (( rc = vec_get2(in, proj->win_size_world) ) != VEC_SIZE - 1) {
         fprintf(stderr, "world rc: %d\n", rc);
-        msg_exit(stderr, "projection_init: error: invalid read count");
+        msg_exit(stderr, "projection_read: error: invalid read count");
     }
 
     consume_line(in);
@@ -46,7 +63,7 @@ proj_t *projection_init(int argc, char **argv, FILE *in) {
     /* Get the viewpoint (x, y, z) and check for errors */
     if (( rc = vec_get3(in, proj->view_point) ) != VEC_SIZE) {
         fprintf(stderr, "point rc: %d\n", rc);
-        msg_exit(stderr, "projection_init: error: invalid read count");
+        msg_exit(stderr, "projection_read: error: invalid read count");
     }
 
     consume_line(in);
@@ -54,6 +71,102 @@ proj_t *projection_init(int argc, char **argv, FILE *in) {
     return proj;
 }
 
+/* 
+ * projection_camera: Sets up the look-at camera given by the rendering
+ *                    options.  The basis and the window, through the point
+ *                    looked at, are computed here, once, so that mapping a
+ *                    pixel to the world takes a division per axis and a
+ *                    multiply-add per coordinate and axis (see
+ *                    map_pix_to_world).  A camera option left out is taken
+ *                    from the scene:
+ *
+ *                      eye    - the scene's view point
+ *                      look   - the centre of the scene's window, (0, 0, 0)
+ *                      up     - the y axis
+ *                      fov    - the vertical angle of the scene's window
+ *                               seen from the eye
+ *                      aspect - the aspect ratio of the scene's window
+ *
+ *                    so a camera on the z axis looking at the origin uses
+ *                    the scene's own window, and maps every pixel to the
+ *                    same world point as without a camera.  Without camera
+ *                    options, the scene's window is used.  Either way, the
+ *                    angle one pixel covers is passed on to size texture
+ *                    lookups.
+ *
+ * Parameters:        proj - The projection, with its pixel size set.
+ *                    opts - The rendering options, or NULL.
+ */
+void projection_camera(proj_t *proj, opts_t *opts) {
+    double look[VEC_SIZE] = { 0.0, 0.0, 0.0 }; /* The point looked at      */
+    double fwd[VEC_SIZE];                      /* The unit view direction  */
+    double right[VEC_SIZE];                    /* The unit right direction */
+    double up[VEC_SIZE];                       /* The unit up direction    */
+    double span[2];                            /* The window size          */
+    double dist;                               /* The eye to look distance */
+    int    i;                                  /* Counter                  */
+
+    proj->camera = opts && opts->camera;
+
+    if (!proj->camera) {
+        texture_pixel(proj->win_size_pixel[1] > 1 && proj->view_point[2] ?
+                      proj->win_size_world[1] /
+                      (proj->win_size_pixel[1] - 1) /
+                      fabs(proj->view_point[2]) : 0.0);
+        return;
+    }
+
+    /* The eye replaces the view point, from which every ray is traced */
+    if (opts->camera & CAMERA_EYE) {
+        vec_scale3(1.0, opts->eye, proj->view_point);
+    }
+
+    if (opts->camera & CAMERA_LOOK) {
+        vec_scale3(1.0, opts->look, look);
+    }
+
+    /* Build the orthonormal basis */
+    vec_diff3(proj->view_point, look, fwd);
+
+    if ((dist = vec_length3(fwd)) == 0.0) {
+        msg_exit(stderr, "projection_camera: error: eye and look coincide");
+    }
+
+    vec_unit3(fwd, fwd);
+    vec_cross3(fwd, opts->up, right);
+
+    if (vec_length3(right) < 1e-9) {
+        msg_exit(stderr, "projection_camera: error: up is along the view");
+    }
+
+    vec_unit3(right, right);
+    vec_cross3(right, fwd, up);
+
+    /* The window, through the point looked at, is the scene's own unless
+       the angle or the aspect ratio is given */
+    span[0] = proj->win_size_world[0];
+    span[1] = proj->win_size_world[1];
+
+    if (opts->fov > 0.0) {
+        span[1] = 2.0 * dist * tan(opts->fov * M_PI / 360.0);
+        span[0] = span[1] * proj->win_size_world[0] / proj->win_size_world[1];
+    }
+
+    if (opts->aspect > 0.0) {
+        span[0] = span[1] * opts->aspect;
+    }
+
+    texture_pixel(proj->win_size_pixel[1] > 1 ?
+                  span[1] / (proj->win_size_pixel[1] - 1) / dist : 0.0);
+
+    for (i = 0; i < VEC_SIZE; ++i) {
+        proj->du[i]     = right[i] * span[0];
+        proj->dv[i]     = up[i]    * span[1];
+        proj->corner[i] = look[i] - right[i] * span[0] / 2.0 -
+                                    up[i]    * span[1] / 2.0;
+    }
+}
+
 /* 
  * projection_dump: Dumps the contents of the projection structure to the 
  *                  specified output file.
@@ -75,5 +188,12 @@ int projection_dump(FILE *out, proj_t *proj) {
     /* Print out the view point */
     vec_prn3(out, "view point - ",   proj->view_point);
 
+    /* Print out the camera */
+    if (proj->camera) {
+        vec_prn3(out, "camera corner - ", proj->corner);
+        vec_prn3(out, "camera du - ",     proj->du);
+        vec_prn3(out, "camera dv - ",     proj->dv);
+    }
+
     return EXIT_SUCCESS;
 }
@@ -12,6 +12,7 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include "options.h"
 #include "veclib3d.h"
 
 /* A structure to contain the projection information */
@@ -19,6 +20,10 @@ typedef struct projection_type {
     int    win_size_pixel[VEC_SIZE - 1]; /* Screen size in pixels            */
     double win_size_world[VEC_SIZE - 1]; /* Screen size in world coordinates */
     double view_point[VEC_SIZE];         /* Viewpoint point coordinates      */
+    int    camera;                       /* Set to map pixels by the camera  */
+    double corner[VEC_SIZE];             /* Camera: world point of pixel 0,0 */
+    double du[VEC_SIZE];                 /* Camera: width of the window      */
+    double dv[VEC_SIZE];                 /* Camera: height of the window     */
 } proj_t;
 
 /* Consumes a line from the specified file */
@@ -27,6 +32,12 @@ void consume_line(FILE *in);
 /* Initializes the projection information */
 proj_t *projection_init(int argc, char **argv, FILE *in);
 
+/* Reads the projection information for an image of the specified size */
+proj_t *projection_read(FILE *in, int width, int height);
+
+/* Sets up the look-at camera given by the rendering options, if any */
+void projection_camera(proj_t *proj, opts_t *opts);
+
 /* Dumps the projection information to the specified file */
 int projection_dump(FILE *out, proj_t *proj);
 
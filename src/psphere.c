@@ -13,6 +13,13 @@
 #include "mem.h"
 #include "veclib3d.h"
 
+/* Function pointers to sphere shading procedures */
+void (*sphere_shaders[NUM_SSHADERS])(obj_t *obj, double *ivec) = {
+    psphere0_amb, /* Alternating bands of color  */
+    psphere1_amb, /* Alternating colored circles */
+    psphere2_amb  /* Asymtotic color bands       */
+};
+
 /* 
  * psphere_init: Allocates memory for, initializes, and returns a new sphere.
  *
@@ -24,14 +24,10 @@ void psphere1_amb(obj_t *obj, double *ivec);
 /* Shader function for creating asymtotic color bands */
 void psphere2_amb(obj_t *obj, double *ivec);
 
-/* Function pointers to sphere shading procedures */
-static void (*sphere_shaders[])(obj_t *obj, double *ivec) = {
-    psphere0_amb, /* Alternating bands of color  */
-    psphere1_amb, /* Alternating colored circles */
-    psphere2_amb  /* Asymtotic color bands       */
-};
-
 /* The number of sphere shading functions */
-#define NUM_SSHADERS sizeof(sphere_shaders) / sizeof(void *)
+#define NUM_SSHADERS 3
+
+/* Function pointers to sphere shading procedures (see psphere.c) */
+extern void (*sphere_shaders[NUM_SSHADERS])(obj_t *obj, double *ivec);
 
 #endif
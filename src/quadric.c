@@ -0,0 +1,439 @@
+/*
+ * quadric.c: This file contains the implementation details for quadric
+ *            surfaces.  The cylinder, cone, paraboloid, and hyperboloid are
+ *            each read with their own parameters, but all of them are the
+ *            surface of revolution about an axis whose squared radius at
+ *            height h along the axis is r0 + r1 h + r2 h^2:
+ *
+ *              cylinder     r0 = radius^2
+ *              cone         r2 = tan(angle)^2
+ *              paraboloid   r1 = (radius at height 1)^2
+ *              hyperboloid  r0 = waist radius^2, r2 = tan(angle)^2
+ *
+ *            That surface is expanded once into the ten coefficients of the
+ *            implicit form in world coordinates, and every type is hit by
+ *            the same kernel, which solves one quadratic and keeps the
+ *            nearer root within the clipping heights.  Each surface may be
+ *            clipped to a range of heights, which also bounds it.
+ *
+ * Author:    Scott Gigawatt
+ *
+ * Version:   18 October 2026
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "quadric.h"
+#include "mem.h"
+#include "veclib3d.h"
+
+/* The coefficients of the implicit form */
+enum { QA, QB, QC, QD, QE, QF, QG, QH, QI, QJ };
+
+/*
+ * quadric_coefs: Expands the surface of revolution of a quadric into the
+ *                coefficients of the implicit form.  With v the offset from
+ *                the center and h = axis . v, the surface is
+ *
+ *                  v . v - (1 + r2) h^2 - r1 h - r0 = 0.
+ *
+ * Parameters:    quad - The quadric.
+ */
+static void quadric_coefs(quadric_t *quad) {
+    double *a = quad->axis;         /* The axis             */
+    double *c = quad->center;       /* The center           */
+    double *r = quad->radius;       /* The radius terms     */
+    double m[VEC_SIZE][VEC_SIZE];   /* The quadratic form   */
+    double mc[VEC_SIZE];            /* The form times c     */
+    int    i;                       /* Row index            */
+    int    j;                       /* Column index         */
+
+    for (i = 0; i < VEC_SIZE; ++i) {
+        for (j = 0; j < VEC_SIZE; ++j) {
+            m[i][j] = (i == j) - (1.0 + r[2]) * a[i] * a[j];
+        }
+    }
+
+    mat_xform3(m, c, mc);
+
+    quad->coef[QA] = m[0][0];
+    quad->coef[QB] = m[1][1];
+    quad->coef[QC] = m[2][2];
+    quad->coef[QD] = 2.0 * m[0][1];
+    quad->coef[QE] = 2.0 * m[0][2];
+    quad->coef[QF] = 2.0 * m[1][2];
+    quad->coef[QG] = -2.0 * mc[0] - r[1] * a[0];
+    quad->coef[QH] = -2.0 * mc[1] - r[1] * a[1];
+    quad->coef[QI] = -2.0 * mc[2] - r[1] * a[2];
+    quad->coef[QJ] = vec_dot3(c, mc) + r[1] * vec_dot3(a, c) - r[0];
+}
+
+/*
+ * quadric_init: Allocates memory for, initializes, and returns a new
+ *               quadric.  Every quadric gives its center, the direction of
+ *               its axis, its parameters, and the range of heights along
+ *               the axis to keep, which is unbounded if the first height is
+ *               not below the second.  The parameters are
+ *
+ *                 cylinder     radius
+ *                 cone         half angle (degrees)
+ *                 paraboloid   radius at height 1
+ *                 hyperboloid  waist radius, half angle of its asymptotes
+ *
+ * Parameters:   in      - The file containing the quadric specifications.
+ *               objtype - Represents the type of object to initialize.
+ *
+ * Return:       A pointer to the newly initialized quadric.
+ */
+obj_t *quadric_init(FILE *in, int objtype) {
+    obj_t     *obj = object_init(in, objtype);               /* The object */
+    quadric_t *new = (quadric_t *)Malloc(sizeof(quadric_t)); /* Quadric    */
+    int       count = objtype == HYPERBOLOID ? 2 : 1;        /* Parameters */
+    double    slope;                                         /* tan(angle) */
+
+    /* Link the quadric to the object structure */
+    obj->priv    = new;
+    obj->hits    = hits_quadric;
+    obj->rehits  = rehits_quadric;
+    obj->surface = quadric_surface;
+    obj->bounds  = quadric_bounds;
+    obj->move    = quadric_move;
+    obj->destroy = quadric_destroy;
+    obj->dump    = quadric_dump;
+
+    /* Read in the center and axis and check for errors */
+    if (vec_get3(in, new->center) != VEC_SIZE) {
+        msg_exit(stderr, "quadric_init: error: invalid read count");
+    }
+
+    consume_line(in);
+
+    if (vec_get3(in, new->axis) != VEC_SIZE ||
+        vec_length3(new->axis) == 0.0) {
+        msg_exit(stderr, "quadric_init: error: invalid axis");
+    }
+
+    consume_line(in);
+    vec_unit3(new->axis, new->axis);
+
+    /* Read in the parameters of the type and check for errors */
+    if (( count == 2 ? vec_get2(in, new->params) :
+                       vec_get1(in, new->params) ) != count) {
+        msg_exit(stderr, "quadric_init: error: invalid read count");
+    }
+
+    consume_line(in);
+
+    /* Read in the clipping heights and check for errors */
+    if (vec_get2(in, new->clip) != 2) {
+        msg_exit(stderr, "quadric_init: error: invalid read count");
+    }
+
+    consume_line(in);
+
+    /* Find the squared radius terms of the type */
+    new->radius[0] = new->radius[1] = new->radius[2] = 0.0;
+    new->params[1] = count == 2 ? new->params[1] : 0.0;
+    slope          = tan(new->params[count - 1] * M_PI / 180.0);
+
+    switch (objtype) {
+        case CYLINDER:
+            new->radius[0] = new->params[0] * new->params[0];
+            break;
+        case CONE:
+            new->radius[2] = slope * slope;
+            break;
+        case PARABOLOID:
+            new->radius[1] = new->params[0] * new->params[0];
+            break;
+        default:
+            new->radius[0] = new->params[0] * new->params[0];
+            new->radius[2] = slope * slope;
+            break;
+    }
+
+    if (objtype != PARABOLOID && new->radius[0] + new->radius[2] <= 0.0) {
+        msg_exit(stderr, "quadric_init: error: invalid parameters");
+    }
+
+    quadric_coefs(new);
+
+    return obj;
+}
+
+/*
+ * quadric_dump: Dumps the contents of the quadric object to the specified
+ *               output file.
+ *
+ * Parameters:   out - The file to which the quadric object will be dumped.
+ *               obj - The quadric object to dump.
+ *
+ * Return:       EXIT_SUCCESS if successful, EXIT_FAILURE otherwise.
+ */
+int quadric_dump(FILE *out, obj_t *obj) {
+    quadric_t *quad = (quadric_t *)obj->priv; /* The quadric to dump */
+    char      *name;                          /* The type name       */
+
+    switch (obj->objtype) {
+        case CYLINDER:   name = "Cylinder";    break;
+        case CONE:       name = "Cone";        break;
+        case PARABOLOID: name = "Paraboloid";  break;
+        default:         name = "Hyperboloid"; break;
+    }
+
+    fprintf(out, "Dumping object of type %s\n", name);
+
+    /* Print out the object reflectivity information */
+    material_dump(out, &obj->material);
+
+    /* Print out the quadric information */
+    fprintf(out, "\n%s data\n", name);
+    vec_prn3(out, "center - ", quad->center);
+    vec_prn3(out, "axis   - ", quad->axis);
+    vec_prn2(out, "params - ", quad->params);
+    vec_prn2(out, "clip   - ", quad->clip);
+
+    return EXIT_SUCCESS;
+}
+
+/*
+ * quadric_solve: The intersection kernel shared by every quadric.  Solves
+ *                for the distances at which a ray meets the implicit form,
+ *                and keeps the nearer one between tmin and tmax whose
+ *                height along the axis is within the clipping heights.  Both
+ *                roots are found and tested the same way, without branching
+ *                on the type of surface.
+ *
+ * Parameters:    coef  - The coefficients A to J of the implicit form.
+ *                base  - The base location of the ray.
+ *                dir   - The unit vector direction of the ray.
+ *                tmin  - Hits at or before this distance are misses.
+ *                tmax  - Hits at or beyond this distance are misses.
+ *                clip  - The heights kept, or all of them if clip[0] is not
+ *                        below clip[1].
+ *                hbase - The height of the base along the axis.
+ *                hdir  - The rate of change of the height along the ray.
+ *
+ * Return:        The distance to the hit location, or MISS.
+ */
+double quadric_solve(double *coef, double *base, double *dir, double tmin,
+                     double tmax, double *clip, double hbase, double hdir) {
+    double x  = base[0]; /* The base location (x)     */
+    double y  = base[1]; /* The base location (y)     */
+    double z  = base[2]; /* The base location (z)     */
+    double dx = dir[0];  /* The direction (x)         */
+    double dy = dir[1];  /* The direction (y)         */
+    double dz = dir[2];  /* The direction (z)         */
+    double a;            /* The coefficient of t^2    */
+    double b;            /* The coefficient of t      */
+    double c;            /* The constant term         */
+    double disc;         /* The discriminant          */
+    double q;            /* The stable root term      */
+    double t[2];         /* The roots, nearer first   */
+    double h;            /* A height along the axis   */
+    int    i;            /* Root index                */
+
+    a = coef[QA] * dx * dx + coef[QB] * dy * dy + coef[QC] * dz * dz +
+        coef[QD] * dx * dy + coef[QE] * dx * dz + coef[QF] * dy * dz;
+    b = 2.0 * (coef[QA] * x * dx + coef[QB] * y * dy + coef[QC] * z * dz) +
+        coef[QD] * (x * dy + y * dx) + coef[QE] * (x * dz + z * dx) +
+        coef[QF] * (y * dz + z * dy) +
+        coef[QG] * dx + coef[QH] * dy + coef[QI] * dz;
+    c = coef[QA] * x * x + coef[QB] * y * y + coef[QC] * z * z +
+        coef[QD] * x * y + coef[QE] * x * z + coef[QF] * y * z +
+        coef[QG] * x + coef[QH] * y + coef[QI] * z + coef[QJ];
+
+    /* A ray along the surface meets it once, if at all */
+    if (fabs(a) < 1e-12) {
+        t[0] = b != 0.0 ? -c / b : MISS;
+        t[1] = MISS;
+    } else if ((disc = b * b - 4.0 * a * c) < 0.0) {
+        return MISS;
+    } else {
+        q    = -0.5 * (b + copysign(sqrt(disc), b));
+        t[0] = q / a;
+        t[1] = q != 0.0 ? c / q : t[0];
+
+        if (t[1] < t[0]) {
+            q    = t[0];
+            t[0] = t[1];
+            t[1] = q;
+        }
+    }
+
+    for (i = 0; i < 2; ++i) {
+        h = hbase + t[i] * hdir;
+
+        if (t[i] > tmin && t[i] < tmax &&
+            (clip[0] >= clip[1] || (h >= clip[0] && h <= clip[1]))) {
+            return t[i];
+        }
+    }
+
+    return MISS;
+}
+
+/*
+ * trace_quadric: Finds the distance at which a ray hits a quadric object.
+ *
+ * Parameters:    base - The base location of the ray.
+ *                dir  - The unit vector direction of the ray.
+ *                tmin - Hits at or before this distance are misses.
+ *                tmax - Hits at or beyond this distance are misses.
+ *                obj  - The quadric object to test.
+ *
+ * Return:        The distance to the hit location, or MISS.
+ */
+static double trace_quadric(double *base, double *dir, double tmin,
+                            double tmax, obj_t *obj) {
+    quadric_t *quad = (quadric_t *)obj->priv; /* The quadric       */
+    double    view[VEC_SIZE];                 /* Base from center  */
+
+    vec_diff3(quad->center, base, view);
+
+    return quadric_solve(quad->coef, base, dir, tmin, tmax, quad->clip,
+                         vec_dot3(view, quad->axis),
+                         vec_dot3(dir, quad->axis));
+}
+
+/*
+ * hits_quadric: Determines if a ray hits a quadric object, returning the
+ *               distance to the nearest point on it.
+ *
+ * Parameters:   base - The base location of the ray.
+ *               dir  - The unit vector direction of the ray.
+ *               tmin - Hits at or before this distance are misses.
+ *               tmax - Hits at or beyond this distance are misses.
+ *               obj  - The quadric object to test.
+ *
+ * Return:       The distance to the hit location, or MISS.
+ */
+double hits_quadric(double *base, double *dir, double tmin, double tmax,
+                    obj_t *obj) {
+    return trace_quadric(base, dir, tmin, tmax, obj);
+}
+
+/*
+ * rehits_quadric: Determines if a ray leaving a quadric object hits it
+ *                 again, such as a reflection inside a cylinder, skipping
+ *                 the point the ray leaves.
+ *
+ * Parameters:     base - The base location of the ray.
+ *                 dir  - The unit vector direction of the ray.
+ *                 tmin - Hits at or before this distance are misses.
+ *                 tmax - Hits at or beyond this distance are misses.
+ *                 obj  - The quadric object the ray leaves.
+ *
+ * Return:         The distance to the hit location, or MISS.
+ */
+double rehits_quadric(double *base, double *dir, double tmin, double tmax,
+                      obj_t *obj) {
+    return trace_quadric(base, dir, tmin + QUADRIC_EPSILON, tmax, obj);
+}
+
+/*
+ * quadric_surface: Computes the hit location and normal of a ray that hit a
+ *                  quadric object.  The normal is the gradient of the
+ *                  implicit form, turned to face the ray, since the inside
+ *                  of a clipped surface can be seen.
+ *
+ * Parameters:      base - The base location of the ray.
+ *                  dir  - The unit vector direction of the ray.
+ *                  dist - The distance returned by hits_quadric.
+ *                  obj  - The quadric object that was hit.
+ */
+void quadric_surface(double *base, double *dir, double dist, obj_t *obj) {
+    quadric_t *quad = (quadric_t *)obj->priv; /* The quadric        */
+    double    *coef = quad->coef;             /* Its coefficients   */
+    double    *p    = obj->hitloc;            /* The hit location   */
+    double    normal[VEC_SIZE];               /* The gradient there */
+
+    /* Save the hit location */
+    vec_scale3(dist, dir, obj->hitloc);
+    vec_sum3(base, obj->hitloc, obj->hitloc);
+
+    /* Save the unit normal, facing the ray */
+    normal[0] = 2.0 * coef[QA] * p[0] + coef[QD] * p[1] + coef[QE] * p[2] +
+                coef[QG];
+    normal[1] = 2.0 * coef[QB] * p[1] + coef[QD] * p[0] + coef[QF] * p[2] +
+                coef[QH];
+    normal[2] = 2.0 * coef[QC] * p[2] + coef[QE] * p[0] + coef[QF] * p[1] +
+                coef[QI];
+    vec_unit3(normal, obj->normal);
+
+    if (vec_dot3(obj->normal, dir) > 0.0) {
+        vec_scale3(-1.0, obj->normal, obj->normal);
+    }
+}
+
+/*
+ * quadric_bounds: Finds the bounding box of a clipped quadric object.  The
+ *                 squared radius never curves down along the axis, so the
+ *                 widest circle is at one of the clipping heights, and the
+ *                 box is that of two circles of that radius at both heights.
+ *
+ * Parameters:     obj - The quadric object.
+ *                 lo  - Storage for the low corner of the box.
+ *                 hi  - Storage for the high corner of the box.
+ *
+ * Return:         Nonzero if the quadric is clipped, zero otherwise.
+ */
+int quadric_bounds(obj_t *obj, double *lo, double *hi) {
+    quadric_t *quad = (quadric_t *)obj->priv; /* The quadric            */
+    double    *r    = quad->radius;           /* The radius terms       */
+    double    end[2];                         /* Squared radius at ends */
+    double    width;                          /* The widest radius      */
+    double    reach;                          /* Its reach on an axis   */
+    double    p;                              /* A clipping point       */
+    int       i;                              /* End index              */
+    int       j;                              /* Axis index             */
+
+    if (quad->clip[0] >= quad->clip[1]) {
+        return 0;
+    }
+
+    for (i = 0; i < 2; ++i) {
+        end[i] = r[0] + r[1] * quad->clip[i] + r[2] * quad->clip[i] *
+                                                      quad->clip[i];
+    }
+
+    width = sqrt(fmax(0.0, fmax(end[0], end[1])));
+
+    for (j = 0; j < VEC_SIZE; ++j) {
+        reach = width * sqrt(fmax(0.0, 1.0 - quad->axis[j] * quad->axis[j]));
+        lo[j] = HUGE_VAL;
+        hi[j] = -HUGE_VAL;
+
+        for (i = 0; i < 2; ++i) {
+            p     = quad->center[j] + quad->clip[i] * quad->axis[j];
+            lo[j] = fmin(lo[j], p - reach);
+            hi[j] = fmax(hi[j], p + reach);
+        }
+    }
+
+    return 1;
+}
+
+/*
+ * quadric_move: Translates the specified quadric object by an offset.
+ *
+ * Parameters:   obj    - The quadric object to move.
+ *               offset - The translation (x, y, z).
+ */
+void quadric_move(obj_t *obj, double *offset) {
+    quadric_t *quad = (quadric_t *)obj->priv; /* The quadric to move */
+
+    vec_sum3(quad->center, offset, quad->center);
+    quadric_coefs(quad);
+}
+
+/*
+ * quadric_destroy: Destroys the specified quadric object.
+ *
+ * Parameters:      obj - The quadric object to destroy.
+ */
+void quadric_destroy(obj_t *obj) {
+    /* Release memory associated with the quadric object */
+    Free(obj->priv);
+}
@@ -0,0 +1,71 @@
+/*
+ * quadric.h: This header file contains the implementation specifications
+ *            for quadric surfaces: the cylinder, cone, paraboloid, and
+ *            hyperboloid.
+ *
+ * Author:    Scott Gigawatt
+ *
+ * Version:   18 October 2026
+ */
+
+#ifndef QUADRIC_H
+#define QUADRIC_H
+
+#include "object.h"
+
+/* The number of coefficients of the implicit form */
+#define QUADRIC_COEFS 10
+
+/* The distance a ray leaving a quadric travels before it can hit it again */
+#ifndef QUADRIC_EPSILON
+    #define QUADRIC_EPSILON 1e-6
+#endif
+
+/*
+ * Quadric, stored as the coefficients of the implicit form
+ *
+ *   A x^2 + B y^2 + C z^2 + D xy + E xz + F yz + G x + H y + I z + J = 0
+ *
+ * in world coordinates, from a surface of revolution about an axis whose
+ * squared radius at height h along the axis is r0 + r1 h + r2 h^2.
+ */
+typedef struct quadric_type {
+    double coef[QUADRIC_COEFS]; /* The coefficients A to J              */
+    double center[VEC_SIZE];    /* The center (x, y, z)                 */
+    double axis[VEC_SIZE];      /* The unit axis (x, y, z)              */
+    double params[2];           /* The parameters, as read              */
+    double radius[VEC_SIZE];    /* Squared radius coefficients r0 to r2 */
+    double clip[2];             /* The heights kept, if clip[0] < [1]   */
+} quadric_t;
+
+/* Allocates memory for, initializes, and returns a new quadric */
+obj_t *quadric_init(FILE *in, int objtype);
+
+/* Dumps the contents of the quadric object to the specified file */
+int quadric_dump(FILE *out, obj_t *obj);
+
+/* Finds the distance to the nearest hit of a ray on a quadric */
+double quadric_solve(double *coef, double *base, double *dir, double tmin,
+                     double tmax, double *clip, double hbase, double hdir);
+
+/* Determines if a ray hits a quadric object */
+double hits_quadric(double *base, double *dir, double tmin, double tmax,
+                    obj_t *obj);
+
+/* Determines if a ray leaving a quadric object hits it again */
+double rehits_quadric(double *base, double *dir, double tmin, double tmax,
+                      obj_t *obj);
+
+/* Computes the hit location and normal of a ray that hit a quadric object */
+void quadric_surface(double *base, double *dir, double dist, obj_t *obj);
+
+/* Finds the bounding box of a quadric object */
+int quadric_bounds(obj_t *obj, double *lo, double *hi);
+
+/* Translates the specified quadric object by an offset */
+void quadric_move(obj_t *obj, double *offset);
+
+/* Destroys the specified quadric object */
+void quadric_destroy(obj_t *obj);
+
+#endif
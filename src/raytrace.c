@@ -8,12 +8,100 @@
  */
 
 #include <limits.h>
+#include <math.h>
 #include "raytrace.h"
+#include "bvh.h"
+#include "deps.h"
 #include "veclib3d.h"
 
+/* A ray waiting on the work stack of ray_trace */
+typedef struct ray_work_type {
+    double base[VEC_SIZE];   /* The origin of the ray                 */
+    double dir[VEC_SIZE];    /* The unit direction of the ray         */
+    double weight[VEC_SIZE]; /* The share of the intensity it carries */
+    double total_dist;       /* The distance traveled before it       */
+    obj_t  *last_hit;        /* The object it leaves, or NULL         */
+    int    depth;            /* Reflections and refractions before it */
+} ray_work_t;
+
+/*
+ * push_ray:   Puts a ray reflected or refracted at a hit on the work stack,
+ *             unless it would be deeper than RAY_DEPTH, or carry less than
+ *             RAY_MIN_WEIGHT of the intensity in every color.
+ *
+ * Parameters: stack      - The work stack.
+ *             count      - A pointer to the number of rays on the stack.
+ *             parent     - The ray that made the hit.
+ *             hitobj     - The object hit, which the new ray leaves.
+ *             dir        - The unit direction of the new ray.
+ *             share      - The share (r, g, b) of the parent's intensity.
+ *             total_dist - The distance traveled to the hit.
+ */
+static void push_ray(ray_work_t *stack, int *count, ray_work_t *parent,
+                     obj_t *hitobj, double *dir, double *share,
+                     double total_dist) {
+    ray_work_t *ray = &stack[*count]; /* The new ray                 */
+    double     most = 0.0;            /* Its largest share of a color */
+    int        i;                     /* Counter                     */
+
+    if (parent->depth >= RAY_DEPTH) {
+        return;
+    }
+
+    vec_mul3(parent->weight, share, ray->weight);
+
+    for (i = 0; i < VEC_SIZE; ++i) {
+        most = fabs(ray->weight[i]) > most ? fabs(ray->weight[i]) : most;
+    }
+
+    if (most < RAY_MIN_WEIGHT) {
+        return;
+    }
+
+    /* Copy the origin, since testing the object again overwrites hitloc */
+    vec_scale3(1.0, hitobj->hitloc, ray->base);
+    vec_scale3(1.0, dir, ray->dir);
+    ray->total_dist = total_dist;
+    ray->last_hit   = hitobj;
+    ray->depth      = parent->depth + 1;
+    ++*count;
+}
+
+/*
+ * fresnel:    Finds the fraction of light reflected where a ray meets the
+ *             surface between two clear materials, by the Fresnel
+ *             equations for unpolarized light.
+ *
+ * Parameters: cosi - The cosine of the ray with the normal.
+ *             cost - The cosine of the refracted ray with the normal.
+ *             eta  - The index of refraction on the side the ray comes
+ *                    from over that of the side it enters.
+ *
+ * Return:     The fraction reflected, 0 to 1; the rest is refracted.
+ */
+static double fresnel(double cosi, double cost, double eta) {
+    double s = (eta * cosi - cost) / (eta * cosi + cost); /* Perpendicular */
+    double p = (cosi - eta * cost) / (cosi + eta * cost); /* Parallel      */
+
+    return (s * s + p * p) / 2.0;
+}
+
 /*
  * ray_trace:  This function traces a single ray and returns the composite 
- *             intensity of the light it encounters. 
+ *             intensity of the light it encounters.  The rays reflected
+ *             and refracted at each hit are kept on a work stack, not
+ *             traced by recursion, each with the share of the intensity it
+ *             carries, so that the paths through a scene of mirrors and
+ *             glass are bounded both in depth (RAY_DEPTH) and in the least
+ *             share worth tracing (RAY_MIN_WEIGHT).  Since the stack is
+ *             taken newest first and a hit adds at most two rays, it never
+ *             holds more than RAY_DEPTH + 1 of them.
+ *
+ *             A transparent object (see gettrans) reflects and refracts
+ *             each ray in the shares the Fresnel equations give, scaling
+ *             the refracted ray by its transmission; a ray that cannot
+ *             leave it is wholly reflected.  Other objects reflect rays in
+ *             proportion to their specular reflectivity.
  *
  * Parameters: model      - A pointer to the model container.
  *             base       - The viewer location (x, y, z), or previous hit.
@@ -24,85 +112,148 @@
  */
 void ray_trace(model_t *model, double *base, double *dir, double *ivec, 
                                        double total_dist, obj_t *last_hit) {
-    obj_t  *closest          = NULL;              /* The closest object    */
-    double specref[VEC_SIZE] = { 0.0, 0.0, 0.0 }; /* Specular reflectivity */
-    double mindist;                               /* The minimum distance  */
+    ray_work_t stack[RAY_DEPTH + 1];   /* The rays left to trace        */
+    ray_work_t ray;                    /* The ray being traced          */
+    obj_t      *closest = NULL;        /* The closest object            */
+    double     local[VEC_SIZE];        /* Intensity at the hit          */
+    double     specref[VEC_SIZE];      /* Specular reflectivity         */
+    double     trans[VEC_SIZE];        /* Transmission                  */
+    double     share[VEC_SIZE];        /* Share of a new ray            */
+    double     norm[VEC_SIZE];         /* Unit normal facing the ray    */
+    double     refdir[VEC_SIZE];       /* Reflection direction          */
+    double     transdir[VEC_SIZE];     /* Refraction direction          */
+    double     mindist;                /* The minimum distance          */
+    double     ior;                    /* Index of refraction           */
+    double     eta;                    /* Ratio of indices at the hit   */
+    double     cost;                   /* Cosine of the refracted ray   */
+    double     reflect;                /* Fraction reflected            */
+    int        count = 1;              /* Rays on the stack             */
+    int        i;                      /* Counter                       */
 
-    /* Termination condition for specular reflectivity */
-    if (total_dist > MAX_DIST) {
-        return;
-    }
-    
-    /* Find the closest object */
-    closest = find_closest_obj(model->scene, base, dir, NULL, &mindist);
+    vec_scale3(1.0, base, stack[0].base);
+    vec_scale3(1.0, dir, stack[0].dir);
+    stack[0].weight[0]  = stack[0].weight[1] = stack[0].weight[2] = 1.0;
+    stack[0].total_dist = total_dist;
+    stack[0].last_hit   = last_hit;
+    stack[0].depth      = 0;
 
-    if (closest == NULL) {
-        return;
-    }
-    
-    /* Find the new total distance */
-    total_dist += mindist;
-
-    /* Get the ambient lighting information from the object */
-    closest->getamb(closest, ivec);
-    closest->getspec(closest, specref);
-    
-    /* Compute the diffuse lighting information for the object */
-    diffuse_illumination(model, closest, ivec);
-
-    /* Divide the intensity by the total distance */
-    vec_scale3(1.0 / total_dist, ivec, ivec);
-
-    /* Check to see if object has specular reflectivity */
-    if ( vec_dot3(specref, specref) > 0 ) {
-        double specint[VEC_SIZE] = { 0.0, 0.0, 0.0 }; /* Specular intensity */
-        double refdir[VEC_SIZE]  = { 0.0, 0.0, 0.0 }; /* Reflection dir     */
-        double norm[VEC_SIZE]    = { 0.0, 0.0, 0.0 }; /* Unit vector normal */
-
-        /* Compute direction of reflection */
-        vec_unit3(closest->normal, norm);
-        vec_reflect3(dir, norm, refdir);
-
-        /* Recursively call raytrace to get specular reflectivity */
-        ray_trace(model, closest->hitloc, refdir, specint, total_dist, closest);
-
-        /* Multiply specint by specref and store in specref */
-        vec_mul3(specint, specref, specref);
-    }
+    while (count > 0) {
+        ray = stack[--count];
+
+        /* Termination condition for specular reflectivity */
+        if (ray.total_dist > MAX_DIST) {
+            continue;
+        }
+
+        /* Find the closest object, other than the part of it the ray
+           leaves */
+        closest = find_closest_obj(model, ray.base, ray.dir, ray.last_hit,
+                                   &mindist);
+
+        /* Record the ray for incremental renders */
+        if (model->deps) {
+            deps_ray(model->deps, ray.base, ray.dir, mindist, closest);
+        }
+
+        if (closest == NULL) {
+            continue;
+        }
+
+        /* The intensity is set once the first ray hits */
+        if (ray.depth == 0) {
+            vec_scale3(0.0, ivec, ivec);
+        }
+
+        /* Find the new total distance */
+        ray.total_dist += mindist;
+
+        /* Get the ambient and diffuse lighting information at the hit */
+        closest->getamb(closest, local);
+        diffuse_illumination(model, closest, ray.last_hit == NULL, local);
+
+        /* Divide the intensity by the total distance, and add its share */
+        vec_scale3(1.0 / ray.total_dist, local, local);
+
+        for (i = 0; i < VEC_SIZE; ++i) {
+            ivec[i] += ray.weight[i] * local[i];
+        }
+
+        if ( (ior = closest->gettrans(closest, trans)) > 0.0 ) {
+            /* Face the normal against the ray, inside the object or out */
+            vec_unit3(closest->normal, norm);
+            eta = 1.0 / ior;
+
+            if (vec_dot3(ray.dir, norm) > 0.0) {
+                vec_scale3(-1.0, norm, norm);
+                eta = ior;
+            }
+
+            /* Split the ray, unless it is totally internally reflected */
+            reflect = 1.0;
+
+            if ( (cost = vec_refract3(ray.dir, norm, eta, transdir)) > 0.0 ) {
+                reflect = fresnel(-vec_dot3(ray.dir, norm), cost, eta);
+
+                for (i = 0; i < VEC_SIZE; ++i) {
+                    share[i] = (1.0 - reflect) * trans[i];
+                }
+
+                push_ray(stack, &count, &ray, closest, transdir, share,
+                         ray.total_dist);
+            }
 
-    /* Add specular reflectivity to the intensity vector */
-    vec_sum3(ivec, specref, ivec);
-
-    /* Hit function debugging information */
-    #ifdef DBG_HIT
-        fprintf(stderr, "HIT %4d: %5.1lf (%5.1lf, %5.1lf, %5.1lf) - ",
-                                    closest->objid, mindist,
-                                    closest->hitloc[0], 
-                                    closest->hitloc[1],
-                                    closest->hitloc[2]);
-    #endif
-
-    /* Ambient light debugging information */
-    #ifdef DBG_AMB
-        fprintf(stderr, "AMB (%5.1lf, %5.1lf, %5.1lf) - ", *(ivec),
-                                                           *(ivec + 1),
-                                                           *(ivec + 2));
-    #endif
-
-    /* Diffuse light debugging information */
-    #ifdef DBG_DIFFUSE
-        fprintf(stderr, "DIFFUSE (%5.1lf, %5.1lf, %5.1lf) - ", *(ivec),
-                                                               *(ivec + 1),
-                                                               *(ivec + 2));
-    #endif
+            vec_reflect3(ray.dir, norm, refdir);
+            share[0] = share[1] = share[2] = reflect;
+            push_ray(stack, &count, &ray, closest, refdir, share,
+                     ray.total_dist);
+        } else {
+            /* Check to see if object has specular reflectivity */
+            closest->getspec(closest, specref);
+
+            if ( vec_dot3(specref, specref) > 0 ) {
+                vec_unit3(closest->normal, norm);
+                vec_reflect3(ray.dir, norm, refdir);
+                push_ray(stack, &count, &ray, closest, refdir, specref,
+                         ray.total_dist);
+            }
+        }
+
+        /* Hit function debugging information */
+        #ifdef DBG_HIT
+            fprintf(stderr, "HIT %4d: %5.1lf (%5.1lf, %5.1lf, %5.1lf) - ",
+                                        closest->objid, mindist,
+                                        closest->hitloc[0], 
+                                        closest->hitloc[1],
+                                        closest->hitloc[2]);
+        #endif
+
+        /* Ambient light debugging information */
+        #ifdef DBG_AMB
+            fprintf(stderr, "AMB (%5.1lf, %5.1lf, %5.1lf) - ", *(local),
+                                                               *(local + 1),
+                                                               *(local + 2));
+        #endif
+
+        /* Diffuse light debugging information */
+        #ifdef DBG_DIFFUSE
+            fprintf(stderr, "DIFFUSE (%5.1lf, %5.1lf, %5.1lf) - ",
+                                                               *(local),
+                                                               *(local + 1),
+                                                               *(local + 2));
+        #endif
+    }
 }
 
 /*
  * find_closest_obj: This function determines the nearest object that is hit
  *                   by the ray.  If none of the objects in the scene is hit,
- *                   NULL is returned.
+ *                   NULL is returned.  The closest distance found so far is
+ *                   passed to each hits function as its upper bound, so
+ *                   objects behind it are rejected early, and the hit
+ *                   location and normal are computed only for the closest
+ *                   object.
  *
- * Parameters:       scene    - A pointer to the scene.
+ * Parameters:       model    - A pointer to the model containing the scene.
  *                   base     - The viewer location (x, y, z), or previous hit.
  *                   dir      - Unit vector (x, y, z) direction to the object.
  *                   last_hit - The object that reflected this ray or NULL.
@@ -110,23 +261,24 @@ void ray_trace(model_t *model, double *base, double *dir, double *ivec,
  *
  * Return:           The closest object in the scene.
  */
-obj_t *find_closest_obj(list_t *scene, double *base, double *dir, 
+obj_t *find_closest_obj(model_t *model, double *base, double *dir, 
                                        obj_t *last_hit, double *min_dist) {
     obj_t  *obj     = NULL;    /* The current object in the scene */
     obj_t  *closest = NULL;    /* The closest object              */
-    link_t *cursor  = NULL;    /* Cursor into the scene list      */
     double min      = INT_MAX; /* The minimum distance            */
     double dist;               /* The current object's distance   */
+    int    i;                  /* Index into the traversal array  */
 
     /* Iterate over the scene objects */
-    for (cursor = scene->head; cursor; cursor = cursor->next) {
+    for (i = 0; i < model->num_objs; ++i) {
         /* Get the current object */
-        obj = (obj_t *)cursor->item;
+        obj = model->objs[i];
 
-        /* Do not check the same object twice */
-        if (obj != last_hit) {
+        /* Do not check the same object twice, unless it can hit itself */
+        if (obj != last_hit || obj->rehits) {
             /* Find distance to object */
-            dist = obj->hits(base, dir, obj);
+            dist = obj != last_hit ? obj->hits(base, dir, 0.0, min, obj) :
+                                     obj->rehits(base, dir, 0.0, min, obj);
 
             /* Check to see if the object is the closest */
             if (dist < min && dist > 0.0) {
@@ -141,8 +293,140 @@ obj_t *find_closest_obj(list_t *scene, double *base, double *dir,
         }
     }
 
+    /* Find the closest instance, through the top level hierarchy */
+    if (model->insts &&
+        (obj = bvh_hits(model->insts, base, dir, 0.0, &min, last_hit, 0))) {
+        closest = obj;
+    }
+
+    /* Compute the surface information and count the hit for ordering */
+    if (closest != NULL) {
+        closest->surface(base, dir, min, closest);
+        if (model->opts->reorder) {
+            ++closest->nhits;
+        }
+    }
+
     /* Set the new minimum distance */
     *min_dist = min;
 
     return closest;
 }
+
+/*
+ * find_occluder: This function determines whether any object in the scene
+ *                is hit by the ray closer than the specified distance,
+ *                stopping at the first such object.  Used for shadow rays,
+ *                which only need to know whether the light is blocked.
+ *
+ * Parameters:    model    - A pointer to the model containing the scene.
+ *                base     - The hit location (x, y, z) to test from.
+ *                dir      - Unit vector (x, y, z) direction of the ray.
+ *                last_hit - The object the ray leaves, which is skipped.
+ *                max_dist - The distance beyond which hits are ignored.
+ *                dist     - Storage for the distance to the occluder.
+ *
+ * Return:        The first occluding object found, or NULL.
+ */
+obj_t *find_occluder(model_t *model, double *base, double *dir,
+                     obj_t *last_hit, double max_dist, double *dist) {
+    obj_t *obj = NULL; /* The current object in the scene */
+    int   i;           /* Index into the traversal array  */
+
+    /* Iterate over the scene objects */
+    for (i = 0; i < model->num_objs; ++i) {
+        obj = model->objs[i];
+
+        /* Stop at the first object hit before the maximum distance */
+        if ((obj != last_hit || obj->rehits) &&
+                (*dist = object_hits(obj, base, dir, 0.0, max_dist,
+                                     last_hit)) > 0.0) {
+            if (model->opts->reorder) {
+                ++obj->nhits;
+            }
+            return obj;
+        }
+    }
+
+    /* Stop at the first instance hit */
+    if (model->insts &&
+        (obj = bvh_hits(model->insts, base, dir, 0.0, &max_dist, last_hit,
+                        1))) {
+        *dist = max_dist;
+        if (model->opts->reorder) {
+            ++obj->nhits;
+        }
+        return obj;
+    }
+
+    return NULL;
+}
+
+/*
+ * find_occluders: This function determines which of a batch of rays from
+ *                 one point are blocked before their distances, such as
+ *                 the shadow rays toward the points of a light with an
+ *                 area.  Each object is tested against every ray still
+ *                 unblocked before moving on to the next, so its data is
+ *                 fetched once for the batch, and testing stops once every
+ *                 ray is blocked.
+ *
+ * Parameters:     model    - A pointer to the model containing the scene.
+ *                 base     - The hit location (x, y, z) to test from.
+ *                 dirs     - The unit directions (x, y, z) of the rays.
+ *                 dists    - The distances beyond which hits are ignored.
+ *                 count    - The number of rays.
+ *                 last_hit - The object the rays leave, which is skipped.
+ *                 blocked  - Set for each ray that is blocked; rays already
+ *                            set are not tested.
+ *
+ * Return:         The number of rays left unblocked.
+ */
+int find_occluders(model_t *model, double *base, double (*dirs)[VEC_SIZE],
+                   double *dists, int count, obj_t *last_hit, char *blocked) {
+    obj_t  *obj  = NULL; /* The current object in the scene */
+    double max_dist;     /* The distance along a ray        */
+    int    left  = 0;    /* The rays left unblocked         */
+    int    i;            /* Index into the traversal array  */
+    int    j;            /* Index into the rays             */
+
+    for (j = 0; j < count; ++j) {
+        left += !blocked[j];
+    }
+
+    /* Iterate over the scene objects */
+    for (i = 0; i < model->num_objs && left > 0; ++i) {
+        obj = model->objs[i];
+
+        if (obj == last_hit && !obj->rehits) {
+            continue;
+        }
+
+        for (j = 0; j < count; ++j) {
+            if (!blocked[j] && object_hits(obj, base, dirs[j], 0.0, dists[j],
+                                           last_hit) > 0.0) {
+                blocked[j] = 1;
+                if (model->opts->reorder) {
+                    ++obj->nhits;
+                }
+                --left;
+            }
+        }
+    }
+
+    /* Then the instances */
+    for (j = 0; j < count && model->insts && left > 0; ++j) {
+        max_dist = dists[j];
+
+        if (!blocked[j] && (obj = bvh_hits(model->insts, base, dirs[j], 0.0,
+                                           &max_dist, last_hit, 1))) {
+            blocked[j] = 1;
+            if (model->opts->reorder) {
+                ++obj->nhits;
+            }
+            --left;
+        }
+    }
+
+    return left;
+}
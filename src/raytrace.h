@@ -13,15 +13,34 @@
 #include "object.h"
 //#include "model.h"
 
+/* The most reflections and refractions along one path from the view point */
+#ifndef RAY_DEPTH
+    #define RAY_DEPTH 16
+#endif
+
+/* The least share of the intensity a reflected or refracted ray may carry */
+#ifndef RAY_MIN_WEIGHT
+    #define RAY_MIN_WEIGHT 1e-3
+#endif
+
 /* Processes the diffuse light information for the world objects */
-void diffuse_illumination(model_t *model, obj_t *hitobj, double *ivec);
+void diffuse_illumination(model_t *model, obj_t *hitobj, int primary,
+                          double *ivec);
 
 /* Traces a single ray and returns the intensity of the light encountered */
 void ray_trace(model_t *model, double *base, double *dir, double *ivec,
                                double total_dist, obj_t *last_hit);
 
 /* Determines the nearest object that is hit by the ray */
-obj_t *find_closest_obj(list_t *scene, double *base, double *dir,
+obj_t *find_closest_obj(model_t *model, double *base, double *dir,
                         obj_t *last_hit, double *min_dist);
 
+/* Determines whether any object is hit by the ray before max_dist */
+obj_t *find_occluder(model_t *model, double *base, double *dir,
+                     obj_t *last_hit, double max_dist, double *dist);
+
+/* Determines which of a batch of rays from one point are blocked */
+int find_occluders(model_t *model, double *base, double (*dirs)[VEC_SIZE],
+                   double *dists, int count, obj_t *last_hit, char *blocked);
+
 #endif
@@ -0,0 +1,178 @@
+/*
+ * refsphere.c: This file contains the implementation details for a
+ *              refractive sphere.  Where a ray meets the sphere, part of it
+ *              is reflected and the rest refracted into (or out of) the
+ *              sphere, in the shares given by the Fresnel equations (see
+ *              ray_trace).  Rays refracted into the sphere travel inside it,
+ *              so unlike a plain sphere it is hit from within as well.
+ *
+ * Author:      Scott Gigawatt
+ *
+ * Version:     18 October 2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "refsphere.h"
+#include "mem.h"
+#include "veclib3d.h"
+
+/*
+ * refsphere_init: Allocates memory for, initializes, and returns a new
+ *                 refractive sphere.  After the sphere come its index of
+ *                 refraction and the fraction of each color it lets
+ *                 through each time a ray passes its surface.
+ *
+ * Parameters:     in      - The file containing the sphere specifications.
+ *                 objtype - Represents the type of object to initialize.
+ *
+ * Return:         A pointer to the newly initialized refractive sphere.
+ */
+obj_t *refsphere_init(FILE *in, int objtype) {
+    obj_t       *obj    = sphere_init(in, objtype);    /* The object     */
+    sphere_t    *sphere = (sphere_t *)obj->priv;       /* The sphere     */
+    refsphere_t *new    = (refsphere_t *)Malloc(sizeof(refsphere_t));
+
+    /* Link the refractive sphere and override the sphere functions */
+    sphere->priv  = new;
+    obj->hits     = hits_refsphere;
+    obj->rehits   = rehits_refsphere;
+    obj->gettrans = refsphere_trans;
+    obj->destroy  = refsphere_destroy;
+    obj->dump     = refsphere_dump;
+
+    /* Get the index of refraction and check for errors */
+    if (vec_get1(in, &new->ior) != 1 || new->ior <= 0.0) {
+        msg_exit(stderr, "refsphere_init: error: invalid index of refraction");
+    }
+
+    consume_line(in);
+
+    /* Get the transmission and check for errors */
+    if (vec_get3(in, new->transmission) != VEC_SIZE) {
+        msg_exit(stderr, "refsphere_init: error: invalid read count");
+    }
+
+    consume_line(in);
+
+    return obj;
+}
+
+/*
+ * refsphere_dump: Dumps the contents of the refractive sphere object to the
+ *                 specified output file.
+ *
+ * Parameters:     out - The file to which the sphere object will be dumped.
+ *                 obj - The sphere object to dump.
+ *
+ * Return:         EXIT_SUCCESS if successful, EXIT_FAILURE otherwise.
+ */
+int refsphere_dump(FILE *out, obj_t *obj) {
+    sphere_t    *sphere = (sphere_t *)obj->priv;       /* The sphere     */
+    refsphere_t *ref    = (refsphere_t *)sphere->priv; /* Its refraction */
+
+    fprintf(out, "Dumping object of type RefSphere\n");
+
+    /* Dump standard sphere data */
+    sphere_dump(out, obj);
+
+    /* Print out the refraction information */
+    fprintf(out, "\nRefSphere data\n");
+    vec_prn1(out, "index of refraction - ", &ref->ior);
+    vec_prn3(out, "transmission - ", ref->transmission);
+
+    return EXIT_SUCCESS;
+}
+
+/*
+ * hits_refsphere: Determines if a ray hits a refractive sphere object,
+ *                 returning the distance to the point on the sphere.  The
+ *                 near side of the sphere is hit first, and the far side
+ *                 by a ray that starts within it.
+ *
+ * Parameters:     base - The base location of the ray.
+ *                 dir  - The unit vector direction of the ray.
+ *                 tmin - Hits at or before this distance are misses.
+ *                 tmax - Hits at or beyond this distance are misses.
+ *                 obj  - The sphere object to test.
+ *
+ * Return:         The distance to the hit location, or MISS.
+ */
+double hits_refsphere(double *base, double *dir, double tmin, double tmax,
+                      obj_t *obj) {
+    sphere_t *sphere = (sphere_t *)obj->priv; /* The sphere object       */
+    double   view[VEC_SIZE];                  /* The center from the ray */
+    double   distance;                        /* Hit point distance      */
+    double   quad;                            /* The discriminant        */
+    double   b;                               /* Half the linear term    */
+    double   c;                               /* The constant term       */
+
+    vec_diff3(sphere->center, base, view);
+
+    /* The direction is a unit vector, so the squared term is 1 */
+    b    = vec_dot3(view, dir);
+    c    = vec_dot3(view, view) - sphere->radius * sphere->radius;
+    quad = b * b - c;
+
+    if (quad <= 0) {
+        return MISS;
+    }
+
+    /* Take the near side, or the far side if the near one is behind */
+    if ((distance = -b - sqrt(quad)) <= tmin) {
+        distance = -b + sqrt(quad);
+    }
+
+    if (distance <= tmin || distance >= tmax) {
+        return MISS;
+    }
+
+    return distance;
+}
+
+/*
+ * rehits_refsphere: Determines if a ray leaving a refractive sphere object
+ *                   hits it again, such as a ray refracted into it reaching
+ *                   the far side, skipping the point the ray leaves.
+ *
+ * Parameters:       base - The base location of the ray.
+ *                   dir  - The unit vector direction of the ray.
+ *                   tmin - Hits at or before this distance are misses.
+ *                   tmax - Hits at or beyond this distance are misses.
+ *                   obj  - The sphere object the ray leaves.
+ *
+ * Return:           The distance to the hit location, or MISS.
+ */
+double rehits_refsphere(double *base, double *dir, double tmin, double tmax,
+                        obj_t *obj) {
+    return hits_refsphere(base, dir, tmin + REFSPHERE_EPSILON, tmax, obj);
+}
+
+/*
+ * refsphere_trans: Gets the transmission information of a refractive
+ *                  sphere.
+ *
+ * Parameters:      obj          - The refractive sphere object.
+ *                  transmission - Storage for the transmission information.
+ *
+ * Return:          The index of refraction of the sphere.
+ */
+double refsphere_trans(obj_t *obj, double *transmission) {
+    refsphere_t *ref = (refsphere_t *)((sphere_t *)obj->priv)->priv;
+
+    vec_scale3(1.0, ref->transmission, transmission);
+
+    return ref->ior;
+}
+
+/*
+ * refsphere_destroy: Destroys the specified refractive sphere object.
+ *
+ * Parameters:        obj - The refractive sphere object to destroy.
+ */
+void refsphere_destroy(obj_t *obj) {
+    /* Release memory associated with the refraction, then the sphere */
+    Free(((sphere_t *)obj->priv)->priv);
+    sphere_destroy(obj);
+}
@@ -0,0 +1,45 @@
+/*
+ * refsphere.h: This header file contains the implementation specifications
+ *              for a refractive sphere, a sphere of glass or another clear
+ *              material that both reflects and refracts the rays it meets.
+ *
+ * Author:      Scott Gigawatt
+ *
+ * Version:     18 October 2026
+ */
+
+#ifndef REFSPHERE_H
+#define REFSPHERE_H
+
+#include "sphere.h"
+
+/* The distance a ray leaving the sphere travels before it may hit it */
+#define REFSPHERE_EPSILON 1e-6
+
+/* Represents a refractive sphere */
+typedef struct refsphere_type {
+    double ior;                    /* The index of refraction          */
+    double transmission[VEC_SIZE]; /* Fraction let through (r, g, b)   */
+} refsphere_t;
+
+/* Allocates memory for, initializes, and returns a new refractive sphere */
+obj_t *refsphere_init(FILE *in, int objtype);
+
+/* Dumps the contents of the refractive sphere to the specified file */
+int refsphere_dump(FILE *out, obj_t *obj);
+
+/* Determines if a ray hits a refractive sphere, from outside or within */
+double hits_refsphere(double *base, double *dir, double tmin, double tmax,
+                      obj_t *obj);
+
+/* Determines if a ray leaving a refractive sphere hits it again */
+double rehits_refsphere(double *base, double *dir, double tmin, double tmax,
+                        obj_t *obj);
+
+/* Gets the transmission and index of refraction of a refractive sphere */
+double refsphere_trans(obj_t *obj, double *transmission);
+
+/* Destroys the specified refractive sphere object */
+void refsphere_destroy(obj_t *obj);
+
+#endif
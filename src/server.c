@@ -0,0 +1,662 @@
+/*
+ * server.c: This file contains the implementation details for serving render
+ *           jobs over a Unix domain socket.  Parsed models stay resident,
+ *           keyed by a hash of their scene text, so repeated jobs skip the
+ *           parse.  Each job is rendered by a forked worker, which inherits
+ *           the cached model and may change it freely, and at most one
+ *           worker runs per processor.  Waiting jobs start in priority order.
+ *           Requests are read from every client at once, as their bytes
+ *           arrive, and each must arrive whole within SERVER_TIMEOUT seconds,
+ *           so a slow client holds up no one but itself.
+ *
+ *           A request is a single header line followed by the scene text:
+ *
+ *             RENDER width height samples priority length [vx vy vz]
+ *
+ *           A samples value of 0 keeps the server's sample count, priority
+ *           ranges from 0 (lowest) to MAX_PRIORITY, and the optional view
+ *           point replaces the one in the scene.  The reply is the PPM image,
+ *           or a single line beginning with ERROR.
+ *
+ * Author:   Scott Gigawatt
+ *
+ * Version:  18 October 2026
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include "server.h"
+#include "image.h"
+#include "mem.h"
+
+/* The resident models and the clock used to find the least recently used */
+static entry_t       cache[SERVER_CACHE];
+static unsigned long tick = 0;
+
+/* Set once the server has been asked to stop */
+static volatile sig_atomic_t done = 0;
+
+/*
+ * on_signal:  Handles the termination and child signals.  Neither handler
+ *             restarts system calls, so either one wakes the server loop.
+ *
+ * Parameters: sig - The signal number.
+ */
+static void on_signal(int sig) {
+    if (sig != SIGCHLD) {
+        done = 1;
+    }
+}
+
+/*
+ * time_left:  Returns the time left before the specified deadline.
+ *
+ * Parameters: deadline - The deadline.
+ *
+ * Return:     The time left in milliseconds, which is at most zero once the
+ *             deadline has passed.
+ */
+static long time_left(struct timeval *deadline) {
+    struct timeval now; /* The current time */
+
+    gettimeofday(&now, NULL);
+
+    return (deadline->tv_sec - now.tv_sec) * 1000L +
+           (deadline->tv_usec - now.tv_usec) / 1000L;
+}
+
+/*
+ * reply_error: Sends an error reply to the client.
+ *
+ * Parameters:  fd  - The client connection.
+ *              msg - The error message.
+ */
+static void reply_error(int fd, char *msg) {
+    fprintf(stderr, "serve: error: %s\n", msg);
+    dprintf(fd, "ERROR %s\n", msg);
+}
+
+/*
+ * load_model: Parses a model from scene text held in memory.  A malformed
+ *             scene is caught by msg_trap, so it cannot end the server, and
+ *             the partly read model is destroyed.
+ *
+ * Parameters: text - The scene text.
+ *             size - The length of the scene text.
+ *             opts - The rendering options, copied into the model.
+ *             err  - Storage for the parse error message (BUF_SIZE).
+ *
+ * Return:     A pointer to the new model, or NULL if the scene could not be
+ *             parsed.
+ */
+static model_t *load_model(char *text, size_t size, opts_t *opts,
+                           char *err) {
+    model_t *volatile model = NULL; /* The new model  */
+    FILE    *volatile in    = NULL; /* The scene      */
+    jmp_buf env;                    /* The error trap */
+
+    if (setjmp(env)) {
+        if (in) {
+            fclose(in);
+        }
+
+        /* The object being read is not yet in the model */
+        object_abandon();
+
+        if (model) {
+            dalloc(model);
+        }
+
+        snprintf(err, BUF_SIZE, "%s", msg_last());
+
+        return NULL;
+    }
+
+    msg_trap(&env);
+
+    if ((in = fmemopen(text, size, "r")) == NULL) {
+        msg_exit(stderr, "load_model: error: cannot open scene text");
+    }
+
+    /* Set up an empty model, so that dalloc can destroy it at any point */
+    model = (model_t *)Malloc(sizeof(model_t));
+    memset(model, 0, sizeof(model_t));
+    model->lights = list_init();
+    model->scene  = list_init();
+
+    /* Each model gets its own options, since dalloc frees them */
+    model->opts = (opts_t *)Malloc(sizeof(opts_t));
+    memcpy(model->opts, opts, sizeof(opts_t));
+
+    /* The image size is set by each job */
+    model->proj = projection_read(in, 0, 0);
+    model_init(in, model);
+
+    fclose(in);
+    msg_trap(NULL);
+
+    return model;
+}
+
+/*
+ * cache_lookup: Finds the model for the scene text, parsing and caching it
+ *               if it is not resident.  The least recently used model that
+ *               no waiting job needs is evicted to make room; if every model
+ *               is needed, the new model is owned by the job instead.
+ *
+ * Parameters:   job  - The job, whose entry and model are set.
+ *               text - The scene text (owned by the cache or freed).
+ *               size - The length of the scene text.
+ *               opts - The rendering options.
+ *               err  - Storage for an error message (BUF_SIZE).
+ *
+ * Return:       Zero if the job has a model, -1 otherwise.
+ */
+static int cache_lookup(job_t *job, char *text, size_t size, opts_t *opts,
+                        char *err) {
+    unsigned long hash   = hash_text(text, size); /* The scene hash      */
+    entry_t       *entry = NULL;                  /* The eviction victim */
+    int           i;                              /* Cache index         */
+
+    for (i = 0; i < SERVER_CACHE; ++i) {
+        /* Reuse a resident model */
+        if (cache[i].model && cache[i].hash == hash && cache[i].size == size
+                           && !memcmp(cache[i].text, text, size)) {
+            fprintf(stderr, "Model %016lx: resident\n", hash);
+            cache[i].used = ++tick;
+            cache[i].jobs++;
+            job->entry = &cache[i];
+            job->model = cache[i].model;
+            Free(text);
+            return 0;
+        }
+
+        /* Empty slots have never been used, so they are taken first */
+        if (!cache[i].jobs && (!entry || cache[i].used < entry->used)) {
+            entry = &cache[i];
+        }
+    }
+
+    if ((job->model = load_model(text, size, opts, err)) == NULL) {
+        Free(text);
+        return -1;
+    }
+
+    fprintf(stderr, "Model %016lx: parsed\n", hash);
+    job->entry = entry;
+
+    if (!entry) {
+        Free(text);
+        return 0;
+    }
+
+    /* Replace the evicted model */
+    if (entry->model) {
+        dalloc(entry->model);
+        Free(entry->text);
+    }
+
+    entry->hash  = hash;
+    entry->text  = text;
+    entry->size  = size;
+    entry->model = job->model;
+    entry->used  = ++tick;
+    entry->jobs  = 1;
+
+    return 0;
+}
+
+/*
+ * read_header: Parses and checks the header line of a request.
+ *
+ * Parameters:  line - The header line, without its newline.
+ *              job  - The job to fill in.
+ *              size - Storage for the length of the scene text.
+ *              err  - Storage for an error message (BUF_SIZE).
+ *
+ * Return:      Zero if the header was valid, -1 otherwise.
+ */
+static int read_header(char *line, job_t *job, long *size, char *err) {
+    int rc; /* The scan count */
+
+    rc = sscanf(line, "RENDER %d %d %d %d %ld %lf %lf %lf", &job->size[0],
+                &job->size[1], &job->samples, &job->priority, size,
+                &job->view[0], &job->view[1], &job->view[2]);
+
+    if (rc != 5 && rc != 8) {
+        strcpy(err, "malformed request header");
+        return -1;
+    }
+
+    job->moved = rc == 8;
+
+    /* Check the request limits */
+    if (job->size[0] < 2 || job->size[0] > MAX_SIZE ||
+        job->size[1] < 2 || job->size[1] > MAX_SIZE) {
+        strcpy(err, "invalid image size");
+        return -1;
+    } else if (job->samples < 0 || job->samples > MAX_SAMPLES) {
+        strcpy(err, "invalid sample count");
+        return -1;
+    } else if (job->priority < 0 || job->priority > MAX_PRIORITY) {
+        strcpy(err, "invalid priority");
+        return -1;
+    } else if (*size < 1 || *size > MAX_SCENE) {
+        strcpy(err, "invalid scene length");
+        return -1;
+    }
+
+    return 0;
+}
+
+/*
+ * read_request: Reads whatever the client has sent of its request so far,
+ *               without waiting for more, so that a slow client holds up
+ *               no one else.  The header line comes first, and the scene
+ *               text after it.
+ *
+ * Parameters:   req - The request being read.
+ *               err - Storage for an error message (BUF_SIZE).
+ *
+ * Return:       Zero once the whole request has been read, one if more is
+ *               to come, and -1 if the request is invalid.
+ */
+static int read_request(request_t *req, char *err) {
+    ssize_t rc;    /* The read count                  */
+    char    *end;  /* The end of the header line      */
+    long    extra; /* Scene text read with the header */
+
+    while (req->text == NULL) {
+        rc = read(req->job.fd, req->line + req->len, BUF_SIZE - 1 - req->len);
+
+        if (rc < 0 && (errno == EAGAIN || errno == EINTR)) {
+            return 1;
+        } else if (rc <= 0) {
+            strcpy(err, "missing request header");
+            return -1;
+        }
+
+        req->len            += rc;
+        req->line[req->len]  = '\0';
+
+        if ((end = memchr(req->line, '\n', req->len)) == NULL) {
+            if (req->len < BUF_SIZE - 1) {
+                continue;
+            }
+
+            strcpy(err, "missing request header");
+            return -1;
+        }
+
+        *end = '\0';
+
+        if (read_header(req->line, &req->job, &req->size, err)) {
+            return -1;
+        }
+
+        /* Keep the scene text that came with the header */
+        extra     = req->line + req->len - (end + 1);
+        req->got  = extra < req->size ? extra : req->size;
+        req->text = (char *)Malloc(req->size);
+        memcpy(req->text, end + 1, req->got);
+    }
+
+    while (req->got < req->size) {
+        rc = read(req->job.fd, req->text + req->got, req->size - req->got);
+
+        if (rc < 0 && (errno == EAGAIN || errno == EINTR)) {
+            return 1;
+        } else if (rc <= 0) {
+            strcpy(err, "short scene text");
+            return -1;
+        }
+
+        req->got += rc;
+    }
+
+    return 0;
+}
+
+/*
+ * open_request: Starts reading the request of a new client, which must
+ *               send all of it within SERVER_TIMEOUT seconds.
+ *
+ * Parameters:   req - The request to start.
+ *               fd  - The client connection.
+ */
+static void open_request(request_t *req, int fd) {
+    memset(req, 0, sizeof(request_t));
+    req->job.fd = fd;
+
+    gettimeofday(&req->deadline, NULL);
+    req->deadline.tv_sec += SERVER_TIMEOUT;
+
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+}
+
+/*
+ * release_job: Releases the parent's hold on a started or rejected job.
+ *
+ * Parameters:  job - The job to release.
+ */
+static void release_job(job_t *job) {
+    if (job->entry) {
+        job->entry->jobs--;
+    } else if (job->model) {
+        dalloc(job->model);
+    }
+
+    close(job->fd);
+}
+
+/*
+ * start_job:  Forks a worker that renders the job to its client.
+ *
+ * Parameters: queue    - The waiting jobs, whose connections the worker
+ *                        closes.
+ *             queued   - The number of waiting jobs.
+ *             reqs     - The requests still being read, whose connections
+ *                        the worker also closes.
+ *             reading  - The number of requests being read.
+ *             job      - The job to start.
+ *             listener - The listening socket.
+ *
+ * Return:     Zero if the worker was started, -1 otherwise.
+ */
+static int start_job(job_t *queue, int queued, request_t *reqs, int reading,
+                     job_t *job, int listener) {
+    model_t *model = job->model; /* The worker's copy of the model */
+    pid_t   pid;                 /* The worker process             */
+    int     i;                   /* Queue index                    */
+
+    if ((pid = fork()) != 0) {
+        return pid < 0 ? -1 : 0;
+    }
+
+    /* Keep only this job's connection, so other clients see their EOF */
+    close(listener);
+
+    for (i = 0; i < queued; ++i) {
+        if (queue[i].fd != job->fd) {
+            close(queue[i].fd);
+        }
+    }
+
+    for (i = 0; i < reading; ++i) {
+        close(reqs[i].job.fd);
+    }
+
+    /* Lower priorities run at higher nice values */
+    setpriority(PRIO_PROCESS, 0, MAX_PRIORITY - job->priority);
+
+    /* Apply the job to the worker's copy of the model */
+    model->proj->win_size_pixel[0] = job->size[0];
+    model->proj->win_size_pixel[1] = job->size[1];
+
+    if (job->samples) {
+        model->opts->samples = job->samples;
+    }
+
+    if (job->moved) {
+        vec_scale3(1.0, job->view, model->proj->view_point);
+    }
+
+    projection_camera(model->proj, model->opts);
+
+    /* Render straight to the client, waiting for it to take the image */
+    fcntl(job->fd, F_SETFL, fcntl(job->fd, F_GETFL) & ~O_NONBLOCK);
+    dup2(job->fd, STDOUT_FILENO);
+    close(job->fd);
+    make_image(model);
+    fflush(stdout);
+
+    exit(EXIT_SUCCESS);
+}
+
+/*
+ * next_job:   Finds the waiting job with the highest priority, taking the
+ *             earliest of equal priority jobs.
+ *
+ * Parameters: queue  - The waiting jobs.
+ *             queued - The number of waiting jobs.
+ *
+ * Return:     The index of the next job.
+ */
+static int next_job(job_t *queue, int queued) {
+    int next = 0; /* The next job */
+    int i;        /* Queue index  */
+
+    for (i = 1; i < queued; ++i) {
+        if (queue[i].priority > queue[next].priority ||
+           (queue[i].priority == queue[next].priority &&
+            queue[i].seq < queue[next].seq)) {
+            next = i;
+        }
+    }
+
+    return next;
+}
+
+/*
+ * open_socket: Creates the listening socket, replacing a stale socket file
+ *              left behind by an earlier server.
+ *
+ * Parameters:  path - The path of the socket.
+ *
+ * Return:      The listening socket.
+ */
+static int open_socket(char *path) {
+    struct sockaddr_un addr; /* The socket address    */
+    struct stat        info; /* The existing file     */
+    int                fd;   /* The listening socket  */
+
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        msg_exit(stderr, "serve: error: socket path too long");
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+
+    if (!stat(path, &info) && S_ISSOCK(info.st_mode)) {
+        unlink(path);
+    }
+
+    if ((fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0 ||
+        bind(fd, (struct sockaddr *)&addr, sizeof(addr)) ||
+        listen(fd, SERVER_QUEUE)) {
+        perror(path);
+        msg_exit(stderr, "serve: error: cannot listen on socket");
+    }
+
+    return fd;
+}
+
+/*
+ * finish_request: Finds the model of a request that has been read and
+ *                 queues its job, or replies with the error that stops it.
+ *
+ * Parameters:     req    - The request, whose scene text the job takes.
+ *                 queue  - The waiting jobs.
+ *                 queued - The number of waiting jobs, updated.
+ *                 seq    - The next arrival number, updated.
+ *                 opts   - The rendering options.
+ */
+static void finish_request(request_t *req, job_t *queue, int *queued,
+                           unsigned long *seq, opts_t *opts) {
+    job_t *job = &req->job; /* The job of the request  */
+    char  err[BUF_SIZE];    /* A request error message */
+
+    if (cache_lookup(job, req->text, req->size, opts, err)) {
+        reply_error(job->fd, err);
+        release_job(job);
+    } else if (*queued == SERVER_QUEUE) {
+        reply_error(job->fd, "server busy");
+        release_job(job);
+    } else {
+        job->seq           = (*seq)++;
+        queue[(*queued)++] = *job;
+
+        fprintf(stderr, "Job %lu: %dx%d priority %d\n", job->seq,
+                job->size[0], job->size[1], job->priority);
+    }
+}
+
+/*
+ * serve:      Serves render jobs on the socket named by the rendering
+ *             options until interrupted or terminated.  Requests are read
+ *             from every client at once, as their bytes arrive.
+ *
+ * Parameters: opts - The rendering options, used by every job.
+ *
+ * Return:     EXIT_SUCCESS once the server has stopped.
+ */
+int serve(opts_t *opts) {
+    job_t            queue[SERVER_QUEUE];      /* The waiting jobs           */
+    request_t        reqs[SERVER_CLIENTS];     /* The requests being read    */
+    struct pollfd    pfds[SERVER_CLIENTS + 1]; /* The sockets to wait on     */
+    struct sigaction act;                      /* The signal handler         */
+    char             err[BUF_SIZE];            /* A request error message    */
+    unsigned long    seq     = 0;              /* The next arrival number    */
+    int              queued  = 0;              /* The number of waiting jobs */
+    int              reading = 0;              /* The requests being read    */
+    int              running = 0;              /* The number of workers      */
+    int              workers;                  /* The most workers at once   */
+    int              listener;                 /* The listening socket       */
+    int              timeout;                  /* Milliseconds to wait       */
+    int              rc;                       /* A read result, or the time */
+    int              fd;                       /* A client connection        */
+    int              i;                        /* Queue or request index     */
+
+    /* Run one worker per processor */
+    workers = sysconf(_SC_NPROCESSORS_ONLN);
+    workers = workers > 0 ? workers : 1;
+
+    /* Let signals interrupt the wait for connections */
+    memset(&act, 0, sizeof(act));
+    act.sa_handler = on_signal;
+    sigemptyset(&act.sa_mask);
+    sigaction(SIGINT,  &act, NULL);
+    sigaction(SIGTERM, &act, NULL);
+    sigaction(SIGCHLD, &act, NULL);
+
+    /* A client that hangs up must not end the server */
+    signal(SIGPIPE, SIG_IGN);
+
+    listener = open_socket(opts->serve);
+    fprintf(stderr, "Serving on %s with %d workers\n", opts->serve, workers);
+
+    while (!done) {
+        /* Reap the finished workers */
+        while (waitpid(-1, NULL, WNOHANG) > 0) {
+            running--;
+        }
+
+        /* Start the most urgent jobs while workers are free */
+        while (queued > 0 && running < workers) {
+            i = next_job(queue, queued);
+
+            if (start_job(queue, queued, reqs, reading, &queue[i],
+                          listener)) {
+                reply_error(queue[i].fd, "cannot start worker");
+            } else {
+                fprintf(stderr, "Job %lu: started\n", queue[i].seq);
+                running++;
+            }
+
+            release_job(&queue[i]);
+            queue[i] = queue[--queued];
+        }
+
+        /* Wait for new clients while there is room to read their requests,
+           and for more of the requests being read until they are due */
+        pfds[0].fd     = reading < SERVER_CLIENTS ? listener : -1;
+        pfds[0].events = POLLIN;
+        timeout        = queued ? SERVER_POLL : -1;
+
+        for (i = 0; i < reading; ++i) {
+            pfds[i + 1].fd     = reqs[i].job.fd;
+            pfds[i + 1].events = POLLIN;
+            rc                 = (int)time_left(&reqs[i].deadline);
+            rc                 = rc > 0 ? rc : 0;
+            timeout            = timeout < 0 || rc < timeout ? rc : timeout;
+        }
+
+        if (poll(pfds, reading + 1, timeout) < 0) {
+            continue;
+        }
+
+        /* Read what has arrived, from the last request back, so that a
+           finished request can be replaced by the last one */
+        for (i = reading - 1; i >= 0; --i) {
+            rc = 1;
+
+            if (pfds[i + 1].revents) {
+                rc = read_request(&reqs[i], err);
+            }
+
+            if (rc > 0 && time_left(&reqs[i].deadline) <= 0) {
+                strcpy(err, reqs[i].text ? "short scene text" :
+                                           "missing request header");
+                rc = -1;
+            }
+
+            if (rc > 0) {
+                continue;
+            } else if (rc < 0) {
+                reply_error(reqs[i].job.fd, err);
+                release_job(&reqs[i].job);
+                Free(reqs[i].text);
+            } else {
+                finish_request(&reqs[i], queue, &queued, &seq, opts);
+            }
+
+            reqs[i] = reqs[--reading];
+        }
+
+        if ((pfds[0].revents & POLLIN) &&
+            (fd = accept(listener, NULL, NULL)) >= 0) {
+            open_request(&reqs[reading++], fd);
+        }
+    }
+
+    /* Turn away the waiting jobs and the requests being read, and let the
+       workers finish */
+    for (i = 0; i < queued; ++i) {
+        reply_error(queue[i].fd, "server stopped");
+        release_job(&queue[i]);
+    }
+
+    for (i = 0; i < reading; ++i) {
+        reply_error(reqs[i].job.fd, "server stopped");
+        release_job(&reqs[i].job);
+        Free(reqs[i].text);
+    }
+
+    while (wait(NULL) > 0 || errno == EINTR);
+
+    close(listener);
+    unlink(opts->serve);
+
+    /* Release the resident models */
+    for (i = 0; i < SERVER_CACHE; ++i) {
+        if (cache[i].model) {
+            dalloc(cache[i].model);
+            Free(cache[i].text);
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
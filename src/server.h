@@ -0,0 +1,81 @@
+/*
+ * server.h: This header file contains the implementation specifications for
+ *           serving render jobs over a Unix domain socket.
+ *
+ * Author:   Scott Gigawatt
+ *
+ * Version:  18 October 2026
+ */
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "model.h"
+#include "options.h"
+#include <sys/time.h>
+
+/* The number of parsed models kept resident between jobs */
+#ifndef SERVER_CACHE
+    #define SERVER_CACHE 8
+#endif
+
+/* The number of accepted jobs that may wait for a free worker */
+#ifndef SERVER_QUEUE
+    #define SERVER_QUEUE 64
+#endif
+
+/* The number of requests that may be read at once */
+#ifndef SERVER_CLIENTS
+    #define SERVER_CLIENTS 16
+#endif
+
+/* Milliseconds between checks for finished workers while jobs wait */
+#define SERVER_POLL    100
+
+/* Seconds a client may take to send its whole request */
+#define SERVER_TIMEOUT 5
+
+/* Limits on a single request */
+#define MAX_SCENE      (1 << 20)
+#define MAX_SIZE       8192
+#define MAX_SAMPLES    1024
+#define MAX_PRIORITY   19
+
+/* A parsed model kept resident between jobs */
+typedef struct entry_type {
+    unsigned long hash;   /* FNV-1a hash of the scene text   */
+    char          *text;  /* The scene text                  */
+    size_t        size;   /* The length of the scene text    */
+    model_t       *model; /* The parsed model                */
+    unsigned long used;   /* When the model was last needed  */
+    int           jobs;   /* Waiting jobs that use the model */
+} entry_t;
+
+/* A render job waiting for a free worker */
+typedef struct job_type {
+    int           fd;                 /* The client connection          */
+    int           size[VEC_SIZE - 1]; /* Image size in pixels (x, y)    */
+    int           samples;            /* Samples per pixel (0: default) */
+    int           priority;           /* Higher priorities run first    */
+    int           moved;              /* Set if a view point was sent   */
+    double        view[VEC_SIZE];     /* The view point (x, y, z)       */
+    unsigned long seq;                /* Arrival order of the job       */
+    entry_t       *entry;             /* The cached model, or NULL      */
+    model_t       *model;             /* The model to render            */
+} job_t;
+
+/* A request being read, a little at a time, as its client sends it */
+typedef struct request_type {
+    job_t          job;            /* The job, with the client connection */
+    char           line[BUF_SIZE]; /* The header line read so far         */
+    int            len;            /* The length of the header line       */
+    char           *text;          /* The scene text, once the header is  */
+    long           size;           /* The length of the scene text        */
+    long           got;            /* The scene text read so far          */
+    struct timeval deadline;       /* When the whole request is due       */
+} request_t;
+
+/* Serves render jobs on the socket named by the rendering options */
+int serve(opts_t *opts);
+
+#endif
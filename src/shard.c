@@ -0,0 +1,95 @@
+/*
+ * shard.c: This file contains the implementation details for rendering one
+ *          shard of an image.  The traced rectangle is cut into TILE_SIZE
+ *          square tiles, numbered in row major order, and tile t belongs to
+ *          shard t % n, so neighbouring tiles (which cost about the same to
+ *          trace) are spread over the shards.  Pixels are traced exactly as
+ *          by render_image, so a shard rendered again, on any machine, is
+ *          identical to the first one, and the merged shards are identical
+ *          to the whole image rendered at once.
+ *
+ *          A shard file starts with a one line text header:
+ *
+ *            RTSHARD2 index count width height x0 y0 x1 y1 full tile
+ *                     samples light_samples lightmap hash
+ *
+ *          giving the image size, the traced rectangle, whether the full
+ *          frame is written around it, the tile size, the sample count, the
+ *          shading options (--light-samples and --lightmap) and the scene
+ *          hash (see model_hash).  The (r, g, b) pixels of the
+ *          tiles of the shard follow, tile by tile, each tile row by row.
+ *          The shards are assembled with rtmerge.
+ *
+ * Author:  Scott Gigawatt
+ *
+ * Version: 18 October 2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "shard.h"
+#include "image.h"
+#include "mem.h"
+
+/*
+ * shard_render: Renders the tiles of the shard named by the rendering
+ *               options and writes them to standard out as a shard file.
+ *
+ * Parameters:   model - The model on which the image will be based.
+ */
+void shard_render(model_t *model) {
+    unsigned char *pixmap = NULL;    /* The image data            */
+    int           vals[VEC_SIZE];    /* The PPM header values     */
+    int           region[CROP_SIZE]; /* The traced pixels         */
+    int           tiles[2];          /* The tiles across and down */
+    int           rect[CROP_SIZE];   /* A tile's pixels           */
+    int           index;             /* This shard                */
+    int           count;             /* The number of shards      */
+    int           num;               /* The number of tiles       */
+    int           t;                 /* Tile index                */
+    int           i;                 /* Counter variable          */
+
+    /* Rays must be recorded in order, from the top left */
+    if (model->opts->deps) {
+        msg_exit(stderr, "shard_render: error: cannot shard with --deps");
+    }
+
+    pixmap = image_alloc(model, vals);
+    image_region(model, region);
+    index  = model->opts->shard[0];
+    count  = model->opts->shard[1];
+    num    = image_tiles(region, tiles);
+
+    /* Order the scene objects by hit frequency */
+    if (model->opts->reorder) {
+        profile_hits(model);
+    }
+
+    printf("%s %d %d %d %d %d %d %d %d %d %d %d %d %d %016lx\n", SHARD_ID,
+           index, count, vals[0], vals[1], region[0], region[1], region[2],
+           region[3], model->opts->full, TILE_SIZE, model->opts->samples,
+           model->opts->light_samples, model->opts->lightmap,
+           model_hash(model));
+
+    for (t = index; t < num; t += count) {
+        image_tile(region, tiles, t, rect);
+
+        /* Trace the tile exactly as render_image would */
+        render_tile(model, pixmap, region, rect);
+
+        /* Write the tile, row by row */
+        for (i = rect[1]; i < rect[3]; ++i) {
+            fwrite(image_pixel(model, pixmap, region, rect[0], i),
+                   PIXEL_SIZE, rect[2] - rect[0], stdout);
+        }
+    }
+
+    if (fflush(stdout)) {
+        msg_exit(stderr, "shard_render: error: cannot write shard");
+    }
+
+    fprintf(stderr, "Shard %d of %d: %d of %d tiles\n", index, count,
+                    (num - index + count - 1) / count, num);
+
+    Free(pixmap);
+}
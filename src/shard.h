@@ -0,0 +1,21 @@
+/*
+ * shard.h: This header file contains the implementation specifications for
+ *          rendering one shard of the tiles of an image.
+ *
+ * Author:  Scott Gigawatt
+ *
+ * Version: 18 October 2026
+ */
+
+#ifndef SHARD_H
+#define SHARD_H
+
+#include "model.h"
+
+/* The identifier at the start of a shard file */
+#define SHARD_ID "RTSHARD2"
+
+/* Renders the tiles of one shard of the image to standard out */
+void shard_render(model_t *model);
+
+#endif
@@ -29,8 +29,12 @@ obj_t *sphere_init(FILE *in, int objtype) {
     /* Link the plane to the object structure */
     obj->priv    = new;
     obj->hits    = hits_sphere;
+    obj->surface = sphere_surface;
+    obj->bounds  = sphere_bounds;
+    obj->move    = sphere_move;
     obj->destroy = sphere_destroy;
     obj->dump    = sphere_dump;
+    new->priv    = NULL;
     
     /* Read in the center vector information (x, y, z) and check for errors */
     if (( rc = vec_get3(in, new->center) ) != VEC_SIZE) {
@@ -80,19 +84,21 @@ int sphere_dump(FILE *out, obj_t *obj) {
 
 /* 
  * hits_sphere: Determines if a ray hits a sphere object, returning the 
- *              distance to the point on the sphere.
+ *              distance to the point on the sphere.  Only the near side of
+ *              the sphere is considered.
  *
  * Parameters:  base - The base location of the ray.
  *              dir  - The unit vector direction of the ray.
+ *              tmin - Hits at or before this distance are misses.
+ *              tmax - Hits at or beyond this distance are misses.
  *              obj  - The sphere object to test.
  *
- * Return:      The distance to the hit location.
+ * Return:      The distance to the hit location, or MISS.
  */
-double hits_sphere(double *base, double *dir, obj_t *obj) {
+double hits_sphere(double *base, double *dir, double tmin, double tmax,
+                   obj_t *obj) {
     sphere_t *sphere = (sphere_t *)obj->priv; /* The sphere object         */
     double view[VEC_SIZE];                    /* The new view point        */
-    double hit_loc[VEC_SIZE];                 /* Ray hit location          */
-    double normal[VEC_SIZE];                  /* The normal to the sphere  */
     double distance;                          /* Hit point distance        */
     double quad;                              /* The discriminate          */
     double a;                                 /* Quadratic formula value   */
@@ -108,26 +114,77 @@ double hits_sphere(double *base, double *dir, obj_t *obj) {
     c    = vec_dot3(view, view) - (sphere->radius * sphere->radius);
     quad = (b * b) - (4 * a * c);
 
+    if (quad <= 0) {
+        /* Ray missed the sphere */
+        return MISS;
+    }
+
     /* Find the distance to the sphere */
     distance = ( (-1 * b) - sqrt(quad) ) / (2 * a);
 
-    /* Find the hit location */
-    vec_scale3(distance, dir, hit_loc);
-    vec_sum3(base, hit_loc, hit_loc);
-
-    if (quad <= 0) {
-        /* Ray missed the sphere */
-        distance = MISS;
-    } else {
-        /* Ray hit the sphere, save hit location and normal */
-        vec_scale3(1.0, hit_loc, obj->hitloc);
-        vec_diff3(sphere->center, hit_loc, normal);
-        vec_unit3(normal, obj->normal);
+    if (distance <= tmin || distance >= tmax) {
+        /* Ray hit the sphere outside of the distance bounds */
+        return MISS;
     }
 
     return distance;
 }
 
+/*
+ * sphere_surface: Computes the hit location and normal of a ray that hit a
+ *                 sphere object.
+ *
+ * Parameters:     base - The base location of the ray.
+ *                 dir  - The unit vector direction of the ray.
+ *                 dist - The distance returned by hits_sphere.
+ *                 obj  - The sphere object that was hit.
+ */
+void sphere_surface(double *base, double *dir, double dist, obj_t *obj) {
+    sphere_t *sphere = (sphere_t *)obj->priv; /* The sphere object        */
+    double   normal[VEC_SIZE];                /* The normal to the sphere */
+
+    /* Save the hit location */
+    vec_scale3(dist, dir, obj->hitloc);
+    vec_sum3(base, obj->hitloc, obj->hitloc);
+
+    /* Save the unit normal */
+    vec_diff3(sphere->center, obj->hitloc, normal);
+    vec_unit3(normal, obj->normal);
+}
+
+/*
+ * sphere_bounds: Finds the bounding box of a sphere object.
+ *
+ * Parameters:    obj - The sphere object.
+ *                lo  - Storage for the low corner of the box.
+ *                hi  - Storage for the high corner of the box.
+ *
+ * Return:        Nonzero, since a sphere is bounded.
+ */
+int sphere_bounds(obj_t *obj, double *lo, double *hi) {
+    sphere_t *sphere = (sphere_t *)obj->priv; /* The sphere object */
+    int      i;                               /* Axis index        */
+
+    for (i = 0; i < VEC_SIZE; ++i) {
+        lo[i] = sphere->center[i] - sphere->radius;
+        hi[i] = sphere->center[i] + sphere->radius;
+    }
+
+    return 1;
+}
+
+/*
+ * sphere_move: Translates the specified sphere object by an offset.
+ *
+ * Parameters:  obj    - The sphere object to move.
+ *              offset - The translation (x, y, z).
+ */
+void sphere_move(obj_t *obj, double *offset) {
+    sphere_t *sphere = (sphere_t *)obj->priv; /* The sphere to move */
+
+    vec_sum3(sphere->center, offset, sphere->center);
+}
+
 /* 
  * sphere_destroy: Destroys the specified sphere object.
  *
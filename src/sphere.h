@@ -16,6 +16,7 @@
 typedef struct sphere_type {
     double center[VEC_SIZE]; /* The center of the sphere */
     double radius;           /* The radius of the sphere */
+    void   *priv;            /* Data for subtypes        */
 } sphere_t;
 
 /* Allocates memory for, initializes, and returns a new sphere */
@@ -25,7 +26,17 @@ obj_t *sphere_init(FILE *in, int objtype);
 int sphere_dump(FILE *out, obj_t *obj);
 
 /* Determines if a ray hits a sphere object */
-double hits_sphere(double *base, double *dir, obj_t *obj);
+double hits_sphere(double *base, double *dir, double tmin, double tmax,
+                   obj_t *obj);
+
+/* Computes the hit location and normal of a ray that hit a sphere */
+void sphere_surface(double *base, double *dir, double dist, obj_t *obj);
+
+/* Finds the bounding box of a sphere object */
+int sphere_bounds(obj_t *obj, double *lo, double *hi);
+
+/* Translates the specified sphere object by an offset */
+void sphere_move(obj_t *obj, double *offset);
 
 /* Destroys the specified sphere object */
 void sphere_destroy(obj_t *obj);
@@ -0,0 +1,209 @@
+/*
+ * spotlight.c: This file contains the implementation details for a
+ *              spotlight.  A spotlight is a light that shines at full
+ *              strength within an inner cone about its direction, fading
+ *              smoothly to nothing at an outer cone.  Points outside the
+ *              outer cone are rejected before any shadow ray is cast, and
+ *              whole tiles of pixels whose rays cannot meet the outer cone
+ *              skip the spotlight (see light_cull).
+ *
+ * Author:      Scott Gigawatt
+ *
+ * Version:     18 October 2026
+ */
+
+#include <math.h>
+#include "spotlight.h"
+#include "mem.h"
+
+/*
+ * angle_between: Finds the angle between two unit vectors.
+ *
+ * Parameters:    v1 - A unit vector (x, y, z).
+ *                v2 - A unit vector (x, y, z).
+ *
+ * Return:        The angle in radians, 0 to pi.
+ */
+static double angle_between(double *v1, double *v2) {
+    double cosine = vec_dot3(v1, v2); /* The cosine of the angle */
+
+    return acos(cosine > 1.0 ? 1.0 : cosine < -1.0 ? -1.0 : cosine);
+}
+
+/*
+ * spotlight_init: Initializes and returns a new spotlight object.  After
+ *                 the light come the direction it points and its inner and
+ *                 outer half angles, in degrees.
+ *
+ * Parameters:     in      - The file containing the spotlight data.
+ *                 objtype - The object type identifier.
+ *
+ * Return:         The newly created spotlight object.
+ */
+obj_t *spotlight_init(FILE *in, int objtype) {
+    obj_t       *obj   = light_init(in, objtype);     /* The light object */
+    light_t     *light = (light_t *)obj->priv;        /* The light        */
+    spotlight_t *new   = (spotlight_t *)Malloc(sizeof(spotlight_t));
+    int         i;                                    /* Counter          */
+
+    /* Link the spotlight to the light */
+    light->priv    = new;
+    light->spread  = spotlight_spread;
+    light->reaches = spotlight_reaches;
+    obj->destroy   = spotlight_destroy;
+    obj->dump      = spotlight_dump;
+
+    /* Get the direction of the spotlight and check for errors */
+    if (vec_get3(in, new->dir) != VEC_SIZE || vec_length3(new->dir) == 0.0) {
+        msg_exit(stderr, "spotlight_init: error: invalid direction");
+    }
+
+    consume_line(in);
+
+    /* Get the inner and outer half angles and check for errors */
+    if (vec_get2(in, new->angles) != 2 || new->angles[0] < 0.0 ||
+        new->angles[0] > new->angles[1] || new->angles[1] <= 0.0 ||
+        new->angles[1] >= 180.0) {
+        msg_exit(stderr, "spotlight_init: error: invalid cone angles");
+    }
+
+    consume_line(in);
+
+    vec_unit3(new->dir, new->dir);
+
+    for (i = 0; i < 2; ++i) {
+        new->cosines[i] = cos(new->angles[i] * M_PI / 180.0);
+    }
+
+    new->outer = new->angles[1] * M_PI / 180.0;
+
+    return obj;
+}
+
+/*
+ * spotlight_dump: Dumps the contents of the spotlight object to the
+ *                 specified output file.
+ *
+ * Parameters:     out - The file to which the spotlight will be dumped.
+ *                 obj - The spotlight object to dump.
+ *
+ * Return:         EXIT_SUCCESS if successful, EXIT_FAILURE otherwise.
+ */
+int spotlight_dump(FILE *out, obj_t *obj) {
+    light_t     *light = (light_t *)obj->priv;        /* The light     */
+    spotlight_t *spot  = (spotlight_t *)light->priv;  /* The spotlight */
+
+    /* Print out the spotlight information */
+    fprintf(out,  "Dumping object of type Spotlight\n\nLight data\n");
+    vec_prn3(out, "emissivity - ", obj->emissivity);
+    vec_prn3(out, "center     - ", light->center);
+    vec_prn3(out, "direction  - ", spot->dir);
+    vec_prn2(out, "angles     - ", spot->angles);
+
+    return EXIT_SUCCESS;
+}
+
+/*
+ * spotlight_spread: Finds the fraction of the emissivity a spotlight sends
+ *                   along a direction: all of it within the inner cone,
+ *                   none of it outside the outer cone, and a smooth step in
+ *                   between.
+ *
+ * Parameters:       obj - The spotlight object.
+ *                   dir - The unit direction from the spotlight (x, y, z).
+ *
+ * Return:           The fraction, 0 to 1.
+ */
+double spotlight_spread(obj_t *obj, double *dir) {
+    spotlight_t *spot   = (spotlight_t *)((light_t *)obj->priv)->priv;
+    double      cosine  = vec_dot3(dir, spot->dir); /* Cosine off the axis */
+    double      x;                                  /* Place in the fade   */
+
+    if (cosine <= spot->cosines[1]) {
+        return 0.0;
+    }
+
+    if (cosine >= spot->cosines[0]) {
+        return 1.0;
+    }
+
+    x = (cosine - spot->cosines[1]) / (spot->cosines[0] - spot->cosines[1]);
+
+    return x * x * (3.0 - 2.0 * x);
+}
+
+/*
+ * spotlight_reaches: Determines if a spotlight may reach a point of a cone,
+ *                    such as the cone bounding the rays of a tile of pixels.
+ *                    Seen from the spotlight, the points of the cone lie in
+ *                    directions between the direction of its apex and those
+ *                    of its axis and rim, so they fit within a circle on the
+ *                    sphere of directions that takes in both; the spotlight
+ *                    may reach the cone only if its outer cone meets that
+ *                    circle.  The test is conservative: it may report a
+ *                    cone the spotlight misses, but never the reverse.
+ *
+ * Parameters:        obj   - The spotlight object.
+ *                    apex  - The apex of the cone (x, y, z).
+ *                    axis  - The unit axis of the cone (x, y, z).
+ *                    angle - The half angle of the cone, in radians.
+ *
+ * Return:            Nonzero if the spotlight may reach the cone.
+ */
+int spotlight_reaches(obj_t *obj, double *apex, double *axis, double angle) {
+    light_t     *light = (light_t *)obj->priv;       /* The light           */
+    spotlight_t *spot  = (spotlight_t *)light->priv; /* The spotlight       */
+    double      to[VEC_SIZE];                        /* Direction to apex   */
+    double      center[VEC_SIZE];                    /* Circle center       */
+    double      dist;                                /* Distance to apex    */
+    double      theta;                               /* Axis to apex angle  */
+    double      radius;                              /* Circle radius       */
+    double      shift;                               /* Center off the axis */
+    int         i;                                   /* Counter             */
+
+    vec_diff3(light->center, apex, to);
+
+    /* A cone from the spotlight itself may go anywhere */
+    if ((dist = vec_length3(to)) == 0.0) {
+        return 1;
+    }
+
+    vec_scale3(1.0 / dist, to, to);
+    theta = angle_between(to, axis);
+
+    if (theta <= angle) {
+        /* The apex is seen within the rim, so the rim's circle suffices */
+        vec_scale3(1.0, axis, center);
+        radius = angle;
+    } else {
+        /* Move the center from the axis toward the apex */
+        radius = (theta + angle) / 2.0;
+        shift  = (theta - angle) / 2.0;
+
+        /* A circle this large is no longer convex */
+        if (radius >= M_PI / 2.0) {
+            return 1;
+        }
+
+        for (i = 0; i < VEC_SIZE; ++i) {
+            center[i] = (sin(theta - shift) * axis[i] + sin(shift) * to[i]) /
+                        sin(theta);
+        }
+
+        vec_unit3(center, center);
+    }
+
+    return angle_between(center, spot->dir) <=
+           radius + spot->outer + SPOT_EPSILON;
+}
+
+/*
+ * spotlight_destroy: Destroys the specified spotlight object.
+ *
+ * Parameters:        obj - The spotlight object to destroy.
+ */
+void spotlight_destroy(obj_t *obj) {
+    /* Release memory associated with the spotlight, then the light */
+    Free(((light_t *)obj->priv)->priv);
+    light_destroy(obj);
+}
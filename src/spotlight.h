@@ -0,0 +1,43 @@
+/*
+ * spotlight.h: This header file contains the implementation specifications
+ *              for a spotlight, a light that shines in a cone.
+ *
+ * Author:      Scott Gigawatt
+ *
+ * Version:     18 October 2026
+ */
+
+#ifndef SPOTLIGHT_H
+#define SPOTLIGHT_H
+
+#include "light.h"
+
+/* The slack, in radians, given to the test of a cone against a spotlight */
+#ifndef SPOT_EPSILON
+    #define SPOT_EPSILON 1e-6
+#endif
+
+/* Represents a spotlight */
+typedef struct spotlight_type {
+    double dir[VEC_SIZE]; /* The unit direction it points    */
+    double angles[2];     /* Inner and outer half angles     */
+    double cosines[2];    /* Cosines of the inner and outer  */
+    double outer;         /* The outer half angle in radians */
+} spotlight_t;
+
+/* Allocates, initializes and returns a new spotlight object */
+obj_t *spotlight_init(FILE *in, int objtype);
+
+/* Dumps the contents of the spotlight object to the specified file */
+int spotlight_dump(FILE *out, obj_t *obj);
+
+/* Finds the fraction of the emissivity a spotlight sends along a direction */
+double spotlight_spread(obj_t *obj, double *dir);
+
+/* Determines if a spotlight may reach a point of a cone */
+int spotlight_reaches(obj_t *obj, double *apex, double *axis, double angle);
+
+/* Destroys the specified spotlight object */
+void spotlight_destroy(obj_t *obj);
+
+#endif
@@ -0,0 +1,214 @@
+/*
+ * texplane.c: This file contains the implementation details for a textured
+ *             plane object.  The texture is either fit to the finite plane
+ *             or tiled across it, and is filtered over the area one pixel
+ *             covers, which grows with the distance of the hit.
+ *
+ * Author:     Scott Gigawatt
+ *
+ * Version:    18 October 2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "texplane.h"
+#include "mem.h"
+#include "veclib3d.h"
+
+/*
+ * texplane_init: Allocates memory for, initializes, and returns a new
+ *                textured plane.  After the finite plane come the texture
+ *                file name, found as model_path describes, and the mode,
+ *                TEX_FIT or TEX_TILE; a tiled texture is followed by the
+ *                size of one copy of it (w, h).
+ *
+ * Parameters:    in      - The file containing the textured plane
+ *                          specifications.
+ *                objtype - Represents the type of object to initialize.
+ *
+ * Return:        A pointer to the newly initialized textured plane.
+ */
+obj_t *texplane_init(FILE *in, int objtype) {
+    obj_t      *obj    = fplane_init(in, objtype);       /* The object     */
+    plane_t    *plane  = (plane_t *)obj->priv;           /* The plane      */
+    fplane_t   *fplane = (fplane_t *)plane->priv;        /* Finite plane   */
+    texplane_t *new    = (texplane_t *)Malloc(sizeof(texplane_t));
+    char       path[2 * BUF_SIZE];                       /* Texture path   */
+
+    /* Link the textured plane and override the reflectivity functions */
+    fplane->priv = new;
+    obj->surface = texplane_surface;
+    obj->getamb  = texplane_amb;
+    obj->getdiff = texplane_diff;
+    obj->destroy = texplane_destroy;
+    obj->dump    = texplane_dump;
+    new->width   = 0.0;
+    new->texture = NULL;
+
+    /* Get the texture file name */
+    model_path(in, new->name, path);
+
+    /* Get the texture mode and check for errors */
+    if (ivec_get1(in, &new->mode) != 1 ||
+        (new->mode != TEX_FIT && new->mode != TEX_TILE)) {
+        msg_exit(stderr, "texplane_init: error: invalid texture mode");
+    }
+
+    consume_line(in);
+
+    /* A fit texture covers the plane once */
+    new->tile[0] = fplane->size[0];
+    new->tile[1] = fplane->size[1];
+
+    /* Get the size of one copy of a tiled texture and check for errors */
+    if (new->mode == TEX_TILE) {
+        if (vec_get2(in, new->tile) != VEC_SIZE - 1) {
+            msg_exit(stderr, "texplane_init: error: invalid read count");
+        }
+
+        consume_line(in);
+    }
+
+    if (new->tile[0] <= 0.0 || new->tile[1] <= 0.0) {
+        msg_exit(stderr, "texplane_init: error: invalid texture size");
+    }
+
+    new->texture = texture_load(path);
+
+    return obj;
+}
+
+/*
+ * texplane_dump: Dumps the contents of the textured plane object to the
+ *                specified output file.  The hash of the texels is
+ *                included, so that editing the texture changes the dump.
+ *
+ * Parameters:    out - The file to which the plane object will be dumped.
+ *                obj - The plane object to dump.
+ *
+ * Return:        EXIT_SUCCESS if successful, EXIT_FAILURE otherwise.
+ */
+int texplane_dump(FILE *out, obj_t *obj) {
+    plane_t    *plane    = (plane_t *)obj->priv;       /* The plane    */
+    fplane_t   *fplane   = (fplane_t *)plane->priv;    /* Finite plane */
+    texplane_t *texplane = (texplane_t *)fplane->priv; /* The texture  */
+
+    fprintf(out, "Dumping object of type TexPlane\n");
+
+    /* Dump standard finite plane data */
+    fplane_dump(out, obj);
+
+    /* Print out the texplane information */
+    fprintf(out, "\nTexPlane data\n");
+    fprintf(out, "texture - \n%s\n", texplane->name);
+    ivec_prn1(out, "mode - ", &texplane->mode);
+    vec_prn2(out, "tile - ", texplane->tile);
+    ivec_prn2(out, "texels - ", texplane->texture->level[0].size);
+    fprintf(out, "texture hash - \n%016lx\n", texplane->texture->hash);
+
+    return EXIT_SUCCESS;
+}
+
+/*
+ * texplane_surface: Computes the hit location and normal of a ray that hit
+ *                   a textured plane object, with the texture coordinates
+ *                   of the hit and the width of the texture one pixel
+ *                   covers there.
+ *
+ * Parameters:       base - The origins of the ray (x, y, z).
+ *                   dir  - The direction of the ray (x, y, z).
+ *                   dist - The distance returned by the hits function.
+ *                   obj  - The textured plane object that was hit.
+ */
+void texplane_surface(double *base, double *dir, double dist, obj_t *obj) {
+    plane_t    *plane    = (plane_t *)obj->priv;       /* The plane      */
+    fplane_t   *fplane   = (fplane_t *)plane->priv;    /* Finite plane   */
+    texplane_t *texplane = (texplane_t *)fplane->priv; /* The texture    */
+    double     local[VEC_SIZE];                        /* Hit on plane   */
+    double     length = vec_length3(dir);              /* Ray dir length */
+
+    plane_surface(base, dir, dist, obj);
+
+    /* Find the hit in plane coordinates, as hits_fplane does */
+    vec_diff3(plane->point, obj->hitloc, local);
+    mat_xform3(fplane->rotmat, local, local);
+
+    fplane->lasthit[0] = local[0] / texplane->tile[0];
+    fplane->lasthit[1] = local[1] / texplane->tile[1];
+
+    texplane->width = texture_footprint(dist * length,
+                                        vec_dot3(dir, obj->normal) / length) /
+                      texplane->tile[0];
+}
+
+/*
+ * texplane_color: Looks up the texture color at the last hit.
+ *
+ * Parameters:     obj   - The textured plane object.
+ *                 color - Storage for the color (r, g, b).
+ */
+static void texplane_color(obj_t *obj, double *color) {
+    plane_t    *plane    = (plane_t *)obj->priv;       /* The plane    */
+    fplane_t   *fplane   = (fplane_t *)plane->priv;    /* Finite plane */
+    texplane_t *texplane = (texplane_t *)fplane->priv; /* The texture  */
+
+    texture_lookup(texplane->texture, fplane->lasthit[0], fplane->lasthit[1],
+                   texplane->width, texplane->mode == TEX_TILE, color);
+}
+
+/*
+ * texplane_amb: Retrieves the ambient lighting information for the
+ *               specified textured plane object, the material ambient
+ *               reflectivity scaled by the texture color.
+ *
+ * Parameters:   obj     - The object containing the textured plane data.
+ *               ambient - Storage for the ambient lighting information.
+ */
+void texplane_amb(obj_t *obj, double *ambient) {
+    double color[VEC_SIZE]; /* The texture color */
+    int    i;               /* Counter           */
+
+    texplane_color(obj, color);
+
+    for (i = 0; i < VEC_SIZE; ++i) {
+        ambient[i] = obj->material.ambient[i] * color[i];
+    }
+}
+
+/*
+ * texplane_diff: Retrieves the diffuse lighting information for the
+ *                specified textured plane object, the material diffuse
+ *                reflectivity scaled by the texture color.
+ *
+ * Parameters:    obj     - The object containing the textured plane data.
+ *                diffuse - Storage for the diffuse lighting information.
+ */
+void texplane_diff(obj_t *obj, double *diffuse) {
+    double color[VEC_SIZE]; /* The texture color */
+    int    i;               /* Counter           */
+
+    texplane_color(obj, color);
+
+    for (i = 0; i < VEC_SIZE; ++i) {
+        diffuse[i] = obj->material.diffuse[i] * color[i];
+    }
+}
+
+/*
+ * texplane_destroy: Destroys the specified textured plane object, releasing
+ *                   its texture.
+ *
+ * Parameters:       obj - The textured plane object to destroy.
+ */
+void texplane_destroy(obj_t *obj) {
+    plane_t    *plane    = (plane_t *)obj->priv;       /* The plane    */
+    fplane_t   *fplane   = (fplane_t *)plane->priv;    /* Finite plane */
+    texplane_t *texplane = (texplane_t *)fplane->priv; /* The texture  */
+
+    if (texplane->texture) {
+        texture_release(texplane->texture);
+    }
+
+    Free(texplane);
+    plane_destroy(obj);
+}
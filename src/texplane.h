@@ -0,0 +1,43 @@
+/*
+ * texplane.h: This header file contains the implementation specifications
+ *             for a textured plane, a finite plane colored by a texture.
+ *
+ * Author:     Scott Gigawatt
+ *
+ * Version:    18 October 2026
+ */
+
+#ifndef TEXPLANE_H
+#define TEXPLANE_H
+
+#include "fplane.h"
+#include "texture.h"
+
+/* Represents a textured plane */
+typedef struct texplane_type {
+    tex_t  *texture;       /* The shared texture          */
+    char   name[BUF_SIZE]; /* The texture file, as given  */
+    int    mode;           /* TEX_FIT or TEX_TILE         */
+    double tile[2];        /* Size of one copy (w, h)     */
+    double width;          /* Width filtered at last hit  */
+} texplane_t;
+
+/* Allocates memory for, initializes, and returns a new textured plane */
+obj_t *texplane_init(FILE *in, int objtype);
+
+/* Dumps the contents of the textured plane object to the specified file */
+int texplane_dump(FILE *out, obj_t *obj);
+
+/* Computes the hit location, normal, and texture coordinates of a hit */
+void texplane_surface(double *base, double *dir, double dist, obj_t *obj);
+
+/* Retrieves the ambient lighting information for a textured plane */
+void texplane_amb(obj_t *obj, double *ambient);
+
+/* Retrieves the diffuse lighting information for a textured plane */
+void texplane_diff(obj_t *obj, double *diffuse);
+
+/* Destroys the specified textured plane object */
+void texplane_destroy(obj_t *obj);
+
+#endif
@@ -0,0 +1,413 @@
+/*
+ * texture.c: This file contains the implementation details for textures.
+ *            A texture is read from a binary PPM file by mapping it into
+ *            memory, and its mip pyramid is built once and shared through a
+ *            cache by every object that names the same file.  The texels of
+ *            each level are stored a tile at a time, so a lookup touches few
+ *            cache lines.
+ *
+ * Author:    Scott Gigawatt
+ *
+ * Version:   18 October 2026
+ */
+
+#include <ctype.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "texture.h"
+#include "mem.h"
+#include "model.h"
+
+/* The bytes per texel (r, g, b) */
+#define TEX_TEXEL_SIZE 3
+
+/* The cosine below which a surface seen edge on is treated as this steep */
+#define TEX_MIN_COSINE 0.01
+
+/* The textures read so far */
+static tex_t *cache = NULL;
+
+/* The angle covered by one pixel, in radians (zero to never filter) */
+static double pixel_angle = 0.0;
+
+/*
+ * texel:      Finds a texel of a level of detail in its tiled layout.
+ *
+ * Parameters: level - The level of detail.
+ *             x     - The column of the texel.
+ *             y     - The row of the texel, from the top.
+ *
+ * Return:     A pointer to the texel (r, g, b).
+ */
+static unsigned char *texel(tex_level_t *level, int x, int y) {
+    size_t tile = (size_t)(y / TEX_TILE_TEXELS) * level->tiles +
+                  x / TEX_TILE_TEXELS;                    /* The tile index */
+
+    return level->texels + TEX_TEXEL_SIZE *
+           ((tile * TEX_TILE_TEXELS + y % TEX_TILE_TEXELS) * TEX_TILE_TEXELS +
+            x % TEX_TILE_TEXELS);
+}
+
+/*
+ * level_init: Allocates the texels of a level of detail of a size.
+ *
+ * Parameters: level  - The level of detail.
+ *             width  - The width in texels.
+ *             height - The height in texels.
+ */
+static void level_init(tex_level_t *level, int width, int height) {
+    int rows = (height + TEX_TILE_TEXELS - 1) / TEX_TILE_TEXELS; /* Tile rows */
+
+    level->size[0] = width;
+    level->size[1] = height;
+    level->tiles   = (width + TEX_TILE_TEXELS - 1) / TEX_TILE_TEXELS;
+    level->texels  = (unsigned char *)Malloc((size_t)level->tiles * rows *
+                     TEX_TILE_TEXELS * TEX_TILE_TEXELS * TEX_TEXEL_SIZE);
+}
+
+/*
+ * ppm_number: Reads a number from the header of a mapped PPM file,
+ *             skipping white space and comments.
+ *
+ * Parameters: data - The mapped file.
+ *             size - The size of the file in bytes.
+ *             pos  - The position to read from, advanced past the number.
+ *
+ * Return:     The number, or -1 if there is none.
+ */
+static long ppm_number(unsigned char *data, size_t size, size_t *pos) {
+    long value = -1; /* The number read */
+
+    while (*pos < size && (isspace(data[*pos]) || data[*pos] == '#')) {
+        if (data[(*pos)++] == '#') {
+            while (*pos < size && data[*pos] != '\n') {
+                ++*pos;
+            }
+        }
+    }
+
+    while (*pos < size && isdigit(data[*pos]) && value < INT_MAX) {
+        value = (value < 0 ? 0 : value * 10) + (data[(*pos)++] - '0');
+    }
+
+    return value;
+}
+
+/*
+ * texture_read: Reads the largest level of detail of a texture from a
+ *               binary (P6) PPM file, mapped into memory.
+ *
+ * Parameters:   tex - The texture, with its path set.
+ */
+static void texture_read(tex_t *tex) {
+    struct stat   st;           /* The file status        */
+    unsigned char *data;        /* The mapped file        */
+    size_t        pos = 2;      /* Position in the header */
+    long          width;        /* The width in texels    */
+    long          height;       /* The height in texels   */
+    long          maxval;       /* The largest component  */
+    int           fd;           /* The file descriptor    */
+    int           x;            /* Column                 */
+    int           y;            /* Row                    */
+
+    if ((fd = open(tex->path, O_RDONLY)) < 0 || fstat(fd, &st) < 0) {
+        msg_exit(stderr, "texture_read: error: cannot open texture file");
+    }
+
+    data = (unsigned char *)mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE,
+                                 fd, 0);
+
+    if (data == MAP_FAILED) {
+        msg_exit(stderr, "texture_read: error: cannot map texture file");
+    }
+
+    close(fd);
+
+    /* Read the header, which is followed by one white space character */
+    if (st.st_size < 2 || data[0] != 'P' || data[1] != '6') {
+        msg_exit(stderr, "texture_read: error: texture is not a P6 PPM");
+    }
+
+    width  = ppm_number(data, st.st_size, &pos);
+    height = ppm_number(data, st.st_size, &pos);
+    maxval = ppm_number(data, st.st_size, &pos);
+    ++pos;
+
+    if (width <= 0 || height <= 0 || width >= INT_MAX || height >= INT_MAX) {
+        msg_exit(stderr, "texture_read: error: invalid texture size");
+    }
+
+    if (maxval != 255) {
+        msg_exit(stderr, "texture_read: error: texture maxval is not 255");
+    }
+
+    if ((size_t)st.st_size < pos ||
+        ((size_t)st.st_size - pos) / TEX_TEXEL_SIZE / width < (size_t)height) {
+        msg_exit(stderr, "texture_read: error: texture file is truncated");
+    }
+
+    /* Copy the texels into the tiled layout */
+    level_init(&tex->level[0], width, height);
+
+    for (y = 0; y < height; ++y) {
+        for (x = 0; x < width; ++x) {
+            memcpy(texel(&tex->level[0], x, y),
+                   data + pos + ((size_t)y * width + x) * TEX_TEXEL_SIZE,
+                   TEX_TEXEL_SIZE);
+        }
+    }
+
+    tex->hash = hash_text((char *)data + pos,
+                          (size_t)width * height * TEX_TEXEL_SIZE);
+
+    munmap(data, st.st_size);
+}
+
+/*
+ * texture_mip: Builds the smaller levels of detail of a texture, each half
+ *              the size of the one before it, down to a single texel.
+ *
+ * Parameters:  tex - The texture, with its largest level read.
+ */
+static void texture_mip(tex_t *tex) {
+    tex_level_t   *src;    /* The level filtered        */
+    tex_level_t   *dst;    /* The level built           */
+    unsigned char *out;    /* A texel built             */
+    int           sum;     /* Sum of one component      */
+    int           x;       /* Column                    */
+    int           y;       /* Row                       */
+    int           x1;      /* Second column filtered    */
+    int           y1;      /* Second row filtered       */
+    int           i;       /* Component                 */
+
+    for (tex->levels = 1; tex->levels < TEX_LEVELS; ++tex->levels) {
+        src = &tex->level[tex->levels - 1];
+        dst = &tex->level[tex->levels];
+
+        if (src->size[0] == 1 && src->size[1] == 1) {
+            break;
+        }
+
+        level_init(dst, src->size[0] > 1 ? src->size[0] / 2 : 1,
+                        src->size[1] > 1 ? src->size[1] / 2 : 1);
+
+        /* Average each 2x2 block, clamped at the edges */
+        for (y = 0; y < dst->size[1]; ++y) {
+            y1 = 2 * y + 1 < src->size[1] ? 2 * y + 1 : src->size[1] - 1;
+
+            for (x = 0; x < dst->size[0]; ++x) {
+                x1  = 2 * x + 1 < src->size[0] ? 2 * x + 1 : src->size[0] - 1;
+                out = texel(dst, x, y);
+
+                for (i = 0; i < TEX_TEXEL_SIZE; ++i) {
+                    sum    = texel(src, 2 * x, 2 * y)[i] +
+                             texel(src, x1, 2 * y)[i] +
+                             texel(src, 2 * x, y1)[i] +
+                             texel(src, x1, y1)[i];
+                    out[i] = (unsigned char)((sum + 2) / 4);
+                }
+            }
+        }
+    }
+}
+
+/*
+ * texture_load: Gets the texture read from the specified PPM file.  The
+ *               file is read and its mip pyramid built only the first time
+ *               it is named; later objects share the cached texture.
+ *
+ * Parameters:   path - The path of the PPM file.
+ *
+ * Return:       The texture, to be released with texture_release.
+ */
+tex_t *texture_load(char *path) {
+    tex_t *tex; /* The texture */
+
+    for (tex = cache; tex; tex = tex->next) {
+        if (strcmp(tex->path, path) == 0) {
+            ++tex->refs;
+            return tex;
+        }
+    }
+
+    tex       = (tex_t *)Malloc(sizeof(tex_t));
+    tex->path = (char *)Malloc(strlen(path) + 1);
+    tex->refs = 1;
+    strcpy(tex->path, path);
+
+    texture_read(tex);
+    texture_mip(tex);
+
+    tex->next = cache;
+    cache     = tex;
+
+    return tex;
+}
+
+/*
+ * texture_release: Releases a texture, removing it from the cache and
+ *                  destroying it once no object uses it.
+ *
+ * Parameters:      tex - The texture to release.
+ */
+void texture_release(tex_t *tex) {
+    tex_t **link; /* The link to the texture in the cache */
+    int   i;      /* Level                                */
+
+    if (--tex->refs > 0) {
+        return;
+    }
+
+    for (link = &cache; *link != tex; link = &(*link)->next) {
+        ;
+    }
+
+    *link = tex->next;
+
+    for (i = 0; i < tex->levels; ++i) {
+        Free(tex->level[i].texels);
+    }
+
+    Free(tex->path);
+    Free(tex);
+}
+
+/*
+ * texture_pixel: Sets the angle covered by one pixel, seen from the view
+ *                point, which sizes the area each texture lookup filters.
+ *
+ * Parameters:    angle - The angle in radians.
+ */
+void texture_pixel(double angle) {
+    pixel_angle = angle;
+}
+
+/*
+ * texture_footprint: Finds the width of the area one pixel covers on a
+ *                    surface at a distance along the ray, as the geometric
+ *                    mean of its width and its length stretched by the
+ *                    slant of the surface.
+ *
+ * Parameters:        dist   - The distance traveled by the ray.
+ *                    cosine - The cosine of the ray with the surface normal.
+ *
+ * Return:            The width, in world units.
+ */
+double texture_footprint(double dist, double cosine) {
+    cosine = fabs(cosine);
+
+    if (cosine < TEX_MIN_COSINE) {
+        cosine = TEX_MIN_COSINE;
+    }
+
+    return pixel_angle * dist / sqrt(cosine);
+}
+
+/*
+ * level_lookup: Looks up the color of a level of detail of a texture,
+ *               interpolated bilinearly between the four nearest texels.
+ *
+ * Parameters:   level - The level of detail.
+ *               s     - The texture coordinate across, 0 to 1.
+ *               t     - The texture coordinate up, 0 to 1.
+ *               wrap  - Nonzero to repeat the texture, zero to clamp it.
+ *               color - Storage for the color (r, g, b), 0 to 1.
+ */
+static void level_lookup(tex_level_t *level, double s, double t, int wrap,
+                         double *color) {
+    double u = s * level->size[0] - 0.5;         /* Column, in texels */
+    double v = (1.0 - t) * level->size[1] - 0.5; /* Row, in texels    */
+    double fu;                                   /* Column fraction   */
+    double fv;                                   /* Row fraction      */
+    int    x[2];                                 /* Columns blended   */
+    int    y[2];                                 /* Rows blended      */
+    int    i;                                    /* Counter           */
+
+    x[0] = (int)floor(u);
+    y[0] = (int)floor(v);
+    fu   = u - x[0];
+    fv   = v - y[0];
+
+    for (i = 0; i < 2; ++i) {
+        x[i] = x[0] + i;
+        y[i] = y[0] + i;
+
+        if (wrap) {
+            x[i] %= level->size[0];
+            y[i] %= level->size[1];
+            x[i] += x[i] < 0 ? level->size[0] : 0;
+            y[i] += y[i] < 0 ? level->size[1] : 0;
+        } else {
+            x[i] = x[i] < 0 ? 0 : x[i] >= level->size[0] ?
+                   level->size[0] - 1 : x[i];
+            y[i] = y[i] < 0 ? 0 : y[i] >= level->size[1] ?
+                   level->size[1] - 1 : y[i];
+        }
+    }
+
+    for (i = 0; i < VEC_SIZE; ++i) {
+        color[i] = ((1.0 - fu) * (1.0 - fv) * texel(level, x[0], y[0])[i] +
+                    fu * (1.0 - fv) * texel(level, x[1], y[0])[i] +
+                    (1.0 - fu) * fv * texel(level, x[0], y[1])[i] +
+                    fu * fv * texel(level, x[1], y[1])[i]) / 255.0;
+    }
+}
+
+/*
+ * texture_lookup: Looks up the color of a texture, filtered over an area.
+ *                 The two levels of detail whose texels are nearest the
+ *                 width of the area are each interpolated bilinearly and
+ *                 then blended (trilinear filtering).
+ *
+ * Parameters:     tex   - The texture.
+ *                 s     - The texture coordinate across, 0 to 1.
+ *                 t     - The texture coordinate up, 0 to 1.
+ *                 width - The width of the area, as a fraction of the width
+ *                         of the texture (zero for the largest level).
+ *                 wrap  - Nonzero to repeat the texture, zero to clamp it.
+ *                 color - Storage for the color (r, g, b), 0 to 1.
+ */
+void texture_lookup(tex_t *tex, double s, double t, double width, int wrap,
+                    double *color) {
+    double lod = 0.0;       /* The level of detail, fractional */
+    double next[VEC_SIZE];  /* The color of the smaller level  */
+    int    level;           /* The larger level blended        */
+    int    i;               /* Counter                         */
+
+    if (width > 0.0) {
+        lod = log2(width * tex->level[0].size[0]);
+    }
+
+    if (wrap) {
+        s -= floor(s);
+        t -= floor(t);
+    }
+
+    /* Magnified, or smaller than the smallest level: a single level */
+    if (!(lod > 0.0)) {
+        level_lookup(&tex->level[0], s, t, wrap, color);
+        return;
+    }
+
+    if (lod >= tex->levels - 1) {
+        level_lookup(&tex->level[tex->levels - 1], s, t, wrap, color);
+        return;
+    }
+
+    level = (int)lod;
+    lod  -= level;
+
+    level_lookup(&tex->level[level], s, t, wrap, color);
+    level_lookup(&tex->level[level + 1], s, t, wrap, next);
+
+    for (i = 0; i < VEC_SIZE; ++i) {
+        color[i] += lod * (next[i] - color[i]);
+    }
+}
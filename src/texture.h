@@ -0,0 +1,57 @@
+/*
+ * texture.h: This header file contains the implementation specifications
+ *            for textures, read from PPM files and shared by every object
+ *            that names the same file.
+ *
+ * Author:    Scott Gigawatt
+ *
+ * Version:   18 October 2026
+ */
+
+#ifndef TEXTURE_H
+#define TEXTURE_H
+
+#include "veclib3d.h"
+
+/* The width and height of a tile of texels, in texels (a power of 2) */
+#ifndef TEX_TILE_TEXELS
+    #define TEX_TILE_TEXELS 8
+#endif
+
+/* The most levels of detail of a texture (up to 2^31 texels wide) */
+#define TEX_LEVELS 32
+
+/* A level of detail of a texture, stored a tile of texels at a time */
+typedef struct tex_level_type {
+    int           size[2]; /* The width and height in texels           */
+    int           tiles;   /* The number of tiles across a row of them */
+    unsigned char *texels; /* The texels (r, g, b), tile by tile       */
+} tex_level_t;
+
+/* A texture, with its mip pyramid of levels of detail */
+typedef struct texture_type {
+    char                *path;              /* The file it was read from  */
+    int                 refs;               /* The objects using it       */
+    unsigned long       hash;               /* The hash of the texels     */
+    int                 levels;             /* The number of levels       */
+    tex_level_t         level[TEX_LEVELS];  /* The levels, largest first  */
+    struct texture_type *next;              /* Next texture in the cache  */
+} tex_t;
+
+/* Gets the texture read from the specified PPM file, reading it once */
+tex_t *texture_load(char *path);
+
+/* Releases a texture, destroying it once no object uses it */
+void texture_release(tex_t *tex);
+
+/* Sets the angle covered by one pixel, which sizes texture lookups */
+void texture_pixel(double angle);
+
+/* Finds the width of the area one pixel covers at a distance */
+double texture_footprint(double dist, double cosine);
+
+/* Looks up the color of a texture, filtered over an area */
+void texture_lookup(tex_t *tex, double s, double t, double width, int wrap,
+                    double *color);
+
+#endif
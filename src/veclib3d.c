@@ -343,6 +343,42 @@ void vec_reflect3(double *unitin, double *unitnorm, double *unitout) {
     vec_unit3(v, unitout);
 }
 
+/*
+ * vec_refract3: Computes the direction of a refracted ray of light, by
+ *               Snell's law.
+ *
+ * Parameters:   unitin   - Unit vector in incoming direction.
+ *               unitnorm - Unit surface normal, facing against the ray.
+ *               eta      - The index of refraction on the side the ray
+ *                          comes from over that of the side it enters.
+ *               unitout  - Unit vector in direction of refraction.
+ *
+ * Return:       The cosine of the refracted ray with the normal, or zero if
+ *               the ray is totally internally reflected, leaving unitout
+ *               unchanged.
+ */
+double vec_refract3(double *unitin, double *unitnorm, double eta,
+                    double *unitout) {
+    double cosi = -vec_dot3(unitin, unitnorm);     /* Cosine in            */
+    double sin2 = eta * eta * (1.0 - cosi * cosi); /* Sine squared out     */
+    double cost;                                   /* Cosine out           */
+    int    i;                                      /* Counter              */
+
+    if (sin2 >= 1.0) {
+        return 0.0;
+    }
+
+    cost = sqrt(1.0 - sin2);
+
+    for (i = 0; i < VEC_SIZE; ++i) {
+        unitout[i] = eta * unitin[i] + (eta * cosi - cost) * unitnorm[i];
+    }
+
+    vec_unit3(unitout, unitout);
+
+    return cost;
+}
+
 /* 
  * mat_id3:    Constructs a 3 x 3 identity matrix.
  *
@@ -479,13 +515,48 @@ void mat_prn3(FILE *out, char *label, double x[][VEC_SIZE]) {
     }
 }
 
+/* Set while a library call is running, which errors return to */
+static jmp_buf *msg_env = NULL;
+
+/* The message of the last error caught by msg_trap */
+static char msg_text[MSG_SIZE] = "";
+
 /*
- * msg_exit:   Prints an error message to the specified file and exits.
+ * msg_exit:   Prints an error message to the specified file and exits.  If
+ *             msg_trap is set, the message is kept for msg_last and control
+ *             returns to the trap instead.
  *             
  * Parameters: out - The output file.
  *             msg - The error message.
  */
 void msg_exit(FILE *out, char *msg) {
+    jmp_buf *env = msg_env; /* The trap, if any */
+
+    if (env) {
+        snprintf(msg_text, MSG_SIZE, "%s", msg);
+        msg_env = NULL;
+        longjmp(*env, 1);
+    }
+
     fprintf(out, "%s\n", msg);
     exit(EXIT_FAILURE);
 }
+
+/*
+ * msg_trap:   Makes msg_exit return to the specified setjmp point rather
+ *             than exit.  The trap is cleared when an error is caught.
+ *
+ * Parameters: env - The setjmp point, or NULL to exit on errors again.
+ */
+void msg_trap(jmp_buf *env) {
+    msg_env = env;
+}
+
+/*
+ * msg_last:   Returns the message of the last error caught by msg_trap.
+ *
+ * Return:     The error message, or an empty string.
+ */
+const char *msg_last(void) {
+    return msg_text;
+}
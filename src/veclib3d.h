@@ -11,11 +11,15 @@
 #define VECLIB3D_H
 
 #include <math.h>
+#include <setjmp.h>
 #include <stdio.h>
 
 /* The size of a 3D vector */
 #define VEC_SIZE 3
 
+/* The longest error message kept by msg_trap */
+#define MSG_SIZE 256
+
 /* Computes the dot product of two vectors */
 double vec_dot3(double *v1, double *v2);
 
@@ -79,6 +83,10 @@ void vec_project3(double *n, double *v, double *w);
 /* Computes the direction of a reflected ray of light */
 void vec_reflect3(double *unitin, double *unitnorm, double *unitout);
 
+/* Computes the direction of a refracted ray of light */
+double vec_refract3(double *unitin, double *unitnorm, double eta,
+                    double *unitout);
+
 /* Constructs an identity matrix */
 void mat_id3(double mtx[][VEC_SIZE]);
 
@@ -100,4 +108,10 @@ void mat_prn3(FILE *out, char *label, double x[][VEC_SIZE]);
 /* Prints an error message to the specified file and exits */
 void msg_exit(FILE *out, char *msg);
 
+/* Makes errors return to the specified setjmp point rather than exit */
+void msg_trap(jmp_buf *env);
+
+/* Returns the message of the last error caught by msg_trap */
+const char *msg_last(void);
+
 #endif
@@ -0,0 +1,173 @@
+/*
+ * libtest.c: This file contains a program for testing the ray tracer
+ *            library.  The scene read from standard in is loaded with
+ *            rt_load and rendered with rt_render into a buffer of the chosen
+ *            pixel format, with padding at the end of each row, and then
+ *            written to standard out as a PPM image.  The padding must be
+ *            left untouched.  Library errors are reported as "ERROR code
+ *            message" on standard out, with an exit status of 2.
+ *
+ *            Usage: libtest [-f rgb|rgba|bgra] [-p padding] width height
+ *
+ * Author:    Scott Gigawatt
+ *
+ * Version:   18 October 2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "libraytrace.h"
+
+/* The value the padding bytes are filled with */
+#define PAD_BYTE 0xa5
+
+/* The exit status of a library error */
+#define EXIT_ERROR 2
+
+/*
+ * read_all:   Reads the whole of the specified file.
+ *
+ * Parameters: in   - The file.
+ *             size - Set to the number of bytes read.
+ *
+ * Return:     The bytes read.
+ */
+static char *read_all(FILE *in, size_t *size) {
+    char   *text = NULL; /* The bytes read    */
+    size_t room  = 0;    /* The buffer size   */
+    size_t got;          /* Bytes just read   */
+
+    *size = 0;
+
+    do {
+        if (*size == room) {
+            room = room ? 2 * room : BUFSIZ;
+
+            if ((text = (char *)realloc(text, room)) == NULL) {
+                fprintf(stderr, "libtest: error: out of memory\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        got    = fread(text + *size, 1, room - *size, in);
+        *size += got;
+    } while (got > 0);
+
+    return text;
+}
+
+/*
+ * usage:      Prints the program usage and exits.
+ *
+ * Parameters: name - The program name.
+ */
+static void usage(char *name) {
+    fprintf(stderr, "usage: %s [-f rgb|rgba|bgra] [-p padding] width "
+                    "height\n", name);
+    exit(EXIT_FAILURE);
+}
+
+/*
+ * main:       This function renders standard in through the library.
+ *
+ * Parameters: argc - The number of command line arguments.
+ *             argv - The command line arguments.
+ *
+ * Return:     EXIT_SUCCESS if the image was rendered, failure otherwise.
+ */
+int main(int argc, char **argv) {
+    model_t       *model = NULL;   /* The loaded model         */
+    rt_image_t    image;           /* The caller-owned buffer  */
+    unsigned char *row;            /* The current row          */
+    char          *scene;          /* The scene text           */
+    size_t        size;            /* The scene text length    */
+    size_t        k;               /* Padding index            */
+    int           padding = 0;     /* Bytes after each row     */
+    int           bpp;             /* Bytes per pixel          */
+    int           rc;              /* The library error code   */
+    int           opt;             /* Current option           */
+    int           i;               /* Row index                */
+    int           j;               /* Column index             */
+
+    image.format = RT_RGB;
+
+    while ((opt = getopt(argc, argv, "f:p:")) != -1) {
+        switch (opt) {
+            case 'f':
+                if (!strcmp(optarg, "rgb")) {
+                    image.format = RT_RGB;
+                } else if (!strcmp(optarg, "rgba")) {
+                    image.format = RT_RGBA;
+                } else if (!strcmp(optarg, "bgra")) {
+                    image.format = RT_BGRA;
+                } else {
+                    usage(*argv);
+                }
+                break;
+            case 'p': padding = atoi(optarg); break;
+            default:  usage(*argv);
+        }
+    }
+
+    if (argc - optind != 2 || padding < 0) {
+        usage(*argv);
+    }
+
+    scene = read_all(stdin, &size);
+
+    if ((rc = rt_load(scene, size, atoi(argv[optind]),
+                      atoi(argv[optind + 1]), &model)) ||
+        (rc = rt_size(model, &image.width, &image.height))) {
+        printf("ERROR %d %s\n", rc, rt_error());
+        return EXIT_ERROR;
+    }
+
+    bpp          = image.format == RT_RGB ? 3 : 4;
+    image.stride = (size_t)image.width * bpp + padding;
+    image.pixels = (unsigned char *)malloc(image.stride * image.height);
+
+    if (image.pixels == NULL) {
+        fprintf(stderr, "libtest: error: out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    memset(image.pixels, PAD_BYTE, image.stride * image.height);
+
+    if ((rc = rt_render(model, &image))) {
+        printf("ERROR %d %s\n", rc, rt_error());
+        return EXIT_ERROR;
+    }
+
+    printf("P6 %d %d 255\n", image.width, image.height);
+
+    for (i = 0; i < image.height; ++i) {
+        row = image.pixels + i * image.stride;
+
+        /* The row padding belongs to the caller */
+        for (k = (size_t)image.width * bpp; k < image.stride; ++k) {
+            if (row[k] != PAD_BYTE) {
+                fprintf(stderr, "libtest: error: row %d padding written\n",
+                                i);
+                return EXIT_FAILURE;
+            }
+        }
+
+        for (j = 0; j < image.width; ++j, row += bpp) {
+            if (image.format == RT_BGRA) {
+                putchar(row[2]);
+                putchar(row[1]);
+                putchar(row[0]);
+            } else {
+                fwrite(row, 1, 3, stdout);
+            }
+        }
+    }
+
+    rt_free(model);
+    free(image.pixels);
+    free(scene);
+
+    return EXIT_SUCCESS;
+}
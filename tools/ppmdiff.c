@@ -0,0 +1,282 @@
+/*
+ * ppmdiff.c: This file contains a program for comparing a rendered PPM image
+ *            against a reference image.  The images match when few enough
+ *            pixels differ by more than a per-channel tolerance and the peak
+ *            signal to noise ratio is high enough.  A difference image may be
+ *            written when the images do not match.
+ *
+ * Author:    Scott Gigawatt
+ *
+ * Version:   18 October 2026
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define MAX_COLOR  255
+#define ID_COLOR   "P6"
+#define ID_SIZE    3
+#define PIXEL_SIZE 3
+
+/* Default comparison thresholds */
+#define DEF_TOLERANCE 8     /* Largest channel difference for a good pixel */
+#define DEF_FRACTION  0.01  /* Largest fraction of pixels that may be bad  */
+#define DEF_PSNR      35.0  /* Smallest acceptable PSNR in decibels        */
+
+/* A decoded PPM image */
+typedef struct ppm_type {
+    int           width;  /* The image width in pixels  */
+    int           height; /* The image height in pixels */
+    unsigned char *data;  /* The (r, g, b) pixel data   */
+} ppm_t;
+
+/*
+ * read_field: Reads the next integer field of a PPM header, skipping any
+ *             whitespace and comments.
+ *
+ * Parameters: in - The image file.
+ *
+ * Return:     The field value, or -1 if the field could not be read.
+ */
+static int read_field(FILE *in) {
+    int c;     /* The current character */
+    int value; /* The field value       */
+
+    /* Skip whitespace and comments */
+    while ((c = fgetc(in)) != EOF) {
+        if (c == '#') {
+            while ((c = fgetc(in)) != EOF && c != '\n');
+        } else if (c != ' ' && c != '\t' && c != '\r' && c != '\n') {
+            ungetc(c, in);
+            break;
+        }
+    }
+
+    if (fscanf(in, "%d", &value) != 1) {
+        return -1;
+    }
+
+    return value;
+}
+
+/*
+ * read_ppm:   Reads a binary color PPM image from the specified file.
+ *
+ * Parameters: path - The path of the image file.
+ *             img  - Storage for the decoded image.
+ *
+ * Return:     EXIT_SUCCESS if the image was read, EXIT_FAILURE otherwise.
+ */
+static int read_ppm(char *path, ppm_t *img) {
+    FILE   *in = fopen(path, "rb"); /* The image file    */
+    char   id[ID_SIZE];             /* The PPM header id */
+    size_t num_pix;                 /* The pixel count   */
+    int    maxval;                  /* The maximum color */
+
+    if (in == NULL) {
+        fprintf(stderr, "ppmdiff: error: cannot open '%s'\n", path);
+        return EXIT_FAILURE;
+    }
+
+    /* Read and validate the header */
+    if (fscanf(in, "%2s", id) != 1 || strcmp(id, ID_COLOR)) {
+        fprintf(stderr, "ppmdiff: error: '%s' is not a P6 image\n", path);
+        fclose(in);
+        return EXIT_FAILURE;
+    }
+
+    img->width  = read_field(in);
+    img->height = read_field(in);
+    maxval      = read_field(in);
+
+    if (img->width <= 0 || img->height <= 0 || maxval != MAX_COLOR) {
+        fprintf(stderr, "ppmdiff: error: '%s' has a bad header\n", path);
+        fclose(in);
+        return EXIT_FAILURE;
+    }
+
+    /* Consume the single whitespace character before the pixel data */
+    fgetc(in);
+
+    /* Read the pixel data */
+    num_pix   = (size_t)img->width * img->height;
+    img->data = (unsigned char *)malloc(num_pix * PIXEL_SIZE);
+
+    if (img->data == NULL || fread(img->data, PIXEL_SIZE, num_pix, in)
+                                                               != num_pix) {
+        fprintf(stderr, "ppmdiff: error: '%s' is truncated\n", path);
+        fclose(in);
+        return EXIT_FAILURE;
+    }
+
+    fclose(in);
+
+    return EXIT_SUCCESS;
+}
+
+/*
+ * write_diff: Writes a difference image which shows the reference image at
+ *             a quarter of its brightness with every bad pixel in red.
+ *
+ * Parameters: path      - The path of the difference image.
+ *             ref       - The reference image.
+ *             img       - The compared image.
+ *             tolerance - The largest channel difference for a good pixel.
+ *
+ * Return:     EXIT_SUCCESS if the image was written, EXIT_FAILURE otherwise.
+ */
+static int write_diff(char *path, ppm_t *ref, ppm_t *img, int tolerance) {
+    FILE          *out = fopen(path, "wb"); /* The difference file */
+    unsigned char *a;                       /* Reference pixel     */
+    unsigned char *b;                       /* Compared pixel      */
+    unsigned char pix[PIXEL_SIZE];          /* Output pixel        */
+    size_t        num_pix;                  /* The pixel count     */
+    size_t        i;                        /* Pixel index         */
+    int           j;                        /* Channel index       */
+    int           bad;                      /* Pixel is bad        */
+
+    if (out == NULL) {
+        fprintf(stderr, "ppmdiff: error: cannot create '%s'\n", path);
+        return EXIT_FAILURE;
+    }
+
+    fprintf(out, "%s %d %d %d\n", ID_COLOR, ref->width, ref->height,
+                                  MAX_COLOR);
+
+    num_pix = (size_t)ref->width * ref->height;
+
+    for (i = 0; i < num_pix; ++i) {
+        a   = ref->data + i * PIXEL_SIZE;
+        b   = img->data + i * PIXEL_SIZE;
+        bad = 0;
+
+        for (j = 0; j < PIXEL_SIZE; ++j) {
+            bad |= abs(a[j] - b[j]) > tolerance;
+            pix[j] = a[j] / 4;
+        }
+
+        /* Highlight the pixels that are out of tolerance */
+        if (bad) {
+            pix[0] = MAX_COLOR;
+            pix[1] = pix[2] = 0;
+        }
+
+        fwrite(pix, PIXEL_SIZE, 1, out);
+    }
+
+    fclose(out);
+
+    return EXIT_SUCCESS;
+}
+
+/*
+ * usage:      Prints the program usage and exits.
+ *
+ * Parameters: name - The program name.
+ */
+static void usage(char *name) {
+    fprintf(stderr, "usage: %s [-t tolerance] [-f fraction] [-p psnr] "
+                    "[-d diff.ppm] reference.ppm image.ppm\n", name);
+    exit(EXIT_FAILURE);
+}
+
+/*
+ * main:       This function compares two PPM images and reports whether
+ *             they match.
+ *
+ * Parameters: argc - The number of command line arguments.
+ *             argv - The command line arguments.
+ *
+ * Return:     EXIT_SUCCESS if the images match, failure otherwise.
+ */
+int main(int argc, char **argv) {
+    ppm_t  ref;                        /* The reference image           */
+    ppm_t  img;                        /* The compared image            */
+    char   *diff      = NULL;          /* The difference image path     */
+    int    tolerance  = DEF_TOLERANCE; /* Per-channel tolerance         */
+    double fraction   = DEF_FRACTION;  /* Allowed fraction bad pixels   */
+    double min_psnr   = DEF_PSNR;      /* Smallest acceptable PSNR      */
+    double sq_err     = 0.0;           /* Summed squared error          */
+    double psnr;                       /* Peak signal to noise ratio    */
+    size_t num_pix;                    /* The pixel count               */
+    size_t num_bad    = 0;             /* Pixels out of tolerance       */
+    size_t i;                          /* Pixel index                   */
+    int    max_diff   = 0;             /* Largest channel difference    */
+    int    diff_val;                   /* Current channel difference    */
+    int    bad;                        /* Current pixel is bad          */
+    int    pass;                       /* The images match              */
+    int    opt;                        /* Current option                */
+    int    j;                          /* Channel index                 */
+
+    /* Parse the command line options */
+    while ((opt = getopt(argc, argv, "t:f:p:d:")) != -1) {
+        switch (opt) {
+            case 't': tolerance = atoi(optarg); break;
+            case 'f': fraction  = atof(optarg); break;
+            case 'p': min_psnr  = atof(optarg); break;
+            case 'd': diff      = optarg;       break;
+            default:  usage(*argv);
+        }
+    }
+
+    if (argc - optind != 2) {
+        usage(*argv);
+    }
+
+    /* Read both images */
+    if (read_ppm(argv[optind], &ref) || read_ppm(argv[optind + 1], &img)) {
+        return EXIT_FAILURE;
+    }
+
+    if (ref.width != img.width || ref.height != img.height) {
+        fprintf(stderr, "ppmdiff: error: size %dx%d does not match %dx%d\n",
+                        img.width, img.height, ref.width, ref.height);
+        return EXIT_FAILURE;
+    }
+
+    /* Accumulate the per-pixel statistics */
+    num_pix = (size_t)ref.width * ref.height;
+
+    for (i = 0; i < num_pix; ++i) {
+        bad = 0;
+
+        for (j = 0; j < PIXEL_SIZE; ++j) {
+            diff_val = abs(ref.data[i * PIXEL_SIZE + j] -
+                           img.data[i * PIXEL_SIZE + j]);
+            sq_err  += (double)diff_val * diff_val;
+            bad     |= diff_val > tolerance;
+
+            if (diff_val > max_diff) {
+                max_diff = diff_val;
+            }
+        }
+
+        num_bad += bad;
+    }
+
+    /* Compute the peak signal to noise ratio (infinite when identical) */
+    if (sq_err == 0.0) {
+        psnr = INFINITY;
+    } else {
+        psnr = 10.0 * log10((double)MAX_COLOR * MAX_COLOR /
+                            (sq_err / (num_pix * PIXEL_SIZE)));
+    }
+
+    pass = (num_bad <= fraction * num_pix) && (psnr >= min_psnr);
+
+    printf("%s psnr=%.2fdB bad=%zu/%zu maxdiff=%d\n", pass ? "PASS" : "FAIL",
+                                    psnr, num_bad, num_pix, max_diff);
+
+    /* Write the difference image for failed comparisons */
+    if (!pass && diff != NULL) {
+        write_diff(diff, &ref, &img, tolerance);
+    }
+
+    free(ref.data);
+    free(img.data);
+
+    return pass ? EXIT_SUCCESS : EXIT_FAILURE;
+}
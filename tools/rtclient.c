@@ -0,0 +1,182 @@
+/*
+ * rtclient.c: This file contains a program for submitting a render job to a
+ *             ray tracer started with --serve.  The scene is read from
+ *             standard in and the rendered PPM image is written to standard
+ *             out, so the client can stand in for the ray tracer itself.
+ *
+ * Author:     Scott Gigawatt
+ *
+ * Version:    18 October 2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/* The size of the scene and image copy buffers */
+#define BUF_SIZE 65536
+
+/* The reply prefix of a rejected job */
+#define ERROR_ID "ERROR"
+
+/*
+ * write_full: Writes every byte of the buffer to the specified descriptor.
+ *
+ * Parameters: fd   - The descriptor.
+ *             buf  - The bytes to write.
+ *             size - The number of bytes.
+ *
+ * Return:     Zero if every byte was written, -1 otherwise.
+ */
+static int write_full(int fd, char *buf, size_t size) {
+    ssize_t wc; /* The write count */
+
+    while (size > 0) {
+        if ((wc = write(fd, buf, size)) <= 0) {
+            return -1;
+        }
+
+        buf  += wc;
+        size -= wc;
+    }
+
+    return 0;
+}
+
+/*
+ * read_scene: Reads all of standard in.
+ *
+ * Parameters: size - Set to the length of the scene text.
+ *
+ * Return:     The scene text.
+ */
+static char *read_scene(size_t *size) {
+    char   *text = NULL; /* The scene text       */
+    size_t room  = 0;    /* The allocated length */
+    size_t rc;           /* The read count       */
+
+    *size = 0;
+
+    do {
+        if (*size == room) {
+            room = room ? 2 * room : BUF_SIZE;
+
+            if ((text = realloc(text, room)) == NULL) {
+                fprintf(stderr, "rtclient: out of memory\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        rc     = fread(text + *size, 1, room - *size, stdin);
+        *size += rc;
+    } while (rc > 0);
+
+    return text;
+}
+
+/*
+ * usage:      Prints the program usage and exits.
+ *
+ * Parameters: name - The program name.
+ */
+static void usage(char *name) {
+    fprintf(stderr, "usage: %s [-s samples] [-p priority] [-v x,y,z] "
+                    "socket width height\n", name);
+    exit(EXIT_FAILURE);
+}
+
+/*
+ * main:       This function submits a render job and writes its image to
+ *             standard out.
+ *
+ * Parameters: argc - The number of command line arguments.
+ *             argv - The command line arguments.
+ *
+ * Return:     EXIT_SUCCESS if the image was rendered, failure otherwise.
+ */
+int main(int argc, char **argv) {
+    struct sockaddr_un addr;           /* The server address         */
+    char               buf[BUF_SIZE];  /* The image copy buffer      */
+    char               header[256];    /* The request header         */
+    char               view[128] = ""; /* The view point override    */
+    double             point[3];       /* The parsed view point      */
+    char               *text;          /* The scene text             */
+    size_t             size;           /* The length of the scene    */
+    ssize_t            rc;             /* The read count             */
+    int                samples  = 0;   /* Samples per pixel          */
+    int                priority = 0;   /* The job priority           */
+    int                first    = 1;   /* Set until the reply starts */
+    int                fd;             /* The server connection      */
+    int                opt;            /* Current option             */
+
+    /* Parse the command line options */
+    while ((opt = getopt(argc, argv, "s:p:v:")) != -1) {
+        switch (opt) {
+            case 's': samples  = atoi(optarg); break;
+            case 'p': priority = atoi(optarg); break;
+            case 'v':
+                if (sscanf(optarg, "%lf,%lf,%lf", &point[0], &point[1],
+                                                  &point[2]) != 3) {
+                    usage(*argv);
+                }
+
+                sprintf(view, " %g %g %g", point[0], point[1], point[2]);
+                break;
+            default:  usage(*argv);
+        }
+    }
+
+    if (argc - optind != 3 ||
+        strlen(argv[optind]) >= sizeof(addr.sun_path)) {
+        usage(*argv);
+    }
+
+    /* Connect to the server */
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, argv[optind]);
+
+    if ((fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0 ||
+        connect(fd, (struct sockaddr *)&addr, sizeof(addr))) {
+        perror(argv[optind]);
+        return EXIT_FAILURE;
+    }
+
+    /* Send the request */
+    text = read_scene(&size);
+    snprintf(header, sizeof(header), "RENDER %d %d %d %d %lu%s\n",
+             atoi(argv[optind + 1]), atoi(argv[optind + 2]), samples,
+             priority, (unsigned long)size, view);
+
+    if (write_full(fd, header, strlen(header)) ||
+        write_full(fd, text, size)) {
+        perror("rtclient: send");
+        return EXIT_FAILURE;
+    }
+
+    free(text);
+    shutdown(fd, SHUT_WR);
+
+    /* Copy the image to standard out, or report the error */
+    while ((rc = read(fd, buf, sizeof(buf))) > 0) {
+        if (first && rc >= (ssize_t)strlen(ERROR_ID) &&
+                     !strncmp(buf, ERROR_ID, strlen(ERROR_ID))) {
+            fprintf(stderr, "rtclient: %.*s", (int)rc, buf);
+            return EXIT_FAILURE;
+        }
+
+        first = 0;
+
+        if (write_full(STDOUT_FILENO, buf, rc)) {
+            perror("rtclient: write");
+            return EXIT_FAILURE;
+        }
+    }
+
+    close(fd);
+
+    return first ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,238 @@
+/*
+ * rtmerge.c: This file contains a program for assembling the shards of an
+ *            image rendered with --shard into the final PPM image, which is
+ *            written to standard out.  Every shard must come from the same
+ *            scene, image size, rectangle, tile size, sample count and
+ *            shading options, and every tile of the image must be covered
+ *            exactly once.
+ *
+ * Author:    Scott Gigawatt
+ *
+ * Version:   18 October 2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_COLOR  255
+#define ID_COLOR   "P6"
+#define PIXEL_SIZE 3
+
+/* The identifier at the start of a shard file (see shard.c) */
+#define SHARD_ID "RTSHARD2"
+
+/* The number of integer fields of a shard header */
+#define NUM_FIELDS 13
+
+/* A shard header */
+typedef struct shard_type {
+    int           index;     /* The shard index                        */
+    int           count;     /* The number of shards                   */
+    int           size[2];   /* The image width and height             */
+    int           region[4]; /* The traced rectangle (x0, y0, x1, y1)  */
+    int           full;      /* The full frame is written around it    */
+    int           tile;      /* The tile width and height              */
+    int           samples;   /* The samples per pixel                  */
+    int           lsamples;  /* The shadow rays per hit (0: all)       */
+    int           lightmap;  /* The lightmap texels across (0: none)   */
+    unsigned long hash;      /* The scene hash                         */
+} shard_t;
+
+/*
+ * read_header: Reads the header line of a shard file.
+ *
+ * Parameters:  in    - The shard file.
+ *              shard - Storage for the header.
+ *
+ * Return:      EXIT_SUCCESS if the header was read, EXIT_FAILURE otherwise.
+ */
+static int read_header(FILE *in, shard_t *shard) {
+    char id[sizeof(SHARD_ID)]; /* The file identifier */
+
+    if (fscanf(in, "%8s %d %d %d %d %d %d %d %d %d %d %d %d %d %lx", id,
+               &shard->index, &shard->count, &shard->size[0],
+               &shard->size[1], &shard->region[0], &shard->region[1],
+               &shard->region[2], &shard->region[3], &shard->full,
+               &shard->tile, &shard->samples, &shard->lsamples,
+               &shard->lightmap, &shard->hash)
+                                                    != NUM_FIELDS + 2 ||
+        strcmp(id, SHARD_ID) || fgetc(in) != '\n' || shard->count < 1 ||
+        shard->index < 0 || shard->index >= shard->count ||
+        shard->tile < 1 || shard->size[0] < 1 || shard->size[1] < 1 ||
+        shard->region[0] < 0 || shard->region[1] < 0 ||
+        shard->region[0] >= shard->region[2] ||
+        shard->region[1] >= shard->region[3] ||
+        (shard->full && (shard->region[2] > shard->size[0] ||
+                         shard->region[3] > shard->size[1])) ||
+        (!shard->full && (shard->region[2] - shard->region[0] !=
+                          shard->size[0] || shard->region[3] -
+                          shard->region[1] != shard->size[1]))) {
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/*
+ * same_render: Determines whether two shards belong to the same image.
+ *
+ * Parameters:  a - The first shard header.
+ *              b - The second shard header.
+ *
+ * Return:      Nonzero if only the shard indices differ, zero otherwise.
+ */
+static int same_render(shard_t *a, shard_t *b) {
+    return a->count == b->count && a->size[0] == b->size[0] &&
+           a->size[1] == b->size[1] && a->full == b->full &&
+           !memcmp(a->region, b->region, sizeof(a->region)) &&
+           a->tile == b->tile && a->samples == b->samples &&
+           a->lsamples == b->lsamples && a->lightmap == b->lightmap &&
+           a->hash == b->hash;
+}
+
+/*
+ * usage:      Prints the program usage and exits.
+ *
+ * Parameters: name - The program name.
+ */
+static void usage(char *name) {
+    fprintf(stderr, "usage: %s shard... > image.ppm\n", name);
+    exit(EXIT_FAILURE);
+}
+
+/*
+ * main:       This function assembles the shard files named on the command
+ *             line into a PPM image.
+ *
+ * Parameters: argc - The number of command line arguments.
+ *             argv - The command line arguments.
+ *
+ * Return:     EXIT_SUCCESS if the image is complete, failure otherwise.
+ */
+int main(int argc, char **argv) {
+    shard_t       first     = {0};  /* The header of the first shard  */
+    shard_t       shard;            /* The header of the current one  */
+    unsigned char *pixmap   = NULL; /* The image data                 */
+    char          *covered  = NULL; /* Set for each tile read         */
+    FILE          *in;              /* The current shard file         */
+    int           tiles[2]  = {0};  /* The tiles across and down      */
+    int           rect[4];          /* A tile's pixels, in the image  */
+    int           offset[2] = {0};  /* The image position of (0, 0)   */
+    int           num       = 0;    /* The number of tiles            */
+    int           missing   = 0;    /* The number of tiles not read   */
+    int           width;            /* The width of a tile row        */
+    int           f;                /* File index                     */
+    int           t;                /* Tile index                     */
+    int           i;                /* Row index                      */
+
+    if (argc < 2) {
+        usage(*argv);
+    }
+
+    for (f = 1; f < argc; ++f) {
+        if ((in = fopen(argv[f], "rb")) == NULL) {
+            fprintf(stderr, "rtmerge: error: cannot open '%s'\n", argv[f]);
+            return EXIT_FAILURE;
+        }
+
+        if (read_header(in, &shard)) {
+            fprintf(stderr, "rtmerge: error: '%s' is not a shard\n", argv[f]);
+            return EXIT_FAILURE;
+        }
+
+        /* The first shard sets up the image */
+        if (f == 1) {
+            first     = shard;
+            tiles[0]  = (shard.region[2] - shard.region[0] + shard.tile - 1)
+                                                           / shard.tile;
+            tiles[1]  = (shard.region[3] - shard.region[1] + shard.tile - 1)
+                                                           / shard.tile;
+            num       = tiles[0] * tiles[1];
+            offset[0] = shard.full ? 0 : shard.region[0];
+            offset[1] = shard.full ? 0 : shard.region[1];
+            pixmap    = (unsigned char *)calloc((size_t)shard.size[0] *
+                                          shard.size[1], PIXEL_SIZE);
+            covered   = (char *)calloc(num, 1);
+
+            if (pixmap == NULL || covered == NULL) {
+                fprintf(stderr, "rtmerge: error: out of memory\n");
+                return EXIT_FAILURE;
+            }
+        } else if (!same_render(&first, &shard)) {
+            fprintf(stderr, "rtmerge: error: '%s' is of another render\n",
+                            argv[f]);
+            return EXIT_FAILURE;
+        }
+
+        /* Read the tiles of the shard, in order */
+        for (t = shard.index; t < num; t += shard.count) {
+            if (covered[t]) {
+                fprintf(stderr, "rtmerge: error: shard %d given twice\n",
+                                shard.index);
+                return EXIT_FAILURE;
+            }
+
+            rect[0] = shard.region[0] + (t % tiles[0]) * shard.tile;
+            rect[1] = shard.region[1] + (t / tiles[0]) * shard.tile;
+            rect[2] = rect[0] + shard.tile < shard.region[2] ?
+                      rect[0] + shard.tile : shard.region[2];
+            rect[3] = rect[1] + shard.tile < shard.region[3] ?
+                      rect[1] + shard.tile : shard.region[3];
+            width   = rect[2] - rect[0];
+
+            for (i = rect[1]; i < rect[3]; ++i) {
+                if (fread(pixmap + ((size_t)(i - offset[1]) * shard.size[0] +
+                          rect[0] - offset[0]) * PIXEL_SIZE, PIXEL_SIZE,
+                          width, in) != width) {
+                    fprintf(stderr, "rtmerge: error: '%s' is truncated\n",
+                                    argv[f]);
+                    return EXIT_FAILURE;
+                }
+            }
+
+            covered[t] = 1;
+        }
+
+        if (fgetc(in) != EOF) {
+            fprintf(stderr, "rtmerge: error: '%s' has trailing data\n",
+                            argv[f]);
+            return EXIT_FAILURE;
+        }
+
+        fclose(in);
+    }
+
+    /* Verify that every tile of the image was read */
+    for (t = 0; t < num; ++t) {
+        missing += !covered[t];
+    }
+
+    if (missing) {
+        for (i = 0; i < first.count && i < num; ++i) {
+            if (!covered[i]) {
+                fprintf(stderr, "rtmerge: error: shard %d of %d is missing\n",
+                                i, first.count);
+            }
+        }
+
+        fprintf(stderr, "rtmerge: error: %d of %d tiles not covered\n",
+                        missing, num);
+        return EXIT_FAILURE;
+    }
+
+    printf("%s %d %d %d\n", ID_COLOR, first.size[0], first.size[1],
+                            MAX_COLOR);
+
+    if (fwrite(pixmap, PIXEL_SIZE, (size_t)first.size[0] * first.size[1],
+               stdout) != (size_t)first.size[0] * first.size[1] ||
+        fflush(stdout)) {
+        fprintf(stderr, "rtmerge: error: cannot write the image\n");
+        return EXIT_FAILURE;
+    }
+
+    free(pixmap);
+    free(covered);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,327 @@
+/*
+ * scenegen.c: This file contains a program for generating ray tracer scene
+ *             files of arbitrary size, used to study how render time scales
+ *             with object count, light count, and resolution.  The scene is
+ *             written to standard out in the same format as the files in the
+ *             input directory.
+ *
+ * Author:     Scott Gigawatt
+ *
+ * Version:    18 October 2026
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Object codes (see src/model.h) */
+#define LIGHT       10
+#define SPHERE      13
+#define PLANE       14
+#define TILED_PLANE 16
+
+/* Object distributions */
+#define DIST_UNIFORM   0
+#define DIST_CLUSTERED 1
+#define DIST_NESTED    2
+
+/* The region of the world in which objects are placed */
+#define REGION_X 10.0
+#define REGION_Y 7.0
+#define REGION_Z 20.0
+#define NEAR_Z   -6.0
+
+/* The number of children of each sphere in a nested distribution */
+#define NEST_FANOUT 4
+
+/* The number of spheres in each cluster of a clustered distribution */
+#define CLUSTER_SIZE 16
+
+/* The generator state (xorshift32) */
+static unsigned int state;
+
+/*
+ * rnd:        Returns a pseudo-random number in the specified range.
+ *
+ * Parameters: lo - The lower bound.
+ *             hi - The upper bound.
+ *
+ * Return:     A pseudo-random number in the range [lo, hi).
+ */
+static double rnd(double lo, double hi) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+
+    return lo + (hi - lo) * (state / 4294967296.0);
+}
+
+/*
+ * gauss:      Returns a normally distributed pseudo-random number.
+ *
+ * Parameters: sigma - The standard deviation.
+ *
+ * Return:     A pseudo-random number with mean zero.
+ */
+static double gauss(double sigma) {
+    double u = rnd(1e-9, 1.0); /* Uniform sample */
+    double v = rnd(0.0, 1.0);  /* Uniform sample */
+
+    return sigma * sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * v);
+}
+
+/*
+ * put_material: Writes a random ambient, diffuse, and specular material.
+ *
+ * Parameters:   out      - The scene file.
+ *               specular - The largest specular reflectivity.
+ */
+static void put_material(FILE *out, double specular) {
+    double s = rnd(0.0, specular); /* Specular reflectivity */
+
+    fprintf(out, "%.2f %.2f %.2f    ambient\n",  rnd(0, 8), rnd(0, 8),
+                                                  rnd(0, 8));
+    fprintf(out, "%.2f %.2f %.2f    diffuse\n",  rnd(0, 6), rnd(0, 6),
+                                                  rnd(0, 6));
+    fprintf(out, "%.2f %.2f %.2f    specular\n", s, s, s);
+}
+
+/*
+ * put_sphere: Writes a sphere with a random material.
+ *
+ * Parameters: out    - The scene file.
+ *             center - The center of the sphere (x, y, z).
+ *             radius - The radius of the sphere.
+ */
+static void put_sphere(FILE *out, double *center, double radius) {
+    fprintf(out, "\n%d             sphere\n", SPHERE);
+    put_material(out, 0.5);
+    fprintf(out, "%.3f %.3f %.3f    center\n", center[0], center[1],
+                                                center[2]);
+    fprintf(out, "%.3f             radius\n", radius);
+}
+
+/*
+ * put_spheres: Writes the specified number of spheres in the specified
+ *              distribution.
+ *
+ * Parameters:  out   - The scene file.
+ *              count - The number of spheres.
+ *              dist  - The distribution of the spheres.
+ */
+static void put_spheres(FILE *out, int count, int dist) {
+    double (*centers)[3] = malloc(sizeof(*centers) * (count + 1));
+    double *radii        = malloc(sizeof(*radii) * (count + 1));
+    double cluster[3]    = { 0.0, 0.0, 0.0 }; /* Current cluster center   */
+    double dir[3];                            /* Direction from a parent  */
+    double len;                               /* Length of the direction  */
+    double radius;                            /* Typical sphere radius    */
+    int    parent;                            /* Parent of nested sphere  */
+    int    i;                                 /* Sphere index             */
+    int    j;                                 /* Coordinate index         */
+
+    /* Shrink spheres as the count grows so the region stays uncluttered */
+    radius = 0.6 * 2.0 * REGION_X / cbrt(count > 0 ? count : 1);
+    radius = radius > 2.0 ? 2.0 : radius;
+
+    for (i = 0; i < count; ++i) {
+        switch (dist) {
+            case DIST_CLUSTERED:
+                /* Start a new cluster every CLUSTER_SIZE spheres */
+                if (i % CLUSTER_SIZE == 0) {
+                    cluster[0] = rnd(-REGION_X, REGION_X);
+                    cluster[1] = rnd(-REGION_Y, REGION_Y);
+                    cluster[2] = rnd(NEAR_Z - REGION_Z, NEAR_Z);
+                }
+
+                for (j = 0; j < 3; ++j) {
+                    centers[i][j] = cluster[j] + gauss(1.5);
+                }
+
+                radii[i] = radius * rnd(0.2, 0.5);
+                break;
+
+            case DIST_NESTED:
+                /* The root sphere sits in the middle of the region */
+                if (i == 0) {
+                    centers[i][0] = centers[i][1] = 0.0;
+                    centers[i][2] = NEAR_Z - REGION_Z / 2.0;
+                    radii[i]      = 3.0;
+                    break;
+                }
+
+                /* Each child sits on the surface of its parent */
+                parent = (i - 1) / NEST_FANOUT;
+
+                do {
+                    for (j = 0; j < 3; ++j) {
+                        dir[j] = rnd(-1.0, 1.0);
+                    }
+                } while ((len = sqrt(dir[0] * dir[0] + dir[1] * dir[1] +
+                                     dir[2] * dir[2])) < 1e-3);
+
+                radii[i] = radii[parent] * 0.5;
+
+                for (j = 0; j < 3; ++j) {
+                    centers[i][j] = centers[parent][j] + dir[j] / len *
+                                    (radii[parent] + radii[i]);
+                }
+                break;
+
+            default:
+                centers[i][0] = rnd(-REGION_X, REGION_X);
+                centers[i][1] = rnd(-REGION_Y, REGION_Y);
+                centers[i][2] = rnd(NEAR_Z - REGION_Z, NEAR_Z);
+                radii[i]      = radius * rnd(0.3, 0.6);
+        }
+
+        put_sphere(out, centers[i], radii[i]);
+    }
+
+    free(centers);
+    free(radii);
+}
+
+/*
+ * put_planes: Writes the specified number of infinite and tiled planes,
+ *             each facing the viewer from behind the spheres.
+ *
+ * Parameters: out    - The scene file.
+ *             planes - The number of infinite planes.
+ *             tiled  - The number of tiled planes.
+ */
+static void put_planes(FILE *out, int planes, int tiled) {
+    int i; /* Plane index */
+
+    for (i = 0; i < planes + tiled; ++i) {
+        fprintf(out, "\n%d             %s\n", i < planes ? PLANE : TILED_PLANE,
+                                       i < planes ? "plane" : "tiled plane");
+        put_material(out, 0.3);
+        fprintf(out, "%.3f %.3f 1    normal\n", rnd(-0.5, 0.5),
+                                                rnd(-0.5, 0.5));
+        fprintf(out, "0 0 %.3f       point\n", NEAR_Z - REGION_Z -
+                                               rnd(2.0, 10.0));
+
+        /* Tiled planes also need a grid and a background material */
+        if (i >= planes) {
+            fprintf(out, "1 0 0          grid direction\n");
+            fprintf(out, "%.2f %.2f      grid size\n", rnd(0.5, 3.0),
+                                                        rnd(0.5, 3.0));
+            put_material(out, 0.3);
+        }
+    }
+}
+
+/*
+ * put_lights: Writes the specified number of lights whose total emissivity
+ *             stays the same regardless of the count.
+ *
+ * Parameters: out    - The scene file.
+ *             lights - The number of lights.
+ */
+static void put_lights(FILE *out, int lights) {
+    double scale = 8.0 / (lights > 0 ? lights : 1); /* Emissivity share */
+    int    i;                                       /* Light index      */
+
+    for (i = 0; i < lights; ++i) {
+        fprintf(out, "\n%d             light\n", LIGHT);
+        fprintf(out, "%.2f %.2f %.2f    emissivity\n", scale * rnd(0.5, 1.5),
+                                                        scale * rnd(0.5, 1.5),
+                                                        scale * rnd(0.5, 1.5));
+        fprintf(out, "%.3f %.3f %.3f    center\n", rnd(-REGION_X, REGION_X),
+                                                    rnd(0.0, 2.0 * REGION_Y),
+                                                    rnd(NEAR_Z - REGION_Z,
+                                                        -NEAR_Z));
+    }
+}
+
+/*
+ * seed_state: Turns a seed into the generator state with the MurmurHash3
+ *             finalizer, which maps distinct 32-bit seeds to distinct
+ *             states.  Only seed 0 would give the zero state, from which
+ *             xorshift never leaves, so it is given a state of its own.
+ *
+ * Parameters: seed - The seed.
+ *
+ * Return:     The nonzero generator state.
+ */
+static unsigned int seed_state(unsigned int seed) {
+    seed ^= seed >> 16;
+    seed *= 0x85ebca6bu;
+    seed ^= seed >> 13;
+    seed *= 0xc2b2ae35u;
+    seed ^= seed >> 16;
+
+    return seed ? seed : 0x9e3779b9u;
+}
+
+/*
+ * usage:      Prints the program usage and exits.
+ *
+ * Parameters: name - The program name.
+ */
+static void usage(char *name) {
+    fprintf(stderr, "usage: %s [-s spheres] [-p planes] [-t tiled planes] "
+                    "[-l lights]\n          [-d uniform|clustered|nested] "
+                    "[-r seed]\n", name);
+    exit(EXIT_FAILURE);
+}
+
+/*
+ * main:       This function writes a generated scene to standard out.
+ *
+ * Parameters: argc - The number of command line arguments.
+ *             argv - The command line arguments.
+ *
+ * Return:     EXIT_SUCCESS if no errors were encountered, failure otherwise.
+ */
+int main(int argc, char **argv) {
+    int spheres = 16;           /* The number of spheres        */
+    int planes  = 1;            /* The number of planes         */
+    int tiled   = 1;            /* The number of tiled planes   */
+    int lights  = 2;            /* The number of lights         */
+    int dist    = DIST_UNIFORM; /* The distribution of spheres  */
+    int opt;                    /* Current option               */
+
+    state = 1;
+
+    /* Parse the command line options */
+    while ((opt = getopt(argc, argv, "s:p:t:l:d:r:")) != -1) {
+        switch (opt) {
+            case 's': spheres = atoi(optarg); break;
+            case 'p': planes  = atoi(optarg); break;
+            case 't': tiled   = atoi(optarg); break;
+            case 'l': lights  = atoi(optarg); break;
+            case 'r': state   = seed_state(strtoul(optarg, NULL, 10)); break;
+            case 'd':
+                if (!strcmp(optarg, "uniform")) {
+                    dist = DIST_UNIFORM;
+                } else if (!strcmp(optarg, "clustered")) {
+                    dist = DIST_CLUSTERED;
+                } else if (!strcmp(optarg, "nested")) {
+                    dist = DIST_NESTED;
+                } else {
+                    usage(*argv);
+                }
+                break;
+            default:  usage(*argv);
+        }
+    }
+
+    if (optind != argc || spheres < 0 || planes < 0 || tiled < 0 ||
+                                                       lights < 0) {
+        usage(*argv);
+    }
+
+    /* World dimensions and viewpoint */
+    printf("8 6           world x and y dims\n");
+    printf("0 0 5         viewpoint (x, y, z)\n");
+
+    put_planes(stdout, planes, tiled);
+    put_spheres(stdout, spheres, dist);
+    put_lights(stdout, lights);
+
+    return EXIT_SUCCESS;
+}